@@ -0,0 +1,232 @@
+/** \file apop_arena.c  A scoped bump allocator for short-lived data sets. */
+/* Copyright (c) 2026 by Ben Klemens.  Licensed under the modified GNU GPL v2; see COPYING and COPYING2.
+
+Each thread has its own chain of chunks. Allocation bumps a counter in the newest chunk;
+\c apop_arena_push records the current position and \c apop_arena_pop rewinds to it.
+Chunks emptied by a pop are kept on a spare list, and when the outermost scope closes,
+everything is coalesced into one chunk, so a loop that opens and closes a scope on every
+iteration reaches a steady state where it never calls \c malloc.
+
+Ownership rule used throughout: a top-level object (an \ref apop_data set or \ref
+apop_name) comes from the arena if a scope is open; its parts (vector, matrix, name
+strings) come from the arena if the object holding them does.
+*/
+
+#include "apop_internal.h"
+
+typedef struct arena_chunk {
+    struct arena_chunk *prev;
+    size_t size, used;
+    char *base;
+} arena_chunk;
+
+typedef struct {
+    arena_chunk *chunk;
+    size_t used;
+} arena_mark;
+
+#define Arena_align(s) (((s) + 15) & ~(size_t)15)
+static const size_t arena_min_chunk = 1<<16;
+
+static threadlocal arena_chunk *arena_top, *arena_spare;
+static threadlocal arena_mark *arena_marks;
+static threadlocal int arena_depth, arena_mark_space;
+static threadlocal char arena_held;
+
+/* A thread's chunks would outlive the thread, so each thread that opens a scope
+   registers this destructor to free them when it exits. */
+static pthread_key_t arena_key;
+static pthread_once_t arena_key_once = PTHREAD_ONCE_INIT;
+
+static void arena_release(void *ignored){
+    for (arena_chunk *c = arena_top, *p; c; c = p){ p = c->prev; free(c); }
+    for (arena_chunk *c = arena_spare, *p; c; c = p){ p = c->prev; free(c); }
+    free(arena_marks);
+    arena_top = arena_spare = NULL;
+    arena_marks = NULL;
+    arena_depth = arena_mark_space = 0;
+}
+
+static void arena_key_create(void){ pthread_key_create(&arena_key, arena_release); }
+
+static arena_chunk *chunk_alloc(size_t size){
+    arena_chunk *out = malloc(Arena_align(sizeof(arena_chunk)) + size);
+    Apop_stopif(!out, return NULL, 0, "malloc failed. Probably out of memory.");
+    *out = (arena_chunk){.size=size, .base=(char*)out + Arena_align(sizeof(arena_chunk))};
+    return out;
+}
+
+static void *arena_alloc(size_t size){
+    size = Arena_align(size ? size : 1);
+    if (!arena_top || arena_top->used + size > arena_top->size){
+        arena_chunk *c = NULL, **prevp = &arena_spare;
+        for (arena_chunk *s = arena_spare; s; prevp = &s->prev, s = s->prev)
+            if (s->size >= size){ //reuse a spare chunk
+                *prevp = s->prev;
+                c = s;
+                break;
+            }
+        if (!c){
+            size_t want = GSL_MAX(arena_min_chunk, size);
+            if (arena_top) want = GSL_MAX(want, 2*arena_top->size);
+            c = chunk_alloc(want);
+            if (!c) return NULL;
+        }
+        c->used = 0;
+        c->prev = arena_top;
+        arena_top = c;
+    }
+    void *out = arena_top->base + arena_top->used;
+    arena_top->used += size;
+    return out;
+}
+
+/** Open a scope for the \ref apop_arena_pop "arena allocator". Until the matching \ref
+apop_arena_pop, every \ref apop_data set and \ref apop_name structure allocated on this
+thread, along with its vector, matrix, and names, is carved out of a preallocated block
+instead of being individually <tt>malloc</tt>ed. \ref apop_arena_pop releases the whole
+lot at once.
+
+This is intended for hot loops that allocate and discard many small data sets, like a
+log likelihood that calls \ref apop_dot on every evaluation:
+
+\code
+for (int i=0; i< 1e5; i++){
+    apop_arena_push();
+    apop_data *xb = apop_dot(data, params);
+    total += apop_map_sum(xb, log);
+    apop_arena_pop();   //no need to free xb.
+}
+\endcode
+
+\li Scopes nest: a pop releases only what was allocated since the matching push.
+\li \ref apop_data_free is still safe to call on an arena-allocated set. It frees any
+parts that did not come from the arena (text, weights, pages or matrices you attached by
+hand) and otherwise does nothing. If you attach heap-allocated elements to an arena set,
+call \ref apop_data_free on it before the pop.
+\li The arena is thread-local. Don't free arena-allocated data sets from another thread,
+and don't keep pointers into the arena after the scope that produced them is popped.
+\li Arena-allocated vectors and matrices are flagged as not owning their data, so
+\ref apop_vector_realloc and \ref apop_matrix_realloc will refuse to resize them, and you
+should not call \c gsl_vector_free or \c gsl_matrix_free on them directly.
+\li Don't add names or other parts to a data set allocated in an outer scope while an
+inner scope is open: they would be released by the inner pop.
+\li Text is not arena-allocated.
+
+\see apop_arena_pop
+\ingroup data_struct
+*/
+void apop_arena_push(void){
+    if (!arena_mark_space){ //this thread's first scope
+        pthread_once(&arena_key_once, arena_key_create);
+        pthread_setspecific(arena_key, &arena_key); //any non-NULL value, so the destructor runs.
+    }
+    if (arena_depth >= arena_mark_space){
+        arena_mark_space = arena_mark_space ? 2*arena_mark_space : 16;
+        arena_marks = realloc(arena_marks, sizeof(arena_mark)*arena_mark_space);
+    }
+    arena_marks[arena_depth++] = (arena_mark){.chunk=arena_top, .used=arena_top ? arena_top->used : 0};
+}
+
+/** Close the scope opened by the last \ref apop_arena_push, releasing every data set
+allocated since then in one step. See \ref apop_arena_push for details.
+
+\li Popping without a matching push is an error; I print a warning and do nothing.
+
+\ingroup data_struct
+*/
+void apop_arena_pop(void){
+    Apop_stopif(!arena_depth, return, 0, "apop_arena_pop without a matching apop_arena_push. Ignoring.");
+    arena_mark m = arena_marks[--arena_depth];
+    while (arena_top && arena_top != m.chunk){
+        arena_chunk *c = arena_top;
+        arena_top = c->prev;
+        c->prev = arena_spare;
+        arena_spare = c;
+    }
+    if (arena_top) arena_top->used = m.used;
+    if (arena_depth) return;
+
+    //Outermost scope closed. Keep one chunk big enough for everything used this time.
+    size_t total = 0;
+    int chunks = 0;
+    for (arena_chunk *c = arena_top; c; c = c->prev, chunks++) total += c->size;
+    for (arena_chunk *c = arena_spare; c; c = c->prev, chunks++) total += c->size;
+    if (chunks <= 1) return;
+    for (arena_chunk *c = arena_top, *p; c; c = p){ p = c->prev; free(c); }
+    for (arena_chunk *c = arena_spare, *p; c; c = p){ p = c->prev; free(c); }
+    arena_spare = NULL;
+    arena_top = chunk_alloc(total);
+}
+
+/* Is this pointer in the live part of this thread's arena? */
+char apop_arena_owns(void const *ptr){
+    if (!ptr) return 0;
+    char const *p = ptr;
+    for (arena_chunk *c = arena_top; c; c = c->prev)
+        if (p >= c->base && p < c->base + c->used) return 1;
+    return 0;
+}
+
+/* Objects that outlive any scope (statics and other caches) have to be allocated
+   with the arena on hold. Returns the prior state, for restoring later. */
+char apop_arena_hold(char hold){
+    char out = arena_held;
+    arena_held = hold;
+    return out;
+}
+
+/* If owner==NULL, allocate from the arena if a scope is open and not on hold.
+   Otherwise, allocate from the arena if the owner lives there.
+   Else, plain malloc. */
+#define Use_arena(owner) ((owner) ? apop_arena_owns(owner) : (arena_depth > 0 && !arena_held))
+
+void *apop_arena_malloc(void const *owner, size_t size){
+    if (Use_arena(owner)) return arena_alloc(size);
+    return malloc(size);
+}
+
+void apop_arena_free(void *ptr){
+    if (ptr && !apop_arena_owns(ptr)) free(ptr);
+}
+
+char *apop_arena_strdup(void const *owner, char const *in){
+    size_t len = strlen(in) + 1;
+    char *out = apop_arena_malloc(owner, len);
+    Apop_stopif(!out, return NULL, 0, "malloc failed. Probably out of memory.");
+    return memcpy(out, in, len);
+}
+
+gsl_vector *apop_arena_vector(void const *owner, size_t size, char zero){
+    if (!Use_arena(owner))
+        return zero ? gsl_vector_calloc(size) : gsl_vector_alloc(size);
+    gsl_vector *out = arena_alloc(sizeof(gsl_vector));
+    gsl_block *b = arena_alloc(sizeof(gsl_block));
+    double *d = arena_alloc(sizeof(double)*size);
+    if (!out || !b || !d) return NULL;
+    *b = (gsl_block){.size=size, .data=d};
+    *out = (gsl_vector){.size=size, .stride=1, .data=d, .block=b, .owner=0};
+    if (zero) memset(d, 0, sizeof(double)*size);
+    return out;
+}
+
+gsl_matrix *apop_arena_matrix(void const *owner, size_t size1, size_t size2, char zero){
+    if (!Use_arena(owner))
+        return zero ? gsl_matrix_calloc(size1, size2) : gsl_matrix_alloc(size1, size2);
+    gsl_matrix *out = arena_alloc(sizeof(gsl_matrix));
+    gsl_block *b = arena_alloc(sizeof(gsl_block));
+    double *d = arena_alloc(sizeof(double)*size1*size2);
+    if (!out || !b || !d) return NULL;
+    *b = (gsl_block){.size=size1*size2, .data=d};
+    *out = (gsl_matrix){.size1=size1, .size2=size2, .tda=size2, .data=d, .block=b, .owner=0};
+    if (zero) memset(d, 0, sizeof(double)*size1*size2);
+    return out;
+}
+
+void apop_arena_vector_free(gsl_vector *v){
+    if (v && !apop_arena_owns(v)) gsl_vector_free(v);
+}
+
+void apop_arena_matrix_free(gsl_matrix *m){
+    if (m && !apop_arena_owns(m)) gsl_matrix_free(m);
+}
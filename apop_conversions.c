@@ -836,6 +836,126 @@ APOP_VAR_ENDHEAD
     return out;
 }
 
+/* The MLE packs and unpacks the parameters at every evaluation of the objective. A pack
+ plan lists the pages that apop_data_pack(d, .all_pages='y') would visit, with the
+ pointers and shapes it would read, so packing is a few flat copies, with no regexes
+ or subvector views. The plan is cached on the model. Checking that it is still current
+ is a walk down the page chain comparing pointers; if anything has moved, rebuild. */
+typedef struct {
+    apop_data const *page;
+    double  *v, *m, *w;
+    size_t  vsize, vstride, msize1, msize2, tda, wsize, wstride;
+} plan_page;
+
+struct apop_pack_plan {
+    size_t      ct, size;
+    plan_page   *pages;
+};
+
+static bool is_info_page(apop_data const *d){
+    char const *t = d->names->title;
+    size_t len = strlen(t);
+    return len > 1 && t[0]=='<' && t[len-1]=='>';
+}
+
+static plan_page page_key(apop_data const *d){
+    plan_page out = {.page = d};
+    if (d->vector) {out.v = d->vector->data; out.vsize = d->vector->size; out.vstride = d->vector->stride;}
+    if (d->matrix) {out.m = d->matrix->data; out.msize1 = d->matrix->size1;
+                    out.msize2 = d->matrix->size2; out.tda = d->matrix->tda;}
+    if (d->weights){out.w = d->weights->data; out.wsize = d->weights->size; out.wstride = d->weights->stride;}
+    return out;
+}
+
+static bool same_page(plan_page const *a, plan_page const *b){
+    return a->page == b->page && a->v == b->v && a->m == b->m && a->w == b->w
+        && a->vsize == b->vsize && a->vstride == b->vstride && a->msize1 == b->msize1
+        && a->msize2 == b->msize2 && a->tda == b->tda && a->wsize == b->wsize && a->wstride == b->wstride;
+}
+
+//As with apop_data_pack, the first page is always used; later info pages are skipped.
+#define Plan_pages(d, page) for (apop_data const *page = (d); page; page = page->more) \
+                                if (page == (d) || !is_info_page(page))
+
+static struct apop_pack_plan *plan_for(apop_model *m){
+    struct apop_pack_plan *p = m->pack_plan;
+    if (p){
+        size_t j = 0;
+        bool current = true;
+        Plan_pages(m->parameters, d){
+            plan_page key = page_key(d);
+            if (j == p->ct || !same_page(&key, p->pages + j)) {current = false; break;}
+            j++;
+        }
+        if (current && j == p->ct) return p;
+        apop_pack_plan_free(p);
+    }
+    p = m->pack_plan = calloc(1, sizeof(struct apop_pack_plan));
+    Plan_pages(m->parameters, d) p->ct++;
+    p->pages = malloc(sizeof(plan_page) * p->ct);
+    size_t j = 0;
+    Plan_pages(m->parameters, d){
+        plan_page *k = p->pages + j++;
+        *k = page_key(d);
+        p->size += k->vsize + k->msize1*k->msize2 + k->wsize;
+    }
+    return p;
+}
+
+void apop_pack_plan_free(struct apop_pack_plan *p){
+    if (!p) return;
+    free(p->pages);
+    free(p);
+}
+
+//Copy n doubles, either direction; both sides are usually contiguous.
+static void strided_copy(double *to, size_t to_stride, double const *from, size_t from_stride, size_t n){
+    if (to_stride == 1 && from_stride == 1) memcpy(to, from, sizeof(double)*n);
+    else for (size_t i=0; i< n; i++) to[i*to_stride] = from[i*from_stride];
+}
+
+/* Copy between the parameter pages and the packed vector: if pack is true, parameters to
+ vector, else vector to parameters. */
+static void plan_copy(apop_model *m, gsl_vector *v, bool pack){
+    struct apop_pack_plan *p = plan_for(m);
+    Apop_stopif(v->size != p->size, return, 0, "The model's parameters have %zu elements, but "
+            "the vector has %zu.", p->size, v->size);
+    double *o = v->data;
+    size_t s = v->stride;
+    for (size_t j=0; j< p->ct; j++){
+        plan_page *k = p->pages + j;
+        if (k->vsize){
+            if (pack) strided_copy(o, s, k->v, k->vstride, k->vsize);
+            else      strided_copy(k->v, k->vstride, o, s, k->vsize);
+            o += k->vsize*s;
+        }
+        if (k->msize1 && k->tda == k->msize2){
+            if (pack) strided_copy(o, s, k->m, 1, k->msize1*k->msize2);
+            else      strided_copy(k->m, 1, o, s, k->msize1*k->msize2);
+            o += k->msize1*k->msize2*s;
+        } else for (size_t r=0; r< k->msize1; r++){
+            if (pack) strided_copy(o, s, k->m + r*k->tda, 1, k->msize2);
+            else      strided_copy(k->m + r*k->tda, 1, o, s, k->msize2);
+            o += k->msize2*s;
+        }
+        if (k->wsize){
+            if (pack) strided_copy(o, s, k->w, k->wstride, k->wsize);
+            else      strided_copy(k->w, k->wstride, o, s, k->wsize);
+            o += k->wsize*s;
+        }
+    }
+}
+
+/* Equivalent to apop_data_pack(m->parameters, out, .all_pages='y'), but using the plan
+ cached on the model. */
+void apop_param_pack(apop_model *m, gsl_vector *out){ plan_copy(m, out, true); }
+
+/* Equivalent to apop_data_unpack(in, m->parameters). */
+void apop_param_unpack(gsl_vector const *in, apop_model *m){ plan_copy(m, (gsl_vector*)in, false); }
+
+//The length of the vector apop_param_pack fills.
+size_t apop_param_count(apop_model *m){ return plan_for(m)->size; }
+
 /** \def apop_data_fill
 Fill a pre-allocated data set with values.
 
@@ -47,17 +47,17 @@ APOP_VAR_ENDHEAD
         msize2 = size2;
     }
     else vsize = size1;
-    apop_data *setme = malloc(sizeof(apop_data));
+    apop_data *setme = apop_arena_malloc(NULL, sizeof(apop_data));
     Apop_stopif(!setme, return NULL, -5, "malloc failed. Probably out of memory.");
     *setme = (apop_data) { }; //init to zero/NULL.
     Set_gsl_handler
     if (msize2 > 0  && msize1 > 0){
-        setme->matrix = gsl_matrix_alloc(msize1,msize2);
+        setme->matrix = apop_arena_matrix(setme, msize1, msize2, 0);
         Apop_stopif(!setme->matrix, setme->error='a'; return setme,
                 0, "malloc failed on a %zu x %i matrix. Probably out of memory.", msize1, msize2);
     }
     if (vsize){
-        setme->vector = gsl_vector_alloc(vsize);
+        setme->vector = apop_arena_vector(setme, vsize, 0);
         Apop_stopif(!setme->vector, setme->error='a'; return setme,
                 0, "malloc failed on a vector of size %zu. Probably out of memory.", vsize);
     }
@@ -92,15 +92,15 @@ APOP_VAR_ENDHEAD
         msize2 = size2;
     }
     else vsize = size1;
-    apop_data  *setme       = malloc(sizeof(apop_data));
+    apop_data  *setme       = apop_arena_malloc(NULL, sizeof(apop_data));
     apop_assert(setme, "malloc failed. Probably out of memory.");
     *setme = (apop_data) { }; //init to zero/NULL.
     if (msize2 >0 && msize1 > 0){
-        setme->matrix = gsl_matrix_calloc(msize1,msize2);
+        setme->matrix = apop_arena_matrix(setme, msize1, msize2, 1);
         apop_assert(setme->matrix, "malloc failed on a %zu x %i matrix. Probably out of memory.", msize1, msize2);
     }
     if (vsize){
-        setme->vector = gsl_vector_calloc(vsize);
+        setme->vector = apop_arena_vector(setme, vsize, 1);
         apop_assert(setme->vector, "malloc failed on a vector of size %zu. Probably out of memory.", vsize);
     }
     setme->names = apop_name_alloc();
@@ -137,12 +137,143 @@ apop_data * apop_vector_to_data(gsl_vector *v){
     return setme;
 }
 
+/* Pooled text storage. Strings are written once into large chunks and never move, so the
+   char* cells of the text grid stay valid as the pool grows. An open-addressed hash table
+   maps each string to its one copy, so a column of repeated categories costs one copy per
+   category. Pools are shared (with a reference count) among copies of a data set. Pooled
+   strings are read-only, and cells are never freed one at a time. */
+typedef struct apop_text_pool {
+    char **chunks;
+    size_t chunk_ct, top_used, top_size;
+    char **table;  //hash slots, each NULL or a pointer into the chunks.
+    size_t table_size, entry_ct;
+    int refct;
+    pthread_mutex_t lock;
+} text_pool;
+
+static text_pool *pool_alloc(void){
+    text_pool *out = malloc(sizeof(text_pool));
+    Apop_stopif(!out, return NULL, 0, "malloc failed. Probably out of memory.");
+    *out = (text_pool){.refct=1, .table_size=64};
+    out->table = calloc(out->table_size, sizeof(char*));
+    pthread_mutex_init(&out->lock, NULL);
+    return out;
+}
+
+static text_pool *pool_share(text_pool *p){
+    if (!p) return NULL;
+    pthread_mutex_lock(&p->lock);
+    p->refct++;
+    pthread_mutex_unlock(&p->lock);
+    return p;
+}
+
+static void pool_release(text_pool *p){
+    if (!p) return;
+    pthread_mutex_lock(&p->lock);
+    int remaining = --p->refct;
+    pthread_mutex_unlock(&p->lock);
+    if (remaining) return;
+    for (size_t i=0; i< p->chunk_ct; i++) free(p->chunks[i]);
+    free(p->chunks);
+    free(p->table);
+    pthread_mutex_destroy(&p->lock);
+    free(p);
+}
+
+static char *pool_intern(text_pool *p, char const *in){
+    pthread_mutex_lock(&p->lock);
+    size_t slot = apop_string_hash(in) & (p->table_size-1);
+    for ( ; p->table[slot]; slot = (slot+1) & (p->table_size-1))
+        if (!strcmp(p->table[slot], in)){
+            pthread_mutex_unlock(&p->lock);
+            return p->table[slot];
+        }
+    size_t len = strlen(in)+1;
+    if (!p->chunk_ct || p->top_used + len > p->top_size){
+        p->top_size = GSL_MAX(len, p->top_size ? 2*p->top_size : 1<<12);
+        p->chunks = realloc(p->chunks, sizeof(char*)*(p->chunk_ct+1));
+        p->chunks[p->chunk_ct] = malloc(p->top_size);
+        Apop_stopif(!p->chunks[p->chunk_ct], pthread_mutex_unlock(&p->lock); return NULL,
+                0, "malloc failed. Probably out of memory.");
+        p->chunk_ct++;
+        p->top_used = 0;
+    }
+    char *out = memcpy(p->chunks[p->chunk_ct-1] + p->top_used, in, len);
+    p->top_used += len;
+    p->table[slot] = out;
+    if (++p->entry_ct*2 > p->table_size){ //rehash at half full.
+        size_t newsize = p->table_size*2;
+        char **newtable = calloc(newsize, sizeof(char*));
+        for (size_t i=0; i< p->table_size; i++)
+            if (p->table[i]){
+                size_t s = apop_string_hash(p->table[i]) & (newsize-1);
+                while (newtable[s]) s = (s+1) & (newsize-1);
+                newtable[s] = p->table[i];
+            }
+        free(p->table);
+        p->table = newtable;
+        p->table_size = newsize;
+    }
+    pthread_mutex_unlock(&p->lock);
+    return out;
+}
+
+/* Put a copy of \c in in the given text cell, in pooled or per-cell storage as appropriate.
+   If \c in already lives in the target's pool, the pointer itself will do. */
+static void text_cell_set(apop_data *d, size_t row, size_t col, char const *in, text_pool const *from){
+    if (!in) in = apop_opts.db_nan;
+    if (d->textpool)
+        d->text[row][col] = (from == d->textpool) ? (char*) in : pool_intern(d->textpool, in);
+    else {
+        free(d->text[row][col]);
+        d->text[row][col] = strdup(in);
+    }
+}
+
+/** Switch the text grid of a data set to pooled storage: rather than each cell being
+a separately allocated string, all strings are stored back-to-back in a few large blocks,
+and each distinct string is stored once. For a table with many text cells, and especially
+for categorical columns where the same few values repeat down the rows, this saves a
+great deal of memory and makes \ref apop_data_copy, \ref apop_data_stack, and \ref
+apop_data_free much faster: a copy shares the pool and copies one pointer per cell, and
+freeing releases the pool in one step.
+
+Existing cells are moved into the pool. After this, \ref apop_text_add, \ref
+apop_text_alloc, and the other text functions on this data set read and write the pool,
+and data sets copied from this one share it. Reading <tt>d->text[i][j]</tt> works as before.
+
+\li Pooled strings are read-only and shared, so don't modify a cell in place or \c free
+it, and don't assign a \c malloc'ed string directly to a cell. Use \ref apop_text_add to
+change a cell's value.
+\li Only the given page is converted, not the pages linked via the \c more pointer.
+
+\param in The data set whose text will be pooled. If \c NULL, or already pooled, this is a no-op.
+\return The input data set, for chaining.
+\exception in->error=='a' Allocation error.
+\ingroup data_struct
+*/
+apop_data * apop_text_pool(apop_data *in){
+    if (!in || in->textpool) return in;
+    in->textpool = pool_alloc();
+    Apop_stopif(!in->textpool, in->error='a'; return in, 0, "Allocation error setting up a text pool.");
+    for (size_t i=0; i< in->textsize[0]; i++)
+        for (size_t j=0; j< in->textsize[1]; j++){
+            char *old = in->text[i][j];
+            in->text[i][j] = pool_intern(in->textpool, old ? old : apop_opts.db_nan);
+            free(old);
+        }
+    return in;
+}
+
 /** Free a matrix of chars* (i.e., a char***). This is the form of the
  text element of the \ref apop_data set, so you can use this for:
  \code
  apop_text_free(yourdata->text, yourdata->textsize[0], yourdata->textsize[1]);
  \endcode
  This is what \c apop_data_free uses internally.
+
+ \li Don't use this on a data set whose text is in a \ref apop_text_pool; \ref apop_data_free knows to release the pool instead.
    */
 void apop_text_free(char ***freeme, int rows, int cols){
     if (rows && cols)
@@ -178,14 +309,20 @@ char apop_data_free_base(apop_data *freeme){
                                 1, "Propogating error code to parent data set");
     } 
     if (freeme->vector)  
-        gsl_vector_free(freeme->vector);
+        apop_arena_vector_free(freeme->vector);
     if (freeme->matrix)  
-        gsl_matrix_free(freeme->matrix); 
+        apop_arena_matrix_free(freeme->matrix); 
     if (freeme->weights)
-        gsl_vector_free(freeme->weights);
+        apop_arena_vector_free(freeme->weights);
     apop_name_free(freeme->names);
-    apop_text_free(freeme->text, freeme->textsize[0] , freeme->textsize[1]);
-    free(freeme);
+    if (freeme->textpool){ //cells belong to the pool; just free the grid.
+        for (size_t i=0; i< freeme->textsize[0]; i++) free(freeme->text[i]);
+        free(freeme->text);
+        pool_release(freeme->textpool);
+    } else
+        apop_text_free(freeme->text, freeme->textsize[0] , freeme->textsize[1]);
+    apop_sparse_free(freeme->sparse);
+    apop_arena_free(freeme);
     return 0;
 }
 
@@ -242,7 +379,8 @@ void apop_data_memcpy(apop_data *out, const apop_data *in){
     }
     if (in->names){
         apop_name_free(out->names);
-        out->names = apop_name_alloc();
+        out->names = apop_arena_malloc(out, sizeof(apop_name)); //an apop_name_alloc that follows out into or out of the arena.
+        *out->names = (apop_name){ };
         apop_name_stack(out->names, in->names, 'v');
         apop_name_stack(out->names, in->names, 'r');
         apop_name_stack(out->names, in->names, 'c');
@@ -258,8 +396,10 @@ void apop_data_memcpy(apop_data *out, const apop_data *in){
                     "or use apop_data_copy for automatic allocation.",
                     in->textsize[0] , in->textsize[1] , out->textsize[0] , out->textsize[1]);
         for (size_t i=0; i< in->textsize[0]; i++)
-            for(size_t j=0; j < in->textsize[1]; j ++)
-				apop_text_add(out, i, j, "%s", in->text[i][j]);
+            if (out->textpool && out->textpool == in->textpool) //same pool: copy pointers.
+                memcpy(out->text[i], in->text[i], sizeof(char*) * in->textsize[1]);
+            else for(size_t j=0; j < in->textsize[1]; j ++)
+                text_cell_set(out, i, j, in->text[i][j], in->textpool);
     }
 }
 
@@ -297,23 +437,29 @@ apop_data *apop_data_copy(const apop_data *in){
                 0, "propagating an error in the ->more element to the parent apop_data set. Only a partial copy made.");
     }
     if (in->vector){
-        out->vector = gsl_vector_alloc(in->vector->size);
+        out->vector = apop_arena_vector(out, in->vector->size, 0);
         Apop_stopif(!out->vector, out->error='a'; return out, 0, "Allocation error on vector of size %zu.", in->vector->size);
     }
     if (in->matrix){  
-        out->matrix = gsl_matrix_alloc(in->matrix->size1, in->matrix->size2);
+        out->matrix = apop_arena_matrix(out, in->matrix->size1, in->matrix->size2, 0);
         Apop_stopif(!out->matrix, out->error='a'; return out, 0, "Allocation error on matrix "
                     "of size %zu X %zu.", in->matrix->size1, in->matrix->size2);
     }
     if (in->weights){
-        out->weights = gsl_vector_alloc(in->weights->size);
+        out->weights = apop_arena_vector(out, in->weights->size, 0);
         Apop_stopif(!out->weights, out->error='a'; return out, 0, "Allocation error on weights vector of size %zu.", in->weights->size);
     }
+    if (in->sparse){
+        out->sparse = apop_sparse_copy(in->sparse);
+        Apop_stopif(!out->sparse, out->error='a'; return out, 0, "Allocation error on sparse block.");
+    }
     if (in->textsize[0] && in->textsize[1]){
+        out->textpool = pool_share(in->textpool);
         apop_text_alloc(out, in->textsize[0], in->textsize[1]);
         Apop_stopif(out->error, return out, 0, "Allocation error on text grid of size %zu X %zu.", in->textsize[0], in->textsize[1]);
     }
     apop_data_memcpy(out, in);
+    if (in->names) strcpy(out->names->title, in->names->title);
     return out;
 }
 
@@ -377,6 +523,7 @@ APOP_VAR_ENDHEAD
     } 
 
     if (m2->text){ //we've already copied m1->text, if any, so if m2->text is NULL, we're done.
+        if (!out->text && !out->textpool) out->textpool = pool_share(m2->textpool);
         if (posn=='r'){
             apop_assert(!out->text || m2->textsize[1]==out->textsize[1], 
                             "The first data set has %zu columns of text and the second has %zu columns. "
@@ -386,7 +533,7 @@ APOP_VAR_ENDHEAD
             Apop_stopif(out->error, return out, 0, "Allocation error.");
             for(int i=0; i< m2->textsize[0]; i++)
                 for(int j=0; j< m2->textsize[1]; j++)
-                    apop_text_add(out, i+basetextsize, j, m2->text[i][j]);
+                    text_cell_set(out, i+basetextsize, j, m2->text[i][j], m2->textpool);
         } else {
             apop_assert(!out->text || m2->textsize[0]==out->textsize[0], 
                             "The first data set has %zu rows of text and the second has %zu rows. "
@@ -396,7 +543,7 @@ APOP_VAR_ENDHEAD
             Apop_stopif(out->error, return out, 0, "Allocation error.");
             for(int i=0; i< m2->textsize[0]; i++)
                 for(int j=0; j< m2->textsize[1]; j++)
-                    apop_text_add(out, i, j+basetextsize, m2->text[i][j]);
+                    text_cell_set(out, i, j+basetextsize, m2->text[i][j], m2->textpool);
             apop_name_stack(out->names, m2->names, 't');
         }
     }
@@ -572,10 +719,12 @@ allocation:
     //finally, the text [split by rows only]
     if (r_or_c=='r' && in->textsize[0] && in->textsize[1]){
         apop_name_stack(out[1]->names, in->names, 't');
+        out[0]->textpool = pool_share(in->textpool);
         apop_text_alloc(out[0], splitpoint, in->textsize[1]);
         Apop_stopif(out[0]->error, return out, 0, "Allocation error.");
         if (in->textsize[0] > splitpoint){
             apop_name_stack(out[0]->names, in->names, 't');
+            out[1]->textpool = pool_share(in->textpool);
             apop_text_alloc(out[1], in->textsize[0]-splitpoint, in->textsize[1]);
             Apop_stopif(out[1]->error, return out, 0, "Allocation error.");
         }
@@ -583,7 +732,7 @@ allocation:
             for (int j=0; j< in->textsize[1]; j++){
                 int whichtext = (i >= splitpoint);
                 int row = whichtext ? i - splitpoint : i;
-                asprintf(&(out[whichtext]->text[row][j]), "%s", in->text[i][j]);
+                text_cell_set(out[whichtext], row, j, in->text[i][j], in->textpool);
             }
     }
     return out;
@@ -596,20 +745,11 @@ allocation:
 \ingroup names
  */
 static void apop_name_rm_columns(apop_name *n, int *drop){
-    apop_name *newname = apop_name_alloc();
-    size_t initial_colct = n->colct;
-    for (size_t i=0; i< initial_colct; i++){
-        if (drop[i]==0) apop_name_add(newname, n->column[i],'c');
-        else            n->colct--;
-        free(n->column[i]);
-    }
-    free(n->column);
-    n->column = newname->column;
-
-    //we need to free the newname struct, but leave the column intact.
-    newname->column   = NULL;
-    newname->colct  = 0;
-    apop_name_free(newname);
+    size_t initial_colct = n->colct, kept = 0;
+    for (size_t i=0; i< initial_colct; i++)
+        if (drop[i]) apop_arena_free(n->column[i]);
+        else         n->column[kept++] = n->column[i];
+    n->colct = kept;
 }
 
 
@@ -626,7 +766,7 @@ quickly fill an array of ints with nonzero values.
 void apop_data_rm_columns(apop_data *d, int *drop){
     gsl_matrix *freeme = d->matrix;
     d->matrix = apop_matrix_rm_columns(d->matrix, drop);
-    gsl_matrix_free(freeme); 
+    apop_arena_matrix_free(freeme); 
     apop_name_rm_columns(d->names, drop);
 }
 
@@ -1034,8 +1174,7 @@ int apop_data_set_row(apop_data * d, apop_data *row, int row_number){
         Apop_assert_negone(d->textsize[1], "You asked me to copy an apop_data_row with text to "
                 "an apop_data set with no text element.");
         for (int i=0; i < row->textsize[1]; i++){
-            free(d->text[row_number][i]);
-            d->text[row_number][i]= strdup(row->text[0][i]);
+            text_cell_set(d, row_number, i, row->text[0][i], row->textpool);
         }
     }
     if (row->weights){
@@ -1045,8 +1184,8 @@ int apop_data_set_row(apop_data * d, apop_data *row, int row_number){
     }
     if (row->names && row->names->rowct && d->names){
         if (row_number < d->names->rowct){
-            free(d->names->row[row_number]);
-            d->names->row[row_number]=strdup(row->names->row[0]);
+            apop_arena_free(d->names->row[row_number]);
+            d->names->row[row_number]=apop_arena_strdup(d->names, row->names->row[0]);
         } else if (row_number == d->names->rowct)
             apop_name_add(d->names, row->names->row[0], 'r');
     }
@@ -1118,6 +1257,7 @@ an error rather than reallocating the text matrix.
 reallocate to a new size if you need. For example, this code will fill the diagonals of
 the text array with a message, resizing as it goes:
 \li The string added is a copy (via <tt>asprintf</tt>), not a pointer to the input(s).
+\li If the data set's text is pooled (see \ref apop_text_pool), the string is stored in the pool, and nothing is freed.
 \li If there had been a string at the grid point you are writing to, 
 the old one is effectively lost when the new one is placed. So, I free
 the old string to prevent leaks. Remember this if you had other pointers aliasing that
@@ -1136,6 +1276,25 @@ int apop_text_add(apop_data *in, const size_t row, const size_t col, const char
     Apop_assert_negone((in->textsize[0] >= (int)row+1) && (in->textsize[1] >= (int)col+1), "You asked me to put the text "
                             " '%s' at position (%zu, %zu), but the text array has size (%zu, %zu)\n", 
                                fmt,             row, col,                  in->textsize[0], in->textsize[1]);
+    if (in->textpool){
+        char buf[256], *big = NULL;
+        int len = 0;
+        if (fmt){
+            va_list argp;
+            va_start(argp, fmt);
+            len = vsnprintf(buf, sizeof(buf), fmt, argp);
+            va_end(argp);
+        }
+        if (len >= (int)sizeof(buf)){
+            va_list argp;
+            va_start(argp, fmt);
+            vasprintf(&big, fmt, argp);
+            va_end(argp);
+        }
+        in->text[row][col] = pool_intern(in->textpool, !fmt ? apop_opts.db_nan : big ? big : buf);
+        free(big);
+        return 0;
+    }
     free (in->text[row][col]);
     if (!fmt){
         asprintf(&(in->text[row][col]), "%s", apop_opts.db_nan);
@@ -1161,6 +1320,9 @@ int apop_text_add(apop_data *in, const size_t row, const size_t col, const char
   */
 apop_data * apop_text_alloc(apop_data *in, const size_t row, const size_t col){
     if (!in) in  = apop_data_alloc();
+    char *blank = in->textpool ? pool_intern(in->textpool, "") : NULL;
+    #define Blank_cell (blank ? blank : strdup(""))
+    #define Free_cell(c) {if (!in->textpool) free(c);}
     if (!in->text){
         if (row){
             in->text = malloc(sizeof(char**) * row);
@@ -1173,7 +1335,7 @@ apop_data * apop_text_alloc(apop_data *in, const size_t row, const size_t col){
                 Apop_stopif(!in->text[i], in->error='a'; return in, 
                         0, "malloc failed setting up row %zu (with %zu columns). Probably out of memory.", i, col);
                 for (size_t j=0; j< col; j++)
-                    in->text[i][j] = strdup("");
+                    in->text[i][j] = Blank_cell;
             }
     } else { //realloc
         size_t rows_now = in->textsize[0];
@@ -1181,7 +1343,7 @@ apop_data * apop_text_alloc(apop_data *in, const size_t row, const size_t col){
         if (rows_now > row){
             for (int i=row; i < rows_now; i++){
                 for (int j=0; j < cols_now; j++)
-                    free(in->text[i][j]);
+                    Free_cell(in->text[i][j]);
                 free(in->text[i]);
             }
             in->text = realloc(in->text, sizeof(char**)*row);
@@ -1198,18 +1360,18 @@ apop_data * apop_text_alloc(apop_data *in, const size_t row, const size_t col){
                 Apop_stopif(!in->text[i], in->error='a'; return in, 
                         0, "malloc failed setting up row %zu (with %zu columns). Probably out of memory.", i, col);
                 for (int j=0; j < cols_now; j++)
-                    in->text[i][j] = strdup("");
+                    in->text[i][j] = Blank_cell;
             }
         }
         if (cols_now > col)
             for (int i=0; i < row; i++)
                 for (int j=col; j < cols_now; j++)
-                    free(in->text[i][j]);
+                    Free_cell(in->text[i][j]);
         if (cols_now != col)
             for (int i=0; i < row; i++){
                 in->text[i] = realloc(in->text[i], sizeof(char*)*col);
                 for (int j=cols_now; j < col; j++) //happens iff cols_now < col
-                    in->text[i][j] = strdup("");
+                    in->text[i][j] = Blank_cell;
             }
     }
     in->textsize[0] = row;
@@ -1248,10 +1410,11 @@ APOP_VAR_ENDHEAD
     apop_name_stack(out->names, in->names, 'c', 'r');
     if (!(transpose_text=='y')) return out;
 
+    out->textpool = pool_share(in->textpool);
     apop_text_alloc(out, in->textsize[1], in->textsize[0]);
     for (int r=0; r< in->textsize[0]; r++)
         for (int c=0; c< in->textsize[1]; c++)
-            apop_text_add(out, c, r, in->text[r][c]);
+            text_cell_set(out, c, r, in->text[r][c], in->textpool);
     if (in->names && in->names->textct && !in->names->colct)
         apop_name_stack(out->names, in->names, 't', 'r');
     return out;
@@ -1493,9 +1656,9 @@ APOP_VAR_ENDHEAD
         }
     }
     if (!outlength){
-        gsl_vector_free(in->vector);  in->vector = NULL;
-        gsl_vector_free(in->weights); in->weights = NULL;
-        gsl_matrix_free(in->matrix);  in->matrix = NULL;
+        apop_arena_vector_free(in->vector);  in->vector = NULL;
+        apop_arena_vector_free(in->weights); in->weights = NULL;
+        apop_arena_matrix_free(in->matrix);  in->matrix = NULL;
         apop_text_alloc(in, 0, 0);
         //leave colnames intact, remove rownames below.
     }
@@ -1507,7 +1670,7 @@ APOP_VAR_ENDHEAD
     if (in->text)    apop_text_alloc(in, GSL_MIN(outlength, in->textsize[0]), in->textsize[1]);
     if (in->names && in->names->rowct > outlength){
         for (int k=outlength; k< in->names->rowct; k++)
-            free(in->names->row[k]);
+            apop_arena_free(in->names->row[k]);
         in->names->rowct = outlength;
     }
 }
@@ -314,6 +314,70 @@ apop_data * apop_query_to_data(const char * fmt, ...){
 	return qinfo.outdata;
 }
 
+typedef struct {    //for apop_query_blocks.
+    int namecol;
+    size_t row, block_size;
+    apop_data *block;
+    int (*fn)(apop_data *, void *);
+    void *arg;
+    int stop;
+} block_callback_t;
+
+static int db_to_blocks(void *qinfo, int argc, char **argv, char **column){
+    block_callback_t *qi= qinfo;
+    Apop_stopif(!argv, return -1, apop_errorlevel, "Got NULL data from SQLite.");
+    if (!qi->block){
+        for (int i=0; i< argc; i++)
+            if (!strcasecmp(column[i], apop_opts.db_name_column)) qi->namecol = i;
+        qi->block = apop_data_alloc(qi->block_size, argc - (qi->namecol >= 0));
+        for (int i=0; i< argc; i++)
+            if (i != qi->namecol) apop_name_add(qi->block->names, column[i], 'c');
+    }
+    double *row = qi->block->matrix->data + qi->row*qi->block->matrix->tda;
+    for (int jj=0, c=0; jj< argc; jj++)
+        if (jj != qi->namecol)
+            row[c++] = !argv[jj] || !strcmp(argv[jj], "NULL")|| !strcasecmp(apop_opts.db_nan, argv[jj])
+                         ? GSL_NAN : atof(argv[jj]);
+    if (++qi->row == qi->block_size){
+        qi->row = 0;
+        return (qi->stop = qi->fn(qi->block, qi->arg));
+    }
+    return 0;
+}
+
+/* Run the query, and hand its rows to fn in blocks of block_size rows (the last may be
+   shorter), so the full result never has to be in memory at once. The block is reused from
+   call to call, and has no row names. If fn returns nonzero, stop reading.
+   Returns 0 on success, 1 on a query error. */
+int apop_query_blocks(char const *query, size_t block_size, int (*fn)(apop_data *block, void *arg), void *arg){
+    if (apop_opts.db_engine == 'm'){ //page through the result via limit/offset.
+        for (size_t offset=0; ; offset+= block_size){
+            apop_data *block = apop_query_to_data("select * from (%s) as apop_blocks limit %zu offset %zu",
+                                                        query, block_size, offset);
+            if (!block) return 0;
+            if (block->error){ apop_data_free(block); return 1; }
+            int stop = fn(block, arg);
+            size_t rows = block->matrix ? block->matrix->size1 : 0;
+            apop_data_free(block);
+            if (stop || rows < block_size) return 0;
+        }
+    }
+    char *err=NULL;
+    block_callback_t qinfo = {.namecol=-1, .block_size=block_size, .fn=fn, .arg=arg};
+	if (db==NULL) apop_db_open(NULL);
+    sqlite3_exec(db, query, db_to_blocks, &qinfo, &err); 
+    if (err && qinfo.stop) {sqlite3_free(err); err = NULL;} //we aborted on purpose.
+    Apop_stopif(err, apop_data_free(qinfo.block); sqlite3_free(err); return 1, 0, "%s: %s", query, err);
+    if (qinfo.block && qinfo.row && !qinfo.stop){
+        gsl_matrix_view rest = gsl_matrix_submatrix(qinfo.block->matrix, 0, 0, qinfo.row, qinfo.block->matrix->size2);
+        apop_data partial = *qinfo.block;
+        partial.matrix = &rest.matrix;
+        fn(&partial, arg);
+    }
+    apop_data_free(qinfo.block);
+    return 0;
+}
+
 
     /** \cond doxy_ignore */
 //These used to do more, but I'll leave them as a macro anyway in case of future expansion.
@@ -0,0 +1,195 @@
+/** \file apop_dual.c  Forward-mode differentiation of log likelihoods via dual numbers. */
+/* Copyright (c) 2026 by Ben Klemens.  Licensed under the modified GNU GPL v2; see COPYING and COPYING2.
+
+Every dual number carries its derivatives with respect to all \f$k\f$ parameters at once,
+so one pass through a model's \c log_likelihood_dual gives the full gradient. If a Hessian
+is wanted, each number also carries the \f$k(k+1)/2\f$ distinct second derivatives.
+
+The derivative arrays come from the \ref apop_arena_push "arena". \ref apop_dual_ll opens
+a scope before calling the model and closes it after copying out the results, so the model
+never frees anything.
+*/
+
+#include "apop_internal.h"
+#include <gsl/gsl_sf_gamma.h>
+#include <gsl/gsl_sf_psi.h>
+
+static threadlocal size_t dual_k;      //parameter count for the current evaluation
+static threadlocal char dual_order;    //1=gradient only; 2=gradient and Hessian
+
+#define Tri(i, j) ((i)*dual_k - (i)*((i)-1)/2 + (j)-(i))  //index of (i, j), i<=j, in dd
+#define Tri_size (dual_k*(dual_k+1)/2)
+
+static double *zeros(size_t n){
+    double *out = apop_arena_malloc(NULL, sizeof(double)*(n ? n : 1));
+    Apop_stopif(!out, return NULL, 0, "Allocation error.");
+    memset(out, 0, sizeof(double)*n);
+    return out;
+}
+
+/** A constant: the derivatives are all zero, and nothing is allocated.
+\ingroup models */
+apop_dual apop_dual_const(double val){ return (apop_dual){.val=val}; }
+
+/** A dual number with allocated, zeroed derivatives. Use this for a running sum that
+you will add to via \ref apop_dual_accumulate, especially if each term is computed in its
+own \ref apop_arena_push / \ref apop_arena_pop scope, like this:
+
+\code
+apop_dual ll = apop_dual_alloc(0);
+for (int i=0; i< n; i++){
+    apop_arena_push();
+    apop_dual_accumulate(&ll, apop_dual_log(apop_dual_affine(params[0], x[i], 1)));
+    apop_arena_pop();
+}
+return ll;
+\endcode
+\ingroup models */
+apop_dual apop_dual_alloc(double val){
+    return (apop_dual){.val = val, .d = zeros(dual_k),
+                       .dd = dual_order > 1 ? zeros(Tri_size) : NULL};
+}
+
+/** Apply a function of one variable to a dual number, given the function's value and
+its first and second derivatives at <tt>a.val</tt>. The other single-variable functions
+here are all written this way; e.g., \ref apop_dual_exp is
+
+\code
+double e = exp(a.val);
+return apop_dual_chain(a, e, e, e);
+\endcode
+
+\param a The input.
+\param f \f$f(a)\f$
+\param df \f$f'(a)\f$
+\param d2f \f$f''(a)\f$. Only used when a Hessian is being calculated.
+\ingroup models */
+apop_dual apop_dual_chain(apop_dual a, double f, double df, double d2f){
+    if (!a.d) return apop_dual_const(f);
+    apop_dual out = apop_dual_alloc(f);
+    for (size_t i=0; i< dual_k; i++) out.d[i] = df * a.d[i];
+    if (out.dd)
+        for (size_t i=0; i< dual_k; i++)
+            for (size_t j=i; j< dual_k; j++)
+                out.dd[Tri(i,j)] = (a.dd ? df * a.dd[Tri(i,j)] : 0) + d2f * a.d[i] * a.d[j];
+    return out;
+}
+
+//a*s1 + b*s2, the linear case that covers +, -, and scaling.
+static apop_dual lincomb(apop_dual a, double s1, apop_dual b, double s2, double shift){
+    if (!a.d && !b.d) return apop_dual_const(a.val*s1 + b.val*s2 + shift);
+    apop_dual out = apop_dual_alloc(a.val*s1 + b.val*s2 + shift);
+    for (size_t i=0; i< dual_k; i++)
+        out.d[i] = (a.d ? s1*a.d[i] : 0) + (b.d ? s2*b.d[i] : 0);
+    if (out.dd)
+        for (size_t i=0; i< Tri_size; i++)
+            out.dd[i] = (a.dd ? s1*a.dd[i] : 0) + (b.dd ? s2*b.dd[i] : 0);
+    return out;
+}
+
+/** \f$a+b\f$ \ingroup models */
+apop_dual apop_dual_add(apop_dual a, apop_dual b){ return lincomb(a, 1, b, 1, 0); }
+
+/** \f$a-b\f$ \ingroup models */
+apop_dual apop_dual_sub(apop_dual a, apop_dual b){ return lincomb(a, 1, b, -1, 0); }
+
+/** \f$a\cdot\f$ \c scale \f$+\f$ \c shift, for mixing a dual number with plain doubles.
+\ingroup models */
+apop_dual apop_dual_affine(apop_dual a, double scale, double shift){
+    return lincomb(a, scale, apop_dual_const(0), 0, shift);
+}
+
+/** \f$a\cdot b\f$ \ingroup models */
+apop_dual apop_dual_mul(apop_dual a, apop_dual b){
+    if (!a.d) return apop_dual_affine(b, a.val, 0);
+    if (!b.d) return apop_dual_affine(a, b.val, 0);
+    apop_dual out = apop_dual_alloc(a.val * b.val);
+    for (size_t i=0; i< dual_k; i++)
+        out.d[i] = a.d[i]*b.val + a.val*b.d[i];
+    if (out.dd)
+        for (size_t i=0; i< dual_k; i++)
+            for (size_t j=i; j< dual_k; j++)
+                out.dd[Tri(i,j)] = (a.dd ? a.dd[Tri(i,j)]*b.val : 0) + (b.dd ? a.val*b.dd[Tri(i,j)] : 0)
+                                     + a.d[i]*b.d[j] + a.d[j]*b.d[i];
+    return out;
+}
+
+/** \f$a/b\f$ \ingroup models */
+apop_dual apop_dual_div(apop_dual a, apop_dual b){
+    if (!b.d) return apop_dual_affine(a, 1/b.val, 0);
+    double inv = 1/b.val;
+    return apop_dual_mul(a, apop_dual_chain(b, inv, -inv*inv, 2*inv*inv*inv));
+}
+
+/** \f$\ln(a)\f$ \ingroup models */
+apop_dual apop_dual_log(apop_dual a){
+    return apop_dual_chain(a, log(a.val), 1/a.val, -1/(a.val*a.val));
+}
+
+/** \f$e^a\f$ \ingroup models */
+apop_dual apop_dual_exp(apop_dual a){
+    double e = exp(a.val);
+    return apop_dual_chain(a, e, e, e);
+}
+
+/** \f$a^p\f$, for a fixed power \f$p\f$. \ingroup models */
+apop_dual apop_dual_pow(apop_dual a, double power){
+    return apop_dual_chain(a, pow(a.val, power), power*pow(a.val, power-1),
+                              power*(power-1)*pow(a.val, power-2));
+}
+
+/** \f$\ln\Gamma(a)\f$, with the digamma and trigamma functions as derivatives. \ingroup models */
+apop_dual apop_dual_lgamma(apop_dual a){
+    return apop_dual_chain(a, gsl_sf_lngamma(a.val), gsl_sf_psi(a.val),
+                            dual_order > 1 ? gsl_sf_psi_1(a.val) : 0);
+}
+
+/** Add \c a to \c *sum in place, without allocating anything (unless \c *sum is a constant;
+see \ref apop_dual_alloc).
+\ingroup models */
+void apop_dual_accumulate(apop_dual *sum, apop_dual a){
+    sum->val += a.val;
+    if (!a.d) return;
+    if (!sum->d) sum->d = zeros(dual_k);
+    if (!sum->dd && a.dd) sum->dd = zeros(Tri_size);
+    for (size_t i=0; i< dual_k; i++) sum->d[i] += a.d[i];
+    if (a.dd)
+        for (size_t i=0; i< Tri_size; i++) sum->dd[i] += a.dd[i];
+}
+
+/* Seed each parameter with a unit derivative in its own direction, call the model's
+log_likelihood_dual, and copy out the results. Returns the log likelihood; a model with no
+parameters has nothing to differentiate, so that is all it does. */
+double apop_dual_ll(apop_data *d, apop_model *m, gsl_vector *gradient, gsl_matrix *hessian){
+    Apop_stopif(!m->log_likelihood_dual, return GSL_NAN, 0, "This model has no log_likelihood_dual method.");
+    size_t k = apop_param_count(m);
+    if (!k) return apop_log_likelihood(d, m); //nothing to differentiate.
+    size_t prior_k = dual_k;
+    char prior_order = dual_order;
+    dual_k = k;
+    dual_order = hessian ? 2 : 1;
+    apop_arena_push();
+    double *beta = apop_arena_malloc(NULL, sizeof(double)*k);
+    gsl_vector_view bv = gsl_vector_view_array(beta, k);
+    apop_param_pack(m, &bv.vector);
+    apop_dual *params = apop_arena_malloc(NULL, sizeof(apop_dual)*dual_k);
+    for (size_t i=0; i< dual_k; i++){
+        params[i] = apop_dual_alloc(beta[i]);
+        params[i].d[i] = 1;
+    }
+    apop_dual ll = m->log_likelihood_dual(d, params, m);
+    for (size_t i=0; i< dual_k; i++){
+        if (gradient) gsl_vector_set(gradient, i, ll.d ? ll.d[i] : 0);
+        if (hessian)
+            for (size_t j=i; j< dual_k; j++){
+                double h = ll.dd ? ll.dd[Tri(i,j)] : 0;
+                gsl_matrix_set(hessian, i, j, h);
+                gsl_matrix_set(hessian, j, i, h);
+            }
+    }
+    double out = ll.val;
+    apop_arena_pop();
+    dual_k = prior_k;
+    dual_order = prior_order;
+    return out;
+}
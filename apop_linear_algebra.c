@@ -100,54 +100,235 @@ double apop_matrix_determinant(const gsl_matrix *in) {
     return apop_det_and_inv(in, NULL, 1, 0);
 }
 
+/* PCA works from the column means and the centered cross-product matrix C = Xc'Xc, where
+   Xc is X with the means subtracted. We never form Xc: each pass over the data copies one
+   block of rows at a time into a buffer, centers it there, and accumulates either C itself
+   (q==NULL) or the product C q, for a p x l matrix q. So the data isn't modified, and the
+   data can be a matrix in memory or the rows of a query read a block at a time. */
+typedef struct {
+    gsl_vector *sum;        //on the first pass (mean==NULL), the column sums.
+    gsl_vector *mean;
+    double n, trace;        //trace(C), the total variance.
+    gsl_matrix const *q;
+    gsl_matrix *z;          //C or C q; the upper triangle only if q==NULL.
+    gsl_matrix *buf, *t;
+    char error;
+} pca_pass;
+
+static int pca_block(gsl_matrix const *x, pca_pass *pp){
+    Apop_stopif(!x || (pp->sum && x->size2 != pp->sum->size), pp->error='d'; return 1,
+                    0, "Every block needs a matrix of the same width.");
+    size_t rows = x->size1, p = x->size2;
+    if (!pp->mean){
+        if (!pp->sum) pp->sum = gsl_vector_calloc(p);
+        for (size_t i=0; i< rows; i++){
+            gsl_vector_const_view row = gsl_matrix_const_row(x, i);
+            gsl_vector_add(pp->sum, &row.vector);
+        }
+        pp->n += rows;
+        return 0;
+    }
+    if (!rows) return 0;
+    if (!pp->buf || pp->buf->size1 < rows){
+        if (pp->buf) gsl_matrix_free(pp->buf);
+        if (pp->t) gsl_matrix_free(pp->t);
+        pp->buf = gsl_matrix_alloc(rows, p);
+        pp->t = pp->q ? gsl_matrix_alloc(rows, pp->q->size2) : NULL;
+    }
+    gsl_matrix_view b = gsl_matrix_submatrix(pp->buf, 0, 0, rows, p);
+    gsl_matrix_memcpy(&b.matrix, x);
+    for (size_t i=0; i< rows; i++){
+        Apop_matrix_row(&b.matrix, i, row);
+        gsl_vector_sub(row, pp->mean);
+        double ss;
+        gsl_blas_ddot(row, row, &ss);
+        pp->trace += ss;
+    }
+    if (pp->q){
+        gsl_matrix_view t = gsl_matrix_submatrix(pp->t, 0, 0, rows, pp->q->size2);
+        gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, &b.matrix, pp->q, 0, &t.matrix);
+        gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, &b.matrix, &t.matrix, 1, pp->z);
+    } else gsl_blas_dsyrk(CblasUpper, CblasTrans, 1, &b.matrix, 1, pp->z);
+    return 0;
+}
+
+static int pca_query_block(apop_data *block, void *pp){ return pca_block(block->matrix, pp); }
+
+typedef struct {
+    gsl_matrix const *m;
+    char const *query;
+    int block_size;
+} pca_source;
+
+static int pca_run_pass(pca_source const *src, pca_pass *pp){
+    pp->trace = 0;
+    if (pp->z) gsl_matrix_set_zero(pp->z);
+    if (src->query)
+        return apop_query_blocks(src->query, src->block_size, pca_query_block, pp) || pp->error;
+    for (size_t r=0; r< src->m->size1; r+= src->block_size){
+        gsl_matrix_const_view v = gsl_matrix_const_submatrix(src->m, r, 0,
+                                 GSL_MIN(src->block_size, src->m->size1 - r), src->m->size2);
+        if (pca_block(&v.matrix, pp)) return 1;
+    }
+    return 0;
+}
+
+//Gram-Schmidt, twice, on the columns of z.
+static void pca_orthonormalize(gsl_matrix *z){
+    for (int twice=0; twice< 2; twice++)
+        for (size_t j=0; j< z->size2; j++){
+            Apop_matrix_col(z, j, zj);
+            for (size_t i=0; i< j; i++){
+                Apop_matrix_col(z, i, zi);
+                double d;
+                gsl_blas_ddot(zi, zj, &d);
+                gsl_blas_daxpy(-d, zi, zj);
+            }
+            double norm = gsl_blas_dnrm2(zj);
+            if (norm > 0) gsl_vector_scale(zj, 1/norm);
+        }
+}
+
+#define Pca_power_iterations 3
+
+static apop_data *pca_run(pca_source const *src, int dims, char method){
+    Set_gsl_handler
+    pca_pass pp = {};
+    apop_data *pc_space = NULL;
+    gsl_matrix *q = NULL, *square = NULL, *eigenvectors = NULL;
+    gsl_vector *evalues = NULL, *work = NULL;
+    Checkgsl(pca_run_pass(src, &pp))
+    Apop_stopif(!pp.sum || pp.n < 1, goto done, 0, "No data.");
+    size_t p = pp.sum->size;
+    if (dims <= 0 || dims > (int)p) dims = p;
+    size_t l = GSL_MIN(dims + 10, p); //oversample the range, to catch the directions near the cutoff
+    if (method != 'r' && method != 'f') method = (p > 1000 && dims*10 <= (int)p) ? 'r' : 'f';
+    if (l == p) method = 'f';
+    pp.mean = apop_vector_copy(pp.sum);
+    gsl_vector_scale(pp.mean, 1/pp.n);
+
+    if (method == 'f'){
+        square = pp.z = gsl_matrix_alloc(p, p);
+        Checkgsl(pca_run_pass(src, &pp))
+        for (size_t i=0; i< p; i++)
+            for (size_t j=i+1; j< p; j++)
+                gsl_matrix_set(square, j, i, gsl_matrix_get(square, i, j));
+        l = p;
+    } else { //randomized subspace iteration on C, then Rayleigh-Ritz on the subspace.
+        gsl_rng *r = apop_rng_alloc(apop_opts.rng_seed++);
+        q = gsl_matrix_alloc(p, l);
+        for (size_t i=0; i< p; i++)
+            for (size_t j=0; j< l; j++)
+                gsl_matrix_set(q, i, j, gsl_ran_gaussian(r, 1));
+        gsl_rng_free(r);
+        pp.z = gsl_matrix_alloc(p, l);
+        for (int i=0; i<= Pca_power_iterations; i++){
+            pca_orthonormalize(q);
+            pp.q = q;
+            Checkgsl(pca_run_pass(src, &pp))
+            if (i < Pca_power_iterations){
+                gsl_matrix *swap = q; q = pp.z; pp.z = swap;
+            }
+        }
+        square = gsl_matrix_alloc(l, l);  // Q'CQ
+        gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, q, pp.z, 0, square);
+        for (size_t i=0; i< l; i++)
+            for (size_t j=i+1; j< l; j++){
+                double mean = (gsl_matrix_get(square, i, j) + gsl_matrix_get(square, j, i))/2;
+                gsl_matrix_set(square, i, j, mean);
+                gsl_matrix_set(square, j, i, mean);
+            }
+        gsl_matrix_free(pp.z);
+        pp.z = NULL;
+    }
+    eigenvectors = gsl_matrix_alloc(l, l);
+    evalues = gsl_vector_alloc(l);
+    work = gsl_vector_alloc(l);
+    pc_space = apop_data_alloc(dims, p, dims);
+    Apop_stopif(pc_space->error, goto done, 0, "Allocation error.");
+    if (gsl_linalg_SV_decomp(square, eigenvectors, evalues, work)) {pc_space->error='m'; goto done;}
+    gsl_matrix_view top = gsl_matrix_submatrix(square, 0, 0, l, dims);
+    if (q) gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, q, &top.matrix, 0, pc_space->matrix);
+    else   gsl_matrix_memcpy(pc_space->matrix, &top.matrix);
+    for (int i=0; i< dims; i++)
+        gsl_vector_set(pc_space->vector, i, gsl_vector_get(evalues, i)/pp.trace);
+
+    done:
+    if (pp.z != square) gsl_matrix_free(pp.z);
+    gsl_matrix_free(q);
+    gsl_matrix_free(square); gsl_matrix_free(eigenvectors);
+    gsl_vector_free(evalues); gsl_vector_free(work);
+    gsl_vector_free(pp.sum); gsl_vector_free(pp.mean);
+    gsl_matrix_free(pp.buf); gsl_matrix_free(pp.t);
+    Unset_gsl_handler
+    return pc_space;
+}
+
 /** Principal component analysis: hand in a matrix and (optionally) a number of desired dimensions, and I'll return a data set where each column of the matrix is an eigenvector. The columns are sorted, so column zero has the greatest weight. The vector element of the data set gives the weights.
 
 You also specify the number of elements your principal component space should have. If this is equal to the rank of the space in which the input data lives, then the sum of weights will be one. If the dimensions desired is less than that (probably so you can prepare a plot), then the weights will be accordingly smaller, giving you an indication of how much variation these dimensions explain. 
 
+If you only want a few dimensions out of many, the full decomposition of the \f$p\times
+p\f$ covariance matrix is wasted effort, and for \f$p\f$ in the tens of thousands, it
+is infeasible. The randomized method finds only the top components: it starts with
+<tt>dimensions_we_want</tt>+10 random directions, multiplies them by the covariance
+matrix a few times (without ever forming it) to rotate them toward the top of the
+spectrum, and then solves the small eigenproblem within the space they span. Each
+multiplication is one pass over the data, so the work is \f$O(npk)\f$, not
+\f$O(np^2 + p^3)\f$. The eigenvalues are typically accurate to many digits for
+data whose spectrum decays; for a flat spectrum (i.e., noise) the trailing components
+are less reliable.
+
 \param data The input matrix. (No default. If \c NULL, I'll return \c NULL.)
-I modify int in place so that each column has mean zero.
+It is not modified.
 
 \param dimensions_we_want  (default: the size of the covariance matrix, i.e. <tt>data->size2</tt>)
 The singular value decomposition will return this many of the eigenvectors with the largest eigenvalues.
 
+\param method <tt>'f'</tt>: full decomposition of the covariance matrix.<br>
+<tt>'r'</tt>: randomized, truncated PCA, as above.<br>
+Default: randomized if there are more than 1,000 columns and you want a tenth of them or
+fewer; else full.
+
 \return     Returns a \ref apop_data set whose matrix is the principal component space. Each column of the returned matrix will be another eigenvector; the columns will be ordered by the eigenvalues. 
 The data set's vector will be the largest eigenvalues, scaled by the total of all eigenvalues (including those that were thrown out). The sum of these returned values will give you the percentage of variance explained by the factor analysis.
 \exception out->error=='a'  Allocation error.
+\exception out->error=='m'  The singular value decomposition failed.
+
+\li See \ref apop_pca_query to read the data from the database a block at a time.
+\li This function uses the \ref designated syntax for inputs.
 \ingroup linear_algebra */
-APOP_VAR_HEAD apop_data * apop_matrix_pca(gsl_matrix *data, int const dimensions_we_want) {
+APOP_VAR_HEAD apop_data * apop_matrix_pca(gsl_matrix *data, int const dimensions_we_want, char method) {
     gsl_matrix * apop_varad_var(data, NULL);
     Nullcheck_d(data, NULL);
     int const apop_varad_var(dimensions_we_want, data->size2);
-    if (!data) return NULL;
+    char apop_varad_var(method, 'd');
 APOP_VAR_ENDHEAD
-    Set_gsl_handler
-    apop_data *pc_space	= apop_data_alloc(0, data->size2, dimensions_we_want);
-    Apop_stopif(pc_space->error, return pc_space, 0, "Allocation error.");
-	pc_space->vector = gsl_vector_alloc(dimensions_we_want);
-    Apop_stopif(!pc_space->vector, pc_space->error='a'; return pc_space, 
-                0, "Allocation error setting up a %i vector.", dimensions_we_want);
-    gsl_matrix *eigenvectors = gsl_matrix_alloc(data->size2, data->size2);
-    gsl_vector *dummy_v 	 = gsl_vector_alloc(data->size2);
-    gsl_vector *all_evalues  = gsl_vector_alloc(data->size2);
-    gsl_matrix *square  	 = gsl_matrix_calloc(data->size2, data->size2);
-    Apop_stopif(!eigenvectors || !dummy_v || !all_evalues || !square, pc_space->error='a'; return pc_space, 
-                0, "Allocation error setting up workspace for %zu dimensions.", data->size2);
-    double eigentotals	= 0;
-    apop_matrix_normalize(data, 'c', 'm');
-	Checkgsl(gsl_blas_dgemm(CblasTrans,CblasNoTrans, 1, data, data, 0, square))
-	Checkgsl(gsl_linalg_SV_decomp(square, eigenvectors, all_evalues, dummy_v))
-	for (int i=0; i< all_evalues->size; i++)
-		eigentotals	+= gsl_vector_get(all_evalues, i);
-	for (int i=0; i<dimensions_we_want; i++){
-		APOP_MATRIX_COL(eigenvectors, i, v);
-		gsl_matrix_set_col(pc_space->matrix, i, v);
-		gsl_vector_set(pc_space->vector, i, gsl_vector_get(all_evalues, i)/eigentotals);
-	}
-    done:
-	gsl_vector_free(dummy_v); 	gsl_vector_free(all_evalues);
-	gsl_matrix_free(square); 	gsl_matrix_free(eigenvectors);
-    Unset_gsl_handler
-    return pc_space;
+    return pca_run(&(pca_source){.m=data, .block_size=512}, dimensions_we_want, method);
+}
+
+/** Principal component analysis on the output of a database query, which is read a block
+of rows at a time, so the data set never has to fit in memory. Each pass over the data
+reruns the query: two passes for the full method, and five for the randomized method. Each
+column of the query's output is a variable; otherwise, the inputs and output are as for
+\ref apop_matrix_pca.
+
+\param query The query, which is not a <tt>printf</tt>-style format. (No default; must not be \c NULL.)
+\param dimensions_we_want (default: every column of the query)
+\param method As for \ref apop_matrix_pca. (default: the same choice)
+\param block_size The number of rows to read at a time. (Default: 10,000)
+\return As from \ref apop_matrix_pca, or \c NULL if the query failed or returned no data.
+
+\li This function uses the \ref designated syntax for inputs.
+\ingroup linear_algebra */
+APOP_VAR_HEAD apop_data * apop_pca_query(char const *query, int dimensions_we_want, char method, int block_size){
+    char const * apop_varad_var(query, NULL);
+    Apop_stopif(!query, return NULL, 0, "You gave me a NULL query.");
+    int apop_varad_var(dimensions_we_want, 0);
+    char apop_varad_var(method, 'd');
+    int apop_varad_var(block_size, 10000);
+APOP_VAR_END_HEAD
+    return pca_run(&(pca_source){.query=query, .block_size=block_size}, dimensions_we_want, method);
 }
 
 /** Just add <tt>amt</tt> to a \c gsl_vector element. 
@@ -428,12 +609,160 @@ APOP_VAR_END_HEAD
 }
 
 
-static gsl_vector* dot_for_apop_dot(const gsl_matrix *m, const gsl_vector *v, 
+/* Blocked, threaded matrix products. The reference CBLAS that ships with the GSL runs
+   its loops over whole rows and columns, so once the matrices outgrow the cache, every
+   step is a trip to main memory. Here, the product is cut into square tiles small enough
+   that the tiles of A, B, and C involved in one small dgemm all fit in cache together.
+   Then the work is split across apop_opts.thread_count threads: by tiles of the output if
+   the output is large, or else by slices of the inner dimension, with each thread filling
+   its own partial product and the partials summed at the end (e.g., X'X for tall X). With
+   an optimized BLAS linked in, the tiling costs little and the threading still helps. */
+
+#define Apop_tile 256
+
+typedef struct {
+    CBLAS_TRANSPOSE_t lt, rt;
+    double alpha, beta;
+    gsl_matrix const *a, *b;
+    gsl_matrix *c;
+    size_t row0, row1, k0, k1;   //the rows of C and the span of the inner dimension to do.
+} gemm_job;
+
+static void *gemm_tiles(void *in){
+    gemm_job *j = in;
+    size_t n = j->c->size2;
+    for (size_t i=j->row0; i< j->row1; i+= Apop_tile)
+        for (size_t col=0; col< n; col+= Apop_tile){
+            size_t mi = GSL_MIN(Apop_tile, j->row1 - i), nj = GSL_MIN(Apop_tile, n - col);
+            gsl_matrix_view c = gsl_matrix_submatrix(j->c, i, col, mi, nj);
+            if (j->k1 == j->k0) gsl_matrix_scale(&c.matrix, j->beta);
+            for (size_t k=j->k0; k< j->k1; k+= Apop_tile){
+                size_t kk = GSL_MIN(Apop_tile, j->k1 - k);
+                gsl_matrix_const_view a = (j->lt == CblasNoTrans)
+                                            ? gsl_matrix_const_submatrix(j->a, i, k, mi, kk)
+                                            : gsl_matrix_const_submatrix(j->a, k, i, kk, mi);
+                gsl_matrix_const_view b = (j->rt == CblasNoTrans)
+                                            ? gsl_matrix_const_submatrix(j->b, k, col, kk, nj)
+                                            : gsl_matrix_const_submatrix(j->b, col, k, nj, kk);
+                gsl_blas_dgemm(j->lt, j->rt, j->alpha, &a.matrix, &b.matrix,
+                                        k==j->k0 ? j->beta : 1, &c.matrix);
+            }
+        }
+    return NULL;
+}
+
+//How many threads for a job of this many flops? Keep at least ~10^7 per thread.
+static int thread_ct_for(double flops){
+    return GSL_MAX(1, GSL_MIN(apop_opts.thread_count, flops/1e7));
+}
+
+/* c = alpha op(a) op(b) + beta c, as with gsl_blas_dgemm, which it calls on tiles. The
+   dimensions are assumed to have been checked. */
+void apop_gemm(CBLAS_TRANSPOSE_t lt, CBLAS_TRANSPOSE_t rt, double alpha, gsl_matrix const *a,
+                                     gsl_matrix const *b, double beta, gsl_matrix *c){
+    size_t m = c->size1, n = c->size2, k = (lt == CblasNoTrans) ? a->size2 : a->size1;
+    int threadct = thread_ct_for((double)m*n*k);
+    gemm_job base = {.lt=lt, .rt=rt, .alpha=alpha, .beta=beta, .a=a, .b=b, .c=c,
+                     .row0=0, .row1=m, .k0=0, .k1=k};
+    if (threadct == 1) {gemm_tiles(&base); return;}
+
+    char split_k = (m+Apop_tile-1)/Apop_tile < (size_t)threadct && k > 4*m;
+    gemm_job jobs[threadct];
+    pthread_t thread_id[threadct];
+    for (int t=0; t< threadct; t++){
+        jobs[t] = base;
+        if (split_k){
+            jobs[t].k0 = k*t/threadct;
+            jobs[t].k1 = k*(t+1)/threadct;
+            if (t) {jobs[t].c = gsl_matrix_calloc(m, n); jobs[t].beta = 0;}
+        } else { //whole tiles of rows.
+            size_t tiles = (m+Apop_tile-1)/Apop_tile;
+            jobs[t].row0 = GSL_MIN(m, Apop_tile*(tiles*t/threadct));
+            jobs[t].row1 = GSL_MIN(m, Apop_tile*(tiles*(t+1)/threadct));
+        }
+        if (t) pthread_create(&thread_id[t], NULL, gemm_tiles, jobs+t);
+    }
+    gemm_tiles(jobs);
+    for (int t=1; t< threadct; t++){
+        pthread_join(thread_id[t], NULL);
+        if (split_k){
+            gsl_matrix_add(c, jobs[t].c);
+            gsl_matrix_free(jobs[t].c);
+        }
+    }
+}
+
+typedef struct {
+    gsl_matrix const *x;
+    gsl_vector const *center, *w;
+    gsl_matrix *out;    //upper triangle only
+    size_t start, end;
+} crossprod_job;
+
+static void *crossprod_rows(void *in){
+    crossprod_job *j = in;
+    size_t p = j->x->size2, cstride = j->center ? j->center->stride : 0;
+    double const *center = j->center ? j->center->data : NULL;
+    gsl_matrix *buf = gsl_matrix_alloc(p, Apop_tile); //a panel of rows, transposed, so the syrk reads along rows
+    for (size_t r=j->start; r< j->end; r+= Apop_tile){
+        size_t rows = GSL_MIN(Apop_tile, j->end - r);
+        gsl_matrix_view panel = gsl_matrix_submatrix(buf, 0, 0, p, rows);
+        for (size_t i=0; i< rows; i++){
+            double const *xrow = gsl_matrix_const_ptr(j->x, r+i, 0);
+            double sw = j->w ? sqrt(gsl_vector_get(j->w, r+i)) : 1;
+            for (size_t col=0; col< p; col++)
+                buf->data[col*buf->tda + i] = sw*(xrow[col] - (center ? center[col*cstride] : 0));
+        }
+        for (size_t i=0; i< p; i+= Apop_tile){
+            size_t mi = GSL_MIN(Apop_tile, p - i);
+            gsl_matrix_view pi = gsl_matrix_submatrix(&panel.matrix, i, 0, mi, rows);
+            gsl_matrix_view cii = gsl_matrix_submatrix(j->out, i, i, mi, mi);
+            gsl_blas_dsyrk(CblasUpper, CblasNoTrans, 1, &pi.matrix, 1, &cii.matrix);
+            for (size_t col=i+mi; col< p; col+= Apop_tile){
+                size_t nj = GSL_MIN(Apop_tile, p - col);
+                gsl_matrix_view pj = gsl_matrix_submatrix(&panel.matrix, col, 0, nj, rows);
+                gsl_matrix_view cij = gsl_matrix_submatrix(j->out, i, col, mi, nj);
+                gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1, &pi.matrix, &pj.matrix, 1, &cij.matrix);
+            }
+        }
+    }
+    gsl_matrix_free(buf);
+    return NULL;
+}
+
+/* out = sum_i w_i (x_i - center)(x_i - center)', over the rows x_i of x: X'X if center
+   and w are NULL, or the centered cross-product at the heart of a covariance matrix.
+   One symmetric rank-k update per panel of rows, threaded over the rows. out is p x p and
+   fully filled in. Rows are scaled by sqrt(w_i), so the weights must be nonnegative;
+   the caller checks. */
+void apop_crossprod(gsl_matrix const *x, gsl_vector const *center, gsl_vector const *w, gsl_matrix *out){
+    size_t n = x->size1, p = x->size2;
+    int threadct = thread_ct_for((double)n*p*p/2);
+    crossprod_job jobs[threadct];
+    pthread_t thread_id[threadct];
+    gsl_matrix_set_zero(out);
+    for (int t=0; t< threadct; t++){
+        jobs[t] = (crossprod_job){.x=x, .center=center, .w=w, .start=n*t/threadct, .end=n*(t+1)/threadct,
+                                  .out= t ? gsl_matrix_calloc(p, p) : out};
+        if (t) pthread_create(&thread_id[t], NULL, crossprod_rows, jobs+t);
+    }
+    crossprod_rows(jobs);
+    for (int t=1; t< threadct; t++){
+        pthread_join(thread_id[t], NULL);
+        gsl_matrix_add(out, jobs[t].out);
+        gsl_matrix_free(jobs[t].out);
+    }
+    for (size_t i=0; i< p; i++)
+        for (size_t j=i+1; j< p; j++)
+            gsl_matrix_set(out, j, i, gsl_matrix_get(out, i, j));
+}
+
+static gsl_vector* dot_for_apop_dot(apop_data const *owner, const gsl_matrix *m, const gsl_vector *v, 
                              const CBLAS_TRANSPOSE_t flip){
-    #define Check_gslv(...) if (__VA_ARGS__) {gsl_vector_free(out); out=NULL;}
+    #define Check_gslv(...) if (__VA_ARGS__) {apop_arena_vector_free(out); out=NULL;}
     gsl_vector *out = (flip ==CblasNoTrans)
-                        ? gsl_vector_calloc(m->size1)
-                        : gsl_vector_calloc(m->size2);
+                        ? apop_arena_vector(owner, m->size1, 1)
+                        : apop_arena_vector(owner, m->size2, 1);
     Check_gslv(gsl_blas_dgemv (flip, 1.0, m, v, 0.0, out))
     return out;
 }
@@ -482,6 +811,16 @@ matrix produce an \f$N \times N\f$ matrix, then use \ref apop_vector_to_matrix t
 your vectors into matrices; see the example.
 
 
+\li Matrix-matrix products are cut into cache-sized tiles and split across \c
+apop_opts.thread_count threads, and \f$X'X\f$ (i.e., <tt>apop_dot(x, x, 't')</tt>)
+is done as a symmetric rank-\f$k\f$ update, computing only half of the output.
+
+\li If a data set has a \c sparse block (see \ref apop_sparse), then its matrix is taken
+to be the \c matrix element with the sparse columns to its right. The forms a regression needs are
+implemented: \f$X'Y\f$ where \f$Y\f$ is a vector, a dense matrix, or another data set with a
+sparse block, and \f$X\beta\f$ where \f$\beta\f$ is a vector or a dense matrix. Other
+combinations set <tt>out->error='d'</tt>. The output is always dense.
+
 \li A note for readers of <em>Modeling with Data</em>: the awkward instructions on using
 this function on p 130 are now obsolete, thanks to the designated initializer syntax
 for function calls. Notably, in the case where <tt>d1</tt> is a vector and <tt>d2</tt>
@@ -502,6 +841,8 @@ APOP_VAR_HEAD apop_data * apop_dot(const apop_data *d1, const apop_data *d2, cha
     char apop_varad_var(form1, 0)
     char apop_varad_var(form2, 0)
 APOP_VAR_ENDHEAD
+    if ((d1->sparse && form1 != 'v') || (d2->sparse && form2 != 'v'))
+        return apop_sparse_dot(d1, d2, form1, form2);
     Set_gsl_handler
     int         uselm, userm;
     gsl_matrix  *lm = d1->matrix, 
@@ -543,9 +884,11 @@ APOP_VAR_ENDHEAD
                  (lt== CblasNoTrans) ? lm->size2:lm->size1,
                  (rt== CblasNoTrans) ? rm->size1:rm->size2,
                  (rt== CblasNoTrans) ? rm->size2:rm->size1)
-        gsl_matrix *outm = gsl_matrix_calloc((lt== CblasTrans)? lm->size2: lm->size1, 
-                                             (rt== CblasTrans)? rm->size1: rm->size2);
-        Check_gsl_with_out(gsl_blas_dgemm (lt,rt, 1, lm, rm, 0, outm))
+        gsl_matrix *outm = apop_arena_matrix(out, (lt== CblasTrans)? lm->size2: lm->size1, 
+                                             (rt== CblasTrans)? rm->size1: rm->size2, 1);
+        if (lm == rm && lt == CblasTrans && rt == CblasNoTrans)
+             apop_crossprod(lm, NULL, NULL, outm);
+        else apop_gemm(lt, rt, 1, lm, rm, 0, outm);
         out->matrix = outm;
     } else if (!uselm && userm){
         Dimcheck((size_t)1, lv->size,
@@ -554,19 +897,19 @@ APOP_VAR_ENDHEAD
         //dgemv is always matrix first, then vector, so reverse from vm to mv:
         // if output vector has dimension matrix->size2, send CblasTrans
         // if output vector has dimension matrix->size1, send CblasNoTrans
-        out->vector = dot_for_apop_dot(rm, lv
+        out->vector = dot_for_apop_dot(out, rm, lv
                         , (rt == CblasNoTrans) ? CblasTrans : CblasNoTrans);
         Apop_stopif(!out->vector, out->error='m'; goto done, 0, "GSL-level math error");
     } else if (uselm && !userm){
         Dimcheck((lt== CblasNoTrans) ? lm->size1:lm->size2,
                  (lt== CblasNoTrans) ? lm->size2:lm->size1,
                   rv->size , (size_t)1)
-        out->vector = dot_for_apop_dot(lm, rv , lt);
+        out->vector = dot_for_apop_dot(out, lm, rv , lt);
         Apop_stopif(!out->vector, out->error='m'; goto done, 0, "GSL-level math error");
     } else if (!uselm && !userm){ 
         double outd;
         Check_gsl_with_out(gsl_blas_ddot(lv, rv, &outd))
-        out->vector = gsl_vector_alloc(1);
+        out->vector = apop_arena_vector(out, 1, 0);
         gsl_vector_set(out->vector, 0, outd);
     }
 
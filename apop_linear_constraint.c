@@ -118,7 +118,9 @@ APOP_VAR_HEAD double  apop_linear_constraint(gsl_vector *beta, apop_data * const
             default_constraint = NULL;
         }
         if (!default_constraint){
+            char was_held = apop_arena_hold(1);
             default_constraint = apop_data_alloc(0,beta->size, beta->size);
+            apop_arena_hold(was_held);
             default_constraint->vector = gsl_vector_calloc(beta->size);
             gsl_matrix_set_identity(default_constraint->matrix);
         }
@@ -23,6 +23,9 @@ typedef	void 	(*apop_fdf_with_void)(const gsl_vector *beta, void *d, double *f,
 typedef struct {
 	gsl_vector	*beta;
 	int		    dimension;
+    gsl_matrix  *xbeta;   //If not NULL, evaluate via model->log_likelihood_xbeta; see shifted_xbeta_ll.
+    gsl_matrix const *xbeta_base;
+    double      base_val;
 } grad_params;
 
 typedef struct {
@@ -32,13 +35,19 @@ typedef struct {
     grad_params *gp; //Used only by apop_internal_numerical_gradient.
     gsl_vector  *beta, *starting_pt;
     int         use_constraint;
-    char        *trace_path;
-    FILE        **trace_file;
+    struct trace_buffer *trace;  //NULL if not tracing
     double      best_ll;
     char        want_cov, want_predicted, want_tests, want_info;
     jmp_buf     bad_eval_jump;
 }   infostruct;
 
+typedef struct trace_buffer {
+    char        *path;
+    apop_data   *buf;    //a row per evaluation: the parameters, then the log likelihood
+    size_t      rows;    //rows of buf in use
+    FILE        *file;
+} trace_buffer;
+
 static apop_model * find_roots (infostruct p); //see end of file.
 
 /** \page trace_path Plotting the path of an ML estimation.
@@ -52,6 +61,11 @@ at its MLE.
 
 To write to a pipe or stdout, set \ref apop_opts_type "apop_opts.output_type" appropriately and set \c trace_path to the literal string \c "NULL".
 
+Each row has every parameter, in \ref apop_data_pack order, then the log likelihood. In the
+database, the columns are named \c beta0, \c beta1, ..., \c ll. Rows are held in a buffer and
+written a thousand at a time (the database gets each batch in a single transaction), plus
+whatever is left when the search ends, so tracing is cheap enough to leave on.
+
 
 Below is a sample of the sort of output one would get:<br>
 \image latex "search.gif" "An ML search, tracing out the surface of the function" width=\textwidth
@@ -86,6 +100,12 @@ Apop_settings_init(apop_mle,
     Apop_varad_set(want_cov, 'y');
     if (in.want_cov == 1) out->want_cov = 'y';
     Apop_varad_set(dim_cycle_tolerance, 0);
+    Apop_varad_set(parallel_derivs, 'n');
+    Apop_varad_set(reuse_evals, 'n');
+    Apop_varad_set(start_pts, NULL);
+    Apop_varad_set(starts, (in.start_pts && in.start_pts->matrix) ? in.start_pts->matrix->size1 : 1);
+    Apop_varad_set(start_range, 1);
+    Apop_varad_set(batch_size, 1000);
 //siman:
     //siman also uses step_size  = 1.;  
     Apop_varad_set(n_tries, 5);  //The number of points to try for each step. 
@@ -94,6 +114,7 @@ Apop_settings_init(apop_mle,
     Apop_varad_set(t_initial, 50);   //cooling schedule data
     Apop_varad_set(mu_t, 1.002); 
     Apop_varad_set(t_min, 5.0e-1);
+    Apop_varad_set(replicas, 4);
     Apop_varad_set(rng, NULL);
 )
 
@@ -106,12 +127,28 @@ apop_mle_settings *apop_mle_settings_alloc(apop_model *parent){
 //negate the likelihood fns without bothering the user.
 
 static apop_model * apop_annealing(infostruct*); //below.
+static apop_model * apop_tempering(infostruct*); //below.
+
+/* Changing coefficient (r, c) by delta changes column c of X beta by delta times
+ column r of X, so rebuild that one column from the cached product: O(n), not O(nk). */
+static double shifted_xbeta_ll(infostruct *i, double b){
+    grad_params *gp = i->gp;
+    size_t r = gp->dimension / gp->xbeta->size2,
+           c = gp->dimension % gp->xbeta->size2;
+    Apop_matrix_col(gp->xbeta, c, xb);
+    Apop_matrix_col((gsl_matrix*)gp->xbeta_base, c, base);
+    Apop_matrix_col(i->data->matrix, r, x);
+    gsl_vector_memcpy(xb, base);
+    gsl_blas_daxpy(b - gp->base_val, x, xb);
+    return i->model->log_likelihood_xbeta(i->data, gp->xbeta, i->model);
+}
 
 static double one_d(double b, void *in){
     infostruct *i  = in;
     double penalty = 0;
     gsl_vector_set(i->gp->beta, i->gp->dimension, b);
-    apop_data_unpack(i->gp->beta, i->model->parameters);
+    apop_param_unpack(i->gp->beta, i->model);
+    if (i->gp->xbeta) return shifted_xbeta_ll(i, b); //no constraint; see uses_xbeta.
 	if (i->model->constraint)
 		penalty	= i->model->constraint(i->data, i->model);
 	return (*(i->f))(i->data, i->model) + penalty;
@@ -119,23 +156,129 @@ static double one_d(double b, void *in){
 
 //Numeric first and second derivatives.
 
+/* The finite differences along each dimension are independent, so if the
+ model's apop_mle_settings group asks for parallel_derivs, the dimensions are
+ split across apop_opts.thread_count threads. Each thread works on a private copy of
+ the model, so nobody unpacks into parameters another thread is reading. A
+ derivative taken inside a worker thread (e.g., the score in a Hessian) runs
+ serially. */
+
+static threadlocal int in_deriv_thread;
+
+typedef struct deriv_thread {
+    apop_model  *model;   //a private copy, or the original if running serially
+    gsl_vector  *beta, *score;
+    gsl_matrix  *xbeta;   //allocated on first use by grad_dim
+    size_t      start, end, dim, row;
+    void        *shared;
+    void        (*fn)(struct deriv_thread *);
+    char        threaded;
+} deriv_thread;
+
+static void *deriv_loop(void *in){
+    deriv_thread *t = in;
+    if (t->threaded) in_deriv_thread = 1;
+    for (t->dim = t->start; t->dim < t->end; t->dim++)
+        t->fn(t);
+    return NULL;
+}
+
+static void deriv_run(apop_model *m, size_t dims, size_t score_size, void (*fn)(deriv_thread*), void *shared){
+    if (!dims) return;
+    apop_mle_settings *mp = apop_settings_get_group(m, apop_mle);
+    int threadct = (in_deriv_thread || !mp || mp->parallel_derivs != 'y')
+                        ? 1 : GSL_MAX(1, GSL_MIN(dims, apop_opts.thread_count));
+    deriv_thread t[threadct];
+    pthread_t thread_id[threadct];
+    double *scratch = malloc(sizeof(double)*threadct*(dims + score_size)); //each thread's beta, then score
+    gsl_vector views[2*threadct];
+    for (int i=0; i< threadct; i++){
+        views[2*i] = gsl_vector_view_array(scratch + i*(dims+score_size), dims).vector;
+        if (score_size) views[2*i+1] = gsl_vector_view_array(scratch + i*(dims+score_size) + dims, score_size).vector;
+        t[i] = (deriv_thread){ .model = threadct==1 ? m : apop_model_copy(*m),
+                    .beta = views+2*i, .score = score_size ? views+2*i+1 : NULL,
+                    .start = i*(dims/threadct), .end = (i==threadct-1) ? dims : (i+1)*(dims/threadct),
+                    .shared = shared, .fn = fn, .threaded = threadct > 1 };
+    }
+    if (threadct==1) deriv_loop(t);
+    else {
+        for (int i=0; i< threadct; i++)
+            pthread_create(&thread_id[i], NULL, deriv_loop, t+i);
+        for (int i=0; i< threadct; i++)
+            pthread_join(thread_id[i], NULL);
+    }
+    for (int i=0; i< threadct; i++){
+        if (threadct > 1) apop_model_free(t[i].model);
+        if (t[i].xbeta) gsl_matrix_free(t[i].xbeta);
+    }
+    free(scratch);
+}
+
+typedef struct {
+    infostruct          *info;
+    apop_fn_with_params ll;
+    gsl_vector          *beta, *out;
+    gsl_matrix          *xbeta;
+    double              delta;
+} grad_shared;
+
+static void grad_dim(deriv_thread *t){
+    grad_shared *g = t->shared;
+    double result, err;
+    infostruct i = *g->info;
+    i.model = t->model;
+    i.f = &g->ll;
+    i.gp = &(grad_params){ .beta = t->beta, .dimension = t->dim };
+    if (g->xbeta){
+        if (!t->xbeta){
+            t->xbeta = gsl_matrix_alloc(g->xbeta->size1, g->xbeta->size2);
+            gsl_matrix_memcpy(t->xbeta, g->xbeta);
+        }
+        *i.gp = (grad_params){ .beta = t->beta, .dimension = t->dim, .xbeta = t->xbeta,
+                       .xbeta_base = g->xbeta, .base_val = gsl_vector_get(g->beta, t->dim) };
+    }
+    gsl_function F = { .function= one_d, 
+                       .params	= &i };
+    gsl_vector_memcpy(t->beta, g->beta);
+    gsl_deriv_central(&F, gsl_vector_get(g->beta, t->dim), g->delta, &result, &err);
+    gsl_vector_set(g->out, t->dim, result);
+    if (g->xbeta){ //put back the column we shifted
+        Apop_matrix_col(t->xbeta, t->dim % g->xbeta->size2, xb);
+        Apop_matrix_col(g->xbeta, t->dim % g->xbeta->size2, base);
+        gsl_vector_memcpy(xb, base);
+    }
+}
+
+/* Can we use the cached-X beta shortcut? Only if the parameters are exactly one
+ matrix conformable with the data, and there's no constraint to nudge them. */
+static int uses_xbeta(infostruct *info, apop_fn_with_params ll, size_t betasize){
+    apop_model *m = info->model;
+    apop_data *p = m->parameters;
+    return m->log_likelihood_xbeta && ll == m->log_likelihood && !m->constraint
+        && info->data && info->data->matrix && !info->data->sparse
+        && p->matrix && !p->vector && !p->weights
+        && p->matrix->size1 == info->data->matrix->size2
+        && betasize == p->matrix->size1 * p->matrix->size2;
+}
+
 /* For each element of the parameter set, jiggle it to find its
  gradient. Return a vector as long as the parameter list. */
 static void apop_internal_numerical_gradient(apop_fn_with_params ll, 
                             infostruct* info, gsl_vector *out, double delta){
-    double result, err;
-    gsl_vector *beta = apop_data_pack(info->model->parameters, NULL, .all_pages='y');
-    infostruct i = *info;
-    i.f = &ll;
-    i.gp = &(grad_params){ .beta = gsl_vector_alloc(beta->size)};
-    gsl_function F = { .function= one_d, 
-                       .params	= &i };
-	for (size_t j=0; j< beta->size; j++){
-		i.gp->dimension = j;
-		gsl_vector_memcpy(i.gp->beta, beta);
-		gsl_deriv_central(&F, gsl_vector_get(beta,j), delta, &result, &err);
-		gsl_vector_set(out, j, result);
-	}
+    if (info->model->log_likelihood_dual && ll == info->model->log_likelihood){
+        apop_dual_ll(info->data, info->model, out, NULL);
+        return;
+    }
+    size_t k = apop_param_count(info->model);
+    if (!k) return;
+    gsl_vector *beta = gsl_vector_alloc(k);
+    apop_param_pack(info->model, beta);
+    grad_shared g = { .info = info, .ll = ll, .beta = beta, .out = out, .delta = delta };
+    apop_data *xbeta = uses_xbeta(info, ll, beta->size) ? apop_dot(info->data, info->model->parameters) : NULL;
+    if (xbeta) g.xbeta = xbeta->matrix;
+    deriv_run(info->model, beta->size, 0, grad_dim, &g);
+    apop_param_unpack(beta, info->model);
+    apop_data_free(xbeta);
     gsl_vector_free(beta);
 }
 
@@ -150,6 +293,12 @@ static void apop_internal_numerical_gradient(apop_fn_with_params ll,
  gsl_vector *gradient = apop_numerical_gradient(data, your_parametrized_model);
  \endcode
 
+\li If \c model has a \c log_likelihood_dual method, then the gradient is exact, via
+forward-mode differentiation (see \ref apop_dual), and \c delta is ignored.
+\li Else, if \c model has a \c log_likelihood_xbeta method, then \f$X\beta\f$ is calculated
+once, and each step updates the one column of it that the step changes.
+\li If \c model has an \ref apop_mle_settings group with <tt>.parallel_derivs='y'</tt>, then the
+dimensions are split across \ref apop_opts_type "apop_opts.thread_count" threads, each using its own copy of the model.
 \li This function uses the \ref designated syntax for inputs.
 \ingroup linear_algebra
  */
@@ -173,30 +322,66 @@ APOP_VAR_ENDHEAD
 }
 
 typedef struct {
-    apop_model *base_model;
-    int *current_index;
-} apop_model_for_infomatrix_struct;
-
-static double apop_fn_for_infomatrix(apop_data *d, apop_model *m){
-    static gsl_vector *v = NULL;
-    apop_model_for_infomatrix_struct *settings = m->more;
-    apop_model *mm = settings->base_model;
-    if (mm->score){
-        if (!v || v->size != mm->parameters->vector->size){
-            if (v) gsl_vector_free(v);
-            v = gsl_vector_alloc(mm->parameters->vector->size);
-        }
-         mm->score(d, v, mm);
-        return gsl_vector_get(v, *settings->current_index);
-    } //else:
-        gsl_vector *vv = apop_numerical_gradient(d, mm);
-        double out = gsl_vector_get(vv, *settings->current_index);
-        gsl_vector_free(vv);
-        return out;
+    apop_data   *data;
+    gsl_vector  *beta;
+    gsl_matrix  *dscore;
+    double      delta, score_delta;
+} hess_shared;
+
+//The closed-form score if there is one, else the numerical gradient.
+static void score_at(apop_data *d, apop_model *m, gsl_vector *out, double delta){
+    if (m->score) m->score(d, out, m);
+    else if (m->log_likelihood_score) m->log_likelihood_score(d, out, m);
+    else {
+        apop_fn_with_params ll = m->log_likelihood ? m->log_likelihood : m->p;
+        apop_internal_numerical_gradient(ll, &(infostruct){.model = m, .data = d}, out, delta);
+    }
+}
+
+static void score_with_dim_at(deriv_thread *t, double b, gsl_vector *out){
+    hess_shared *h = t->shared;
+    gsl_vector_memcpy(t->beta, h->beta);
+    gsl_vector_set(t->beta, t->dim, b);
+    apop_param_unpack(t->beta, t->model);
+    score_at(h->data, t->model, out, h->score_delta);
 }
 
-apop_model apop_model_for_infomatrix = {"Ad hoc model for working out the information matrix.", 
-                                                .log_likelihood = apop_fn_for_infomatrix};
+static double score_elmt(double b, void *in){
+    deriv_thread *t = in;
+    score_with_dim_at(t, b, t->score);
+    return gsl_vector_get(t->score, t->row);
+}
+
+//Column dim of the derivative of the score, one element at a time.
+static void hess_col(deriv_thread *t){
+    hess_shared *h = t->shared;
+    double result, err;
+    gsl_function F = { .function = score_elmt, .params = t };
+    for (t->row=0; t->row < h->beta->size; t->row++){
+        gsl_deriv_central(&F, gsl_vector_get(h->beta, t->dim), h->delta, &result, &err);
+        gsl_matrix_set(h->dscore, t->row, t->dim, result);
+    }
+}
+
+/* Column dim of the derivative of the score, with each score vector used for
+ the whole column. This is the five-point stencil of gsl_deriv_central's
+ first pass, without its search for a better step size. */
+static void hess_col_reuse(deriv_thread *t){
+    hess_shared *h = t->shared;
+    double x = gsl_vector_get(h->beta, t->dim);
+    double step[] = {-h->delta, h->delta, -h->delta/2, h->delta/2};
+    gsl_vector *f[4];
+    for (int s=0; s< 4; s++){
+        f[s] = gsl_vector_alloc(h->beta->size);
+        score_with_dim_at(t, x + step[s], f[s]);
+    }
+    for (size_t k=0; k< h->beta->size; k++){
+        double r3 = (gsl_vector_get(f[1], k) - gsl_vector_get(f[0], k))/2;
+        double r5 = (4./3.)*(gsl_vector_get(f[3], k) - gsl_vector_get(f[2], k)) - r3/3.;
+        gsl_matrix_set(h->dscore, k, t->dim, r5/h->delta);
+    }
+    for (int s=0; s< 4; s++) gsl_vector_free(f[s]);
+}
 
 /** Numerically estimate the matrix of second derivatives of the
 parameter values. The math is
@@ -207,6 +392,11 @@ parameter values. The math is
 \param delta the step size for the differentials. The current default is around 1e-3.
 \return The matrix of estimated second derivatives at the given data and parameter values.
  
+\li If \c model has a \c log_likelihood_dual method, then the Hessian is exact, via
+forward-mode differentiation (see \ref apop_dual), and the rest of these notes don't apply.
+\li If \c model has an \ref apop_mle_settings group, its \c parallel_derivs and \c reuse_evals
+elements apply here. With <tt>.reuse_evals='y'</tt>, each evaluation of the score fills a full
+column of the Hessian, so there are four score evaluations per parameter instead of four per element.
 \li This function uses the \ref designated syntax for inputs.
  */
 APOP_VAR_HEAD apop_data * apop_model_hessian(apop_data * data, apop_model *model, double delta){
@@ -219,27 +409,29 @@ APOP_VAR_HEAD apop_data * apop_model_hessian(apop_data * data, apop_model *model
         delta = mp ? mp->delta : default_delta;
     }
 APOP_VAR_ENDHEAD
-    int    k;
-    Get_vmsizes(model->parameters) //tsize
-    size_t betasize  = tsize;
+    Apop_stopif(!model->score && !model->log_likelihood && !model->p, return NULL, 0,
+            "Input model has neither score, p, nor log_likelihood method. Returning NULL.");
+    apop_mle_settings *mp = apop_settings_get_group(model, apop_mle);
+    gsl_vector *beta = apop_data_pack(model->parameters, NULL, .all_pages='y');
+    size_t betasize  = beta->size;
     apop_data *out    = apop_data_calloc(0, betasize, betasize);
-    gsl_vector *dscore = gsl_vector_alloc(betasize);
-    apop_model_for_infomatrix_struct ms = { .base_model = model, .current_index = &k, };
-    apop_model *m = apop_model_copy(apop_model_for_infomatrix);
-    m->parameters = model->parameters;
-    m->more = &ms;
-    if (apop_settings_get_group(model, apop_mle))
-        apop_settings_copy_group(m, model, "apop_mle");
-    for (k=0; k< betasize; k++){
-        dscore = apop_numerical_gradient(data, m, delta);
+    if (model->log_likelihood_dual && model->log_likelihood){
+        apop_dual_ll(data, model, NULL, out->matrix);
+    } else {
+        hess_shared h = { .data = data, .beta = beta, .dscore = gsl_matrix_alloc(betasize, betasize),
+                          .delta = delta, .score_delta = mp ? mp->delta : default_delta };
+        deriv_run(model, betasize, betasize, (mp && mp->reuse_evals=='y') ? hess_col_reuse : hess_col, &h);
+        apop_param_unpack(beta, model);
+
         //We get two estimates of the (k,j)th element, which are often very close,
         //and take the mean.
-        for (size_t j=0; j< betasize; j++){
-            apop_matrix_increment(out->matrix, k, j, gsl_vector_get(dscore, j)/2);
-            apop_matrix_increment(out->matrix, j, k, gsl_vector_get(dscore, j)/2);
-        }
-        gsl_vector_free(dscore);
+        for (size_t k=0; k< betasize; k++)
+            for (size_t j=0; j< betasize; j++)
+                gsl_matrix_set(out->matrix, k, j, gsl_matrix_get(h.dscore, k, j)/2
+                                                + gsl_matrix_get(h.dscore, j, k)/2);
+        gsl_matrix_free(h.dscore);
     }
+    gsl_vector_free(beta);
     if (model->parameters->names->row){
         apop_name_stack(out->names, model->parameters->names, 'r');
         apop_name_stack(out->names, model->parameters->names, 'c', 'r');
@@ -289,35 +481,69 @@ APOP_VAR_ENDHEAD
 
 ///On to the interfaces between the models and the methods
 
-static void tracepath(const gsl_vector *beta, double out, char tp[], FILE **tf){
+/* Tracing: each evaluation's parameters and log likelihood go into one row of a
+ preallocated buffer, which is written out when it fills and when the search ends. The
+ database gets each batch as one prepared-statement insert inside a savepoint, rather than
+ a formatted query per evaluation. Searches in several threads (see multistart) each have
+ their own buffer, and take turns writing. */
+#define Trace_rows 1000
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void trace_flush(trace_buffer *t){
+    if (!t || !t->rows) return;
+    apop_data view = *t->buf;
+    gsl_matrix filled = gsl_matrix_submatrix(t->buf->matrix, 0, 0, t->rows, t->buf->matrix->size2).matrix;
+    view.matrix = &filled;
+    pthread_mutex_lock(&trace_lock);
     if (apop_opts.output_type == 'd'){
-        if (beta->size == 1){
-            if(!apop_table_exists(tp, 0))
-                apop_query("create table  %s (beta0, ll);", tp);
-            apop_query("insert into %s values (%g, %g);", tp, gsl_vector_get(beta,0), out);
-        } else {
-            if(!apop_table_exists(tp, 0))
-                apop_query("create table  %s (beta0, beta1, ll);", tp);
-            apop_query("insert into %s values (%g, %g, %g);", tp, gsl_vector_get(beta,0), gsl_vector_get(beta,1), out);
-        }
-    } else if (apop_opts.output_type == 'p'){
-        if (beta->size == 1)
-            fprintf(apop_opts.output_pipe, "%g\t %g\n",  gsl_vector_get(beta,0), out);
-        else
-            fprintf(apop_opts.output_pipe, "%g\t %g\t %g\n",  gsl_vector_get(beta,0), gsl_vector_get(beta,1), out);
+        if (apop_opts.db_engine != 'm') apop_query("savepoint apop_trace;");
+        apop_data_to_db(&view, t->path, 'a');
+        if (apop_opts.db_engine != 'm') apop_query("release apop_trace;");
     } else {
-        if (!*tf){
-            if (apop_opts.output_type == 's' && !strcmp(tp, "NULL"))
-                *tf = stdout;
+        FILE *f = t->file;
+        if (apop_opts.output_type == 'p') f = apop_opts.output_pipe;
+        else if (!f){
+            if (apop_opts.output_type == 's' && !strcmp(t->path, "NULL"))
+                f = t->file = stdout;
             else
-                Apop_stopif(!(*tf = fopen(tp, "a")), /*keep going.*/,
-                    0, "couldn't open %s for writing. Continuing without the path trace.", tp);
+                Apop_stopif(!(f = t->file = fopen(t->path, "a")), t->rows = 0; pthread_mutex_unlock(&trace_lock); return,
+                    0, "couldn't open %s for writing. Continuing without the path trace.", t->path);
         }
-        if (beta->size == 1)
-            fprintf(*tf, "%g\t %g\n",  gsl_vector_get(beta,0), out);
-        else
-            fprintf(*tf, "%g\t %g\t %g\n",  gsl_vector_get(beta,0), gsl_vector_get(beta,1), out);
+        for (size_t r=0; r< t->rows; r++)
+            for (size_t c=0; c< filled.size2; c++)
+                fprintf(f, c+1 < filled.size2 ? "%g\t " : "%g\n", gsl_matrix_get(&filled, r, c));
+        fflush(f);
     }
+    pthread_mutex_unlock(&trace_lock);
+    t->rows = 0;
+}
+
+static void trace_add(infostruct *i, double ll){
+    trace_buffer *t = i->trace;
+    if (!t->buf){
+        size_t k = apop_param_count(i->model);
+        t->buf = apop_data_alloc(Trace_rows, k+1);
+        char name[100];
+        for (size_t j=0; j< k; j++){
+            snprintf(name, 100, "beta%zu", j);
+            apop_name_add(t->buf->names, name, 'c');
+        }
+        apop_name_add(t->buf->names, "ll", 'c');
+    }
+    Apop_matrix_row(t->buf->matrix, t->rows, row);
+    gsl_vector params = gsl_vector_subvector(row, 0, row->size-1).vector;
+    apop_param_pack(i->model, &params);
+    gsl_vector_set(row, row->size-1, ll);
+    if (++t->rows == Trace_rows) trace_flush(t);
+}
+
+//Write what's left and release the buffer. Called when the search ends.
+static void trace_done(trace_buffer *t){
+    if (!t) return;
+    trace_flush(t);
+    apop_data_free(t->buf);
+    if (t->file && t->file != stdout) fclose(t->file);
 }
 
 /* Every actual evaluation of the function go through the negshell and dnegshell fns,
@@ -332,25 +558,26 @@ static void tracepath(const gsl_vector *beta, double out, char tp[], FILE **tf){
 --Check constraints.
 */
 
-static double negshell (const gsl_vector *beta, void * in){
-    infostruct *i = in;
+/* If g is non-NULL and the model has a log_likelihood_score method, then fill g with
+ the score (not yet negated) on the same pass that finds the log likelihood. */
+static double negshell_and_score(const gsl_vector *beta, infostruct *i, gsl_vector *g){
     double penalty = 0,
            out     = 0; 
     double (*f)(apop_data *, apop_model *);
     f = i->model->log_likelihood? i->model->log_likelihood : i->model->p;
     Apop_stopif(!f, longjmp(i->bad_eval_jump, -1),
                 0, "The model you sent to the MLE function has neither log_likelihood element nor p element.");
-    apop_data_unpack(beta, i->model->parameters);
+    apop_param_unpack(beta, i->model);
 	if (i->use_constraint && i->model->constraint)
 		penalty	= i->model->constraint(i->data, i->model);
-    if (penalty) apop_data_pack(i->model->parameters, (gsl_vector*) beta, .all_pages='y');
-    double f_val = f(i->data, i->model);
+    if (penalty) apop_param_pack(i->model, (gsl_vector*) beta);
+    double f_val = g ? i->model->log_likelihood_score(i->data, g, i->model)
+                     : f(i->data, i->model);
     out = penalty - f_val; //negative llikelihood
     Apop_stopif(gsl_isnan(out), longjmp(i->bad_eval_jump, -1),
                 0, "I got a NaN in evaluating the objective function.%s", 
                     !i->model->constraint ? " Maybe add a constraint to your model?" : "");
-    if (i->trace_path && strlen(i->trace_path))
-        tracepath(i->model->parameters->vector,-out, i->trace_path, i->trace_file);
+    if (i->trace) trace_add(i, -out);
     if (i->want_info =='y'){
         //I report the log likelihood under the assumption that the final param set 
         //matches the best ll evaluated.
@@ -370,6 +597,10 @@ static double negshell (const gsl_vector *beta, void * in){
     return out;
 }
 
+static double negshell (const gsl_vector *beta, void * in){
+    return negshell_and_score(beta, in, NULL);
+}
+
 static int dnegshell (const gsl_vector *beta, void * in, gsl_vector * g){
 /* The derivative-calculating routine.
 If the constraint binds
@@ -383,31 +614,54 @@ Finally, reverse the sign, since the GSL is trying to minimize instead of maximi
 */
     infostruct *i = in;
     apop_mle_settings *mp =  apop_settings_get_group(i->model, apop_mle);
-    apop_data_unpack(beta, i->model->parameters);
+    apop_param_unpack(beta, i->model);
     /* In all cases, negshell gets called first, so the constraint is already
        checked and beta nudged accordingly.
     if(i->model->constraint && i->model->constraint(i->data, i->model))
-            apop_data_pack(i->model->parameters, (gsl_vector *) beta, .all_pages='y'); */
+            apop_param_pack(i->model, (gsl_vector *) beta); */
     if (i->model->score)
         i->model->score(i->data, g, i->model);
+    else if (i->model->log_likelihood_score)
+        i->model->log_likelihood_score(i->data, g, i->model);
     else {
         apop_fn_with_params ll  = i->model->log_likelihood ? i->model->log_likelihood : i->model->p;
         apop_internal_numerical_gradient(ll, i, g, mp->delta);
     }
-    if (i->trace_path && strlen(i->trace_path))
-        negshell (beta,  in);
+    if (i->trace) negshell (beta,  in);
     gsl_vector_scale(g, -1);
     return GSL_SUCCESS;
 }
 
-//This is just to satisfy the GSL's format.
-static void fdf_shell(const gsl_vector *beta, void *i, double *f, gsl_vector *df){
+/* The GSL asks for f and df at the same point often enough that a model's
+ log_likelihood_score, which gets both in one pass through the data, is worth using. */
+static void fdf_shell(const gsl_vector *beta, void *in, double *f, gsl_vector *df){
+    infostruct *i = in;
+    if (i->model->log_likelihood_score && i->model->log_likelihood){
+        *f = negshell_and_score(beta, i, df);
+        gsl_vector_scale(df, -1);
+        return;
+    }
     *f	= negshell(beta, i);
     dnegshell(beta, i, df);
 }
 
-static int ctrl_c;
-static void mle_sigint(){ ctrl_c ++; }
+/* Ctrl-C stops a search early. A search run by itself installs the handler and clears the
+ flag. The searches multistart runs leave both to multistart, which installs the handler
+ once for all of them: one search finishing must not drop the handler while others run,
+ and one search starting must not erase an interrupt already requested. */
+static volatile sig_atomic_t ctrl_c;
+static threadlocal char in_multistart;
+static void mle_sigint(int sig){ ctrl_c = 1; }
+
+static void mle_sigint_catch(){
+    if (in_multistart) return;
+    ctrl_c = 0;
+    signal(SIGINT, mle_sigint);
+}
+
+static void mle_sigint_release(){
+    if (!in_multistart) signal(SIGINT, NULL);
+}
 
 static int setup_starting_point(apop_mle_settings *mp, gsl_vector *x){
     Apop_stopif(!x, return -1, 0, "The vector I'm trying to optimize over is NULL.");
@@ -480,9 +734,8 @@ Inside the infostruct, you'll find these elements:
         .fdf	= (apop_fdf_with_void) fdf_shell,
         .n		= betasize,
         .params	= i};
-    ctrl_c = 0;
 	gsl_multimin_fdfminimizer_set (s, &minme, i->beta, mp->step_size, mp->tolerance);
-    signal(SIGINT, mle_sigint);
+    mle_sigint_catch();
     do { 	
         iter++;
         if (setjmp(i->bad_eval_jump)) {
@@ -499,10 +752,10 @@ Inside the infostruct, you'll find these elements:
             printf ("%5i %.5f  f()=%10.5f gradient=%.3f\n", iter, gsl_vector_get (s->x, 0),  s->f, gsl_vector_get(s->gradient,0));
         Apop_stopif(status == GSL_SUCCESS, apopstatus=0, 2, "Optimum found.");
     } while (status == GSL_CONTINUE && iter < mp->max_iterations && !ctrl_c);
-    signal(SIGINT, NULL);
+    mle_sigint_release();
 	Apop_stopif(iter==mp->max_iterations, apopstatus = -1, 1, "Max iterations reached, implying that I did not find an optimum.");
 	//Clean up, copy results to output estimate.
-    apop_data_unpack(s->x, est->parameters);
+    apop_param_unpack(s->x, est);
 	gsl_multimin_fdfminimizer_free(s);
     gsl_vector_free(i->beta);
     auxinfo(est->parameters, i, apopstatus, i->best_ll);
@@ -523,13 +776,12 @@ static apop_model *	apop_maximum_likelihood_no_d(apop_data * data, infostruct *
     double size;
     s = gsl_multimin_fminimizer_alloc(gsl_multimin_fminimizer_nmsimplex, betasize);
     ss = gsl_vector_alloc(betasize);
-    ctrl_c      =
     apopstatus = 0; //assume failure until we score a success.
     gsl_vector_set_all (ss,  mp->step_size);
     gsl_multimin_function  minme = {.f = negshell, .n= betasize, .params = i};
     gsl_multimin_fminimizer_set (s, &minme, i->beta,  ss);
     //i->beta = s->x;
-    signal(SIGINT, mle_sigint);
+    mle_sigint_catch();
     do {  
         iter++;
         if (setjmp(i->bad_eval_jump)) {
@@ -554,16 +806,193 @@ static apop_model *	apop_maximum_likelihood_no_d(apop_data * data, infostruct *
             }
         }
     } while (status == GSL_CONTINUE && iter < mp->max_iterations && !ctrl_c);
-    signal(SIGINT, NULL);
+    mle_sigint_release();
 	Apop_stopif(iter == mp->max_iterations && mp->verbose, /*continue*/, 
                 1, "Optimization reached maximum number of iterations.");
     if (status == GSL_SUCCESS) apopstatus = 0;
-    apop_data_unpack(s->x, est->parameters);
+    apop_param_unpack(s->x, est);
 	gsl_multimin_fminimizer_free(s);
+    gsl_vector_free(ss);
+    gsl_vector_free(i->beta);
     auxinfo(est->parameters, i, apopstatus, i->best_ll);
 	return est;
 }
 
+/** \page minibatch Mini-batch optimization
+
+When there are many rows of data, each evaluation of the log likelihood and its gradient
+over the full data set is expensive, but a gradient calculated from a random sample of a
+few hundred or thousand rows is a decent estimate of the full gradient. The mini-batch
+methods take \c max_iterations steps, each using the gradient from a fresh sample of
+\c batch_size rows (drawn with replacement), then finish with a conjugate gradient search
+over the full data, starting from wherever the mini-batch steps ended. Because that
+search begins near the optimum, it typically takes only a few iterations.
+
+\li \c APOP_SGD: Each step moves along the gradient, using the Adam rules for momentum
+and per-parameter step scaling. The step size is \c step_size.
+
+\li \c APOP_SGD_LBFGS: Each step moves along the L-BFGS direction built from the last ten
+steps. The gradient at each new point is calculated on the same sample as the gradient at
+the old point, so every step's curvature estimate compares like with like. This takes
+two gradients per step, but typically needs far fewer steps than \c APOP_SGD.
+
+The gradient is your model's \c score if it has one, else the numerical gradient. The
+rows are copied to a preallocated batch set, along with the vector and weights; the
+other pages of the data set (e.g., the list of factors for a probit or logit) are
+shared with the full data. If your data has text or a sparse block, I skip the mini-batch
+steps and go straight to the full-data search.
+
+If your data has no more than \c batch_size rows, there is nothing to gain by subsampling,
+so I go straight to the full-data search.
+
+Ctrl-C during the mini-batch steps stops there: the full-data search is skipped, and the
+<tt>status</tt> in the info page is -1.
+
+\ingroup mle
+*/
+
+static void gather_rows(apop_data *batch, apop_data const *data, gsl_rng *r){
+    Get_vmsizes(batch); //maxsize
+    size_t n = data->matrix ? data->matrix->size1 : data->vector->size;
+    for (size_t j=0; j< maxsize; j++){
+        size_t row = gsl_rng_uniform_int(r, n);
+        if (batch->vector) gsl_vector_set(batch->vector, j, gsl_vector_get(data->vector, row));
+        if (batch->weights) gsl_vector_set(batch->weights, j, gsl_vector_get(data->weights, row));
+        if (batch->matrix){
+            Apop_matrix_row(data->matrix, row, src);
+            Apop_matrix_row(batch->matrix, j, dest);
+            gsl_vector_memcpy(dest, src);
+        }
+    }
+}
+
+/* The mean gradient of the log likelihood over the batch, at beta; dnegshell
+   gives the negation, and bi->data is the batch. */
+static void batch_gradient(infostruct *bi, gsl_vector *beta, gsl_vector *g){
+    apop_param_unpack(beta, bi->model);
+    if (bi->model->constraint && bi->model->constraint(bi->data, bi->model))
+        apop_param_pack(bi->model, beta);
+    dnegshell(beta, bi, g);
+    Get_vmsizes(bi->data); //maxsize
+    gsl_vector_scale(g, -1./maxsize);
+}
+
+//The L-BFGS two-loop recursion: d = H g, from the last ct (s, y) pairs, newest at [newest].
+static void lbfgs_direction(gsl_matrix *s, gsl_matrix *y, double *rho, int ct, int newest,
+                            gsl_vector const *g, gsl_vector *d){
+    int m = s->size1;
+    double alpha[m];
+    gsl_vector_memcpy(d, g);
+    for (int k=0; k< ct; k++){
+        int j = (newest - k + m) % m;
+        Apop_matrix_row(s, j, sj);
+        Apop_matrix_row(y, j, yj);
+        double a;
+        gsl_blas_ddot(sj, d, &a);
+        alpha[j] = rho[j] * a;
+        gsl_blas_daxpy(-alpha[j], yj, d);
+    }
+    if (ct){
+        Apop_matrix_row(y, newest, yn);
+        gsl_vector_scale(d, 1/(rho[newest] * gsl_pow_2(gsl_blas_dnrm2(yn))));
+    }
+    for (int k=ct-1; k>= 0; k--){
+        int j = (newest - k + m) % m;
+        Apop_matrix_row(s, j, sj);
+        Apop_matrix_row(y, j, yj);
+        double b;
+        gsl_blas_ddot(yj, d, &b);
+        gsl_blas_daxpy(alpha[j] - rho[j]*b, sj, d);
+    }
+}
+
+static apop_model *apop_minibatch(apop_data *data, infostruct *i){
+    apop_mle_settings *mp = Apop_settings_get_group(i->model, apop_mle);
+    Get_vmsizes(data); //vsize, msize1, msize2, maxsize
+    Apop_stopif(data && (data->textsize[0] || data->sparse), return apop_maximum_likelihood_w_d(data, i),
+            1, "Mini-batch sampling doesn't handle text or sparse columns; using the full data set.");
+    if (!data || maxsize <= mp->batch_size) return apop_maximum_likelihood_w_d(data, i);
+
+    size_t k = i->beta->size, b = mp->batch_size;
+    apop_data *batch = apop_data_alloc(vsize ? b : 0, msize1 ? b : 0, msize2);
+    if (data->weights) batch->weights = gsl_vector_alloc(b);
+    batch->more = data->more;
+    apop_name_free(batch->names);
+    batch->names = apop_name_copy(data->names);
+    infostruct bi = *i;
+    bi.data = batch;
+    bi.trace = NULL;
+    bi.want_info = 'n';
+    gsl_rng *r = mp->rng ? mp->rng : apop_rng_alloc(apop_opts.rng_seed++);
+    gsl_vector *beta = i->beta, *g = gsl_vector_alloc(k), *d = gsl_vector_alloc(k),
+               *dg = mp->method == APOP_SGD_LBFGS ? gsl_vector_alloc(k) : NULL;
+
+    //Adam's first and second moments, or L-BFGS's history of steps and gradient changes.
+    int m = 10, ct = 0, newest = -1;
+    gsl_matrix *mom = gsl_matrix_calloc(2, k),
+               *s = mp->method == APOP_SGD_LBFGS ? gsl_matrix_alloc(m, k) : NULL,
+               *y = mp->method == APOP_SGD_LBFGS ? gsl_matrix_alloc(m, k) : NULL;
+    double rho[m];
+    Apop_matrix_row(mom, 0, m1);
+    Apop_matrix_row(mom, 1, m2);
+    double b1 = 0.9, b2 = 0.999, eps = 1e-8;
+
+    mle_sigint_catch();
+    for (int t=1; t<= mp->max_iterations && !ctrl_c; t++){
+        gather_rows(batch, data, r);
+        batch_gradient(&bi, beta, g);
+        if (mp->method == APOP_SGD){
+            for (size_t j=0; j< k; j++){
+                double gj = gsl_vector_get(g, j);
+                gsl_vector_set(m1, j, b1*gsl_vector_get(m1, j) + (1-b1)*gj);
+                gsl_vector_set(m2, j, b2*gsl_vector_get(m2, j) + (1-b2)*gj*gj);
+                double mhat = gsl_vector_get(m1, j)/(1-pow(b1, t)),
+                       vhat = gsl_vector_get(m2, j)/(1-pow(b2, t));
+                apop_vector_increment(beta, j, mp->step_size * mhat/(sqrt(vhat) + eps));
+            }
+        } else {
+            lbfgs_direction(s, y, rho, ct, newest, g, d);
+            if (!ct) gsl_vector_scale(d, mp->step_size);
+            gsl_vector_add(beta, d);
+            gsl_vector_memcpy(dg, g);
+            batch_gradient(&bi, beta, g);  //same batch, new point.
+            gsl_vector_sub(dg, g);         //we ascend, so y is the change in the negative gradient.
+            double sy;
+            gsl_blas_ddot(d, dg, &sy);
+            //Only a pair that passes the curvature test goes into the history; when the history
+            //is full, the slot it takes holds the oldest pair still in use.
+            if (sy > 1e-10 * gsl_blas_dnrm2(d) * gsl_blas_dnrm2(dg)){
+                int next = (newest + 1) % m;
+                Apop_matrix_row(s, next, sn);
+                Apop_matrix_row(y, next, yn);
+                gsl_vector_memcpy(sn, d);
+                gsl_vector_memcpy(yn, dg);
+                rho[next] = 1/sy;
+                newest = next;
+                ct = GSL_MIN(ct+1, m);
+            }
+        }
+        if (mp->verbose)
+            printf ("%5i %.5f  gradient=%.3f\n", t, gsl_vector_get(beta, 0), gsl_vector_get(g, 0));
+    }
+    mle_sigint_release();
+
+    batch->more = NULL;
+    apop_data_free(batch);
+    gsl_vector_free(g); gsl_vector_free(d);
+    gsl_matrix_free(mom);
+    if (s) {gsl_matrix_free(s); gsl_matrix_free(y); gsl_vector_free(dg);}
+    if (!mp->rng) gsl_rng_free(r);
+    if (ctrl_c){ //stop here, as promised; the mini-batch steps alone aren't an optimum.
+        apop_param_unpack(beta, i->model);
+        gsl_vector_free(i->beta);
+        auxinfo(i->model->parameters, i, -1, 0);
+        return i->model;
+    }
+    //Polish on the full data, starting from here.
+    return apop_maximum_likelihood_w_d(data, i);
+}
+
 /*There is a basically standard location for the log likelihood. Search there, and if you don't
 find it, then recalculate it.*/
 static double get_ll(apop_data *d, apop_model *est){
@@ -591,7 +1020,7 @@ static apop_model * dim_cycle(apop_data *d, apop_model *est, infostruct info){
         Apop_settings_set(est, apop_mle, dim_cycle_tolerance, 0);//so sub-estimations won't use this function.
         for (int i=0; i< betasize; i++){
             gsl_vector_set(info.beta, i, GSL_NAN);
-            apop_data_unpack(info.beta, est->parameters);
+            apop_param_unpack(info.beta, est);
             apop_model *m_onedim = apop_model_fix_params(est);
             apop_prep(d, m_onedim);
             apop_maximum_likelihood(d, m_onedim);
@@ -621,6 +1050,156 @@ void get_desires(apop_model *m, infostruct *info){
     info->want_predicted = (want && want->predicted =='y') ? 'y' : 'n';
 }
 
+//Multi-start search
+
+/* Latin hypercube sample: each dimension is cut into n equal slices, and every slice
+ of every dimension gets exactly one point. Points are then nudged into the model's
+ constraint, if any. */
+static gsl_matrix *multistart_draw(apop_data *d, apop_model *m, apop_mle_settings *mp, size_t k){
+    size_t n = mp->starts;
+    gsl_matrix *out = gsl_matrix_alloc(n, k);
+    gsl_rng *r = mp->rng ? mp->rng : apop_rng_alloc(apop_opts.rng_seed++);
+    size_t perm[n];
+    for (size_t j=0; j< k; j++){
+        double center = mp->starting_pt ? mp->starting_pt[j] : 1;
+        for (size_t i=0; i< n; i++) perm[i] = i;
+        gsl_ran_shuffle(r, perm, n, sizeof(size_t));
+        for (size_t i=0; i< n; i++)
+            gsl_matrix_set(out, i, j, center + mp->start_range * (2*(perm[i] + gsl_rng_uniform(r))/n - 1));
+    }
+    if (!mp->rng) gsl_rng_free(r);
+    if (m->constraint){
+        apop_model *scratch = apop_model_copy(*m);
+        for (size_t i=0; i< n; i++){
+            Apop_matrix_row(out, i, pt);
+            apop_param_unpack(pt, scratch);
+            scratch->constraint(d, scratch);
+            apop_param_pack(scratch, pt);
+        }
+        apop_model_free(scratch);
+    }
+    return out;
+}
+
+typedef struct {
+    apop_data   *data;
+    apop_model  *base, **out;
+    gsl_matrix  *pts;
+    gsl_rng     **rngs;
+    size_t      first, stride;
+    char        threaded;
+} multistart_thread;
+
+static void *multistart_loop(void *in){
+    multistart_thread *t = in;
+    if (t->threaded) in_deriv_thread = 1;
+    in_multistart = 1;
+    for (size_t i=t->first; i< t->pts->size1 && !ctrl_c; i+= t->stride){
+        apop_model *m = apop_model_copy(*t->base);
+        apop_mle_settings *mp = Apop_settings_get_group(m, apop_mle);
+        double *base_start = mp->starting_pt;
+        gsl_rng *base_rng = mp->rng;
+        mp->starts = 1;
+        mp->start_pts = NULL;
+        mp->starting_pt = gsl_matrix_ptr(t->pts, i, 0);
+        mp->rng = t->rngs[i];
+        t->out[i] = apop_maximum_likelihood(t->data, m);
+        if (!t->out[i]) apop_model_free(m);
+        else { //don't leave pointers into pts or to this start's RNG.
+            mp->starting_pt = base_start;
+            mp->rng = base_rng;
+        }
+    }
+    in_multistart = 0; //this may be the caller's own thread.
+    return NULL;
+}
+
+/* Run one search per starting point, threaded across starts, and keep the one with the
+ highest log likelihood. Every optimum found goes to the <Local optima> page of the info set. */
+static apop_model *multistart(apop_data *data, apop_model *dist, apop_mle_settings *mp){
+    gsl_vector *beta = apop_data_pack(dist->parameters, NULL, .all_pages='y');
+    size_t k = beta->size;
+    gsl_vector_free(beta);
+    gsl_matrix *pts;
+    if (mp->start_pts){
+        Apop_stopif(!mp->start_pts->matrix || mp->start_pts->matrix->size2 != k, return NULL, 0,
+                "The start_pts matrix needs one column for each of the %zu parameters.", k);
+        pts = apop_matrix_copy(mp->start_pts->matrix);
+    } else pts = multistart_draw(data, dist, mp, k);
+    size_t n = pts->size1;
+    apop_model *out[n];
+    memset(out, 0, sizeof(apop_model*)*n);
+    //The settings group's RNG pointer is shared by every copy of the model, so each start
+    //gets its own RNG, seeded here, in order. Annealing keeps its RNG in a static and uses a
+    //global jump buffer for ctrl-C, so it keeps the shared RNG and runs serially.
+    //Ctrl-C stops the search in progress, and no new searches start.
+    char own_rngs = mp->method != APOP_SIMAN;
+    gsl_rng **rngs = malloc(sizeof(gsl_rng*)*n);
+    for (size_t i=0; i< n; i++)
+        rngs[i] = !own_rngs ? mp->rng
+                            : apop_rng_alloc(mp->rng ? gsl_rng_get(mp->rng) : apop_opts.rng_seed++);
+    int threadct = (in_deriv_thread || mp->method == APOP_SIMAN)
+                        ? 1 : GSL_MAX(1, GSL_MIN(n, apop_opts.thread_count));
+    multistart_thread t[threadct];
+    pthread_t thread_id[threadct];
+    for (int i=0; i< threadct; i++)
+        t[i] = (multistart_thread){.data=data, .base=dist, .out=out, .pts=pts, .rngs=rngs,
+                                   .first=i, .stride=threadct, .threaded=threadct > 1};
+    ctrl_c = 0;
+    signal(SIGINT, mle_sigint); //one handler for all the searches; see mle_sigint_catch.
+    if (threadct==1) multistart_loop(t);
+    else {
+        for (int i=0; i< threadct; i++)
+            pthread_create(&thread_id[i], NULL, multistart_loop, t+i);
+        for (int i=0; i< threadct; i++)
+            pthread_join(thread_id[i], NULL);
+    }
+    signal(SIGINT, NULL);
+    if (own_rngs) for (size_t i=0; i< n; i++) gsl_rng_free(rngs[i]);
+    free(rngs);
+
+    apop_data *optima = apop_data_alloc(0, n, k+2);
+    apop_name_add(optima->names, "log likelihood", 'c');
+    apop_name_add(optima->names, "status", 'c');
+    char *name;
+    for (size_t j=0; j< k; j++){
+        asprintf(&name, "parameter %zu", j);
+        apop_name_add(optima->names, name, 'c');
+        free(name);
+    }
+    int best = -1;
+    double best_ll = GSL_NEGINF;
+    for (size_t i=0; i< n; i++){
+        asprintf(&name, "start %zu", i);
+        apop_name_add(optima->names, name, 'r');
+        free(name);
+        Apop_matrix_row(optima->matrix, i, row);
+        gsl_vector_set_all(row, GSL_NAN);
+        if (!out[i]) continue;
+        double ll = get_ll(data, out[i]);
+        int status_row = apop_name_find(out[i]->info->names, "status", 'r');
+        gsl_vector_set(row, 0, ll);
+        if (status_row > -2) gsl_vector_set(row, 1, apop_data_get(out[i]->info, status_row));
+        gsl_vector params = gsl_vector_subvector(row, 2, k).vector;
+        apop_param_pack(out[i], &params);
+        if (gsl_finite(ll) && ll > best_ll) {best_ll = ll; best = i;}
+    }
+    gsl_matrix_free(pts);
+    Apop_stopif(best < 0, dist->error='m', 0, "None of the %zu searches produced a finite log likelihood.", n);
+    if (best >= 0){
+        apop_data_free(dist->parameters);
+        apop_data_free(dist->info);
+        dist->parameters = out[best]->parameters;
+        dist->info = out[best]->info;
+        out[best]->parameters = out[best]->info = NULL;
+    }
+    if (!dist->info) dist->info = apop_data_alloc();
+    apop_data_add_page(dist->info, optima, "<Local optima>");
+    dist->data = data;
+    for (size_t i=0; i< n; i++) apop_model_free(out[i]);
+    return dist;
+}
+
 /** The maximum likelihood calculations. All of the settings are specified by adding a
   \ref apop_mle_settings struct to your model, so see the many notes there. Notably,
   the default method is the Fletcher-Reeves conjugate gradient method, and if your model
@@ -649,32 +1228,58 @@ else
 \endcode
 
 \li During the search for an optimum, ctrl-C (SIGINT) will halt the search, and the function will return whatever parameters the search was on at the time.
+
+\li If the \c starts element of the \ref apop_mle_settings group is greater than one, or you
+provide a set of \c start_pts, then I run one search from each starting point, across up to
+\ref apop_opts_type "apop_opts.thread_count" threads, and return the one with the highest
+log likelihood. Each search works on its own copy of the model, so your log likelihood
+must be safe to call on two copies at once. Each search gets its own RNG, seeded in order
+from the \c rng in your settings group (or from \ref apop_opts_type "apop_opts.rng_seed"), so
+no RNG is shared across threads. Simulated annealing searches run one at a time, on the one RNG.
+Every optimum found is listed in the <tt>\<Local optima\></tt> page of the info set, one
+row per starting point, with columns for the log likelihood, the search's status, and the
+parameters in \ref apop_data_pack order:
+\code
+Apop_model_add_group(your_model, apop_mle, .starts=20);
+apop_model *est = apop_estimate(your_data, your_model);
+apop_data_show(apop_data_get_page(est->info, "<Local optima>"));
+\endcode
+If you have a \c trace_path, each search's trace is written in batches, interleaved with the others'.
+
+\exception est->error=='m' None of the searches from the several starting points produced a finite log likelihood.
  \ingroup mle */
 apop_model *apop_maximum_likelihood(apop_data * data, apop_model *dist){
     apop_mle_settings   *mp = apop_settings_get_group(dist, apop_mle);
     if (!mp) mp = Apop_model_add_group(dist, apop_mle);
     if (mp->method == APOP_UNKNOWN_ML)
-        mp->method = (dist->score) ? APOP_CG_FR : APOP_SIMPLEX_NM;
+        mp->method = (dist->score || dist->log_likelihood_score || dist->log_likelihood_dual)
+                            ? APOP_CG_FR : APOP_SIMPLEX_NM;
 
     Apop_assert(dist->parameters, "Not enough information to allocate parameters over which to optimize. If this was not called from apop_estimate, did you call apop_prep first?")
+    if (mp->starts > 1 || mp->start_pts) return multistart(data, dist, mp);
     infostruct info = {.data           = data,
                        .use_constraint = 1,
-                       .trace_file     = malloc(sizeof(FILE *)),
                        .model          = dist};
     get_desires(dist, &info);
     info.beta = apop_data_pack(dist->parameters, NULL, .all_pages='y');
     if (setup_starting_point(mp, info.beta)) return NULL;
-    *info.trace_file = NULL;
     info.model->data = data;
     if (mp->dim_cycle_tolerance)          return dim_cycle(data, dist, info);
-    if (mp->trace_path)                   info.trace_path = mp->trace_path;
-	if (mp->method == APOP_SIMAN)         return apop_annealing(&info);  //below.
-    else if (mp->method==APOP_SIMPLEX_NM) return apop_maximum_likelihood_no_d(data, &info);
+    trace_buffer trace = {.path = mp->trace_path};
+    if (mp->trace_path && strlen(mp->trace_path)) info.trace = &trace;
+    apop_model *out;
+	if (mp->method == APOP_SIMAN)         out = apop_annealing(&info);  //below.
+    else if (mp->method==APOP_TEMPERING)  out = apop_tempering(&info);
+    else if (mp->method == APOP_SGD ||
+            mp->method == APOP_SGD_LBFGS) out = apop_minibatch(data, &info);
+    else if (mp->method==APOP_SIMPLEX_NM) out = apop_maximum_likelihood_no_d(data, &info);
     else if (mp->method == APOP_RF_NEWTON ||
             mp->method == APOP_RF_HYBRID_NOSCALE ||
-            mp->method == APOP_RF_HYBRID) return  find_roots (info);
-	//else, Conjugate Gradient:
-	return apop_maximum_likelihood_w_d(data, &info);
+            mp->method == APOP_RF_HYBRID) out = find_roots (info);
+	else //Conjugate Gradient:
+	    out = apop_maximum_likelihood_w_d(data, &info);
+    trace_done(info.trace);
+    return out;
 }
 
 /** 
@@ -785,38 +1390,41 @@ static double annealing_energy(void *in) {
 
 static double annealing_distance(void *xin, void *yin) {
 /** We use the Manhattan metric to correspond to the annealing_step fn below.  */
-    gsl_vector *from = apop_vector_copy(((infostruct*)xin)->beta);
-    gsl_vector *to = apop_vector_copy(((infostruct*)yin)->beta);
-    gsl_vector_div(from, ((infostruct*)xin)->starting_pt);
-    gsl_vector_div(to, ((infostruct*)xin)->starting_pt);//starting pts are the same.
-    return apop_vector_distance(from, to, .metric='m');
+    gsl_vector *from  = ((infostruct*)xin)->beta,
+               *to    = ((infostruct*)yin)->beta,
+               *scale = ((infostruct*)xin)->starting_pt;//starting pts are the same.
+    double out = 0;
+    for (size_t j=0; j< from->size; j++)
+        out += fabs((gsl_vector_get(from, j) - gsl_vector_get(to, j))/gsl_vector_get(scale, j));
+    return out;
 }
 
-static void annealing_step(const gsl_rng * r, void *in, double step_size){
-/** The algorithm: 
+/* The algorithm: 
     --randomly pick dimension
     --shift by some amount of remaining step size
     --repeat for all dims
-This will give a move \f$\leq\f$ step_size on the Manhattan metric.
-*/
-    infostruct *i = in;
-    int sign;
-    double amt, scale;
-    double cutpoints[i->beta->size+1];
-    cutpoints[0]             = 0;
-    cutpoints[i->beta->size] = 1;
-    for (size_t j=1; j< i->beta->size; j++)
+This will give a move \f$\leq\f$ step_size on the Manhattan metric, where each dimension
+is measured in units of \c scale. */
+static void manhattan_step(const gsl_rng *r, gsl_vector *beta, gsl_vector const *scale, double step_size){
+    double cutpoints[beta->size+1];
+    cutpoints[0]          = 0;
+    cutpoints[beta->size] = 1;
+    for (size_t j=1; j< beta->size; j++)
         cutpoints[j] = gsl_rng_uniform(r);
 
-    for (size_t j=0; j< i->beta->size; j++){
-        sign  = (gsl_rng_uniform(r) > 0.5) ? 1 : -1;
-        scale = gsl_vector_get(i->starting_pt, j);
-        amt   = cutpoints[j+1]- cutpoints[j];
-        apop_vector_increment(i->beta, j,  amt * sign * scale * step_size); 
+    for (size_t j=0; j< beta->size; j++){
+        int sign   = (gsl_rng_uniform(r) > 0.5) ? 1 : -1;
+        double amt = cutpoints[j+1]- cutpoints[j];
+        apop_vector_increment(beta, j,  amt * sign * gsl_vector_get(scale, j) * step_size); 
     }
-    apop_data_unpack(i->beta, i->model->parameters);
+}
+
+static void annealing_step(const gsl_rng * r, void *in, double step_size){
+    infostruct *i = in;
+    manhattan_step(r, i->beta, i->starting_pt, step_size);
+    apop_param_unpack(i->beta, i->model);
     if (i->model->constraint && i->model->constraint(i->data, i->model))
-        apop_data_pack(i->model->parameters, i->beta, .all_pages='y');
+        apop_param_pack(i->model, i->beta);
 }
 
 static void annealing_print(void *xp) {
@@ -847,7 +1455,7 @@ static void annealing_free(void *xp){
 static double set_start(double in){ return in ? in : 1; }
 
 jmp_buf anneal_jump;
-static void anneal_sigint(){ longjmp(anneal_jump,1); }
+static void anneal_sigint(int sig){ ctrl_c = 1; longjmp(anneal_jump,1); }
 
 static apop_model * apop_annealing(infostruct *i){
     apop_model *ep = i->model;
@@ -891,8 +1499,8 @@ static apop_model * apop_annealing(infostruct *i){
           betasize,           // size_t element_size
           simparams);         // gsl_siman_params_t params
     }
-    signal(SIGINT, NULL);
-    apop_data_unpack(i->beta, i->model->parameters); 
+    signal(SIGINT, in_multistart ? mle_sigint : NULL); //multistart is still watching for ctrl-C
+    apop_param_unpack(i->beta, i->model); 
     apop_estimate_parameter_tests(i->model);
     apopstatus = 0;
 done:
@@ -901,6 +1509,163 @@ done:
     return i->model;
 }
 
+// Parallel tempering.
+
+/** \page tempering Notes on parallel tempering
+
+Parallel tempering (a.k.a. replica exchange) runs several of the random walks described
+in \ref simanneal at once, each at a fixed temperature. The coldest walk, at temperature
+one, accepts a worse point with probability \f$L_{new}/L_{old}\f$; hotter walks flatten the
+likelihood and so roam more freely. Every \c iters_fixed_T steps, neighboring walks
+propose to swap positions, so a good point found by a hot walk can work its way down
+to the cold walk, and the cold walk is never stuck in one local optimum for long.
+
+Set <tt>.method=APOP_TEMPERING</tt> in the \ref apop_mle_settings group. The relevant
+settings are:
+
+\li \c replicas: the number of walks (default: 4), whose temperatures are spaced
+geometrically from 1 to \c t_initial.
+\li \c max_iterations: the number of steps each walk takes.
+\li \c iters_fixed_T: the number of steps between swap proposals.
+\li \c step_size: the largest move on the Manhattan metric, as with annealing. A walk at
+temperature \f$T\f$ uses \f$\sqrt{T}\f$ times this.
+\li \c rng: if not \c NULL, each walk's RNG is seeded from this one.
+
+The walks are split across \ref apop_opts_type "apop_opts.thread_count" threads, each with
+its own copy of the model, so your log likelihood must be safe to call on two copies
+at once. The steps allocate nothing beyond what the model's log likelihood does. The
+search returns the best point seen by any walk. Ctrl-C halts the search at the next
+swap, returning the best point so far.
+
+If \c verbose is set, I print each walk's temperature, acceptance rate, and best log
+likelihood at the end of the search.
+
+\ingroup mle
+*/
+
+typedef struct {
+    apop_model  *model;     //a private copy, or the original if running serially
+    gsl_vector  *beta, *proposal, *best;
+    gsl_rng     *rng;
+    double      temp, step, ll, best_ll;
+    size_t      accepted, tried;
+} tempering_replica;
+
+typedef struct {
+    infostruct          *info;
+    tempering_replica   *reps;
+    int                 first, stride, n, steps;
+    char                threaded;
+} tempering_thread;
+
+
+//The log likelihood at beta, which is moved into the constraint if need be. NaNs are -inf.
+static double tempering_ll(infostruct *i, tempering_replica *rep, gsl_vector *beta){
+    apop_model *m = rep->model;
+    apop_param_unpack(beta, m);
+    if (m->constraint && m->constraint(i->data, m))
+        apop_param_pack(m, beta);
+    double ll = m->log_likelihood ? m->log_likelihood(i->data, m) : log(m->p(i->data, m));
+    return gsl_isnan(ll) ? GSL_NEGINF : ll;
+}
+
+static void *tempering_loop(void *in){
+    tempering_thread *t = in;
+    if (t->threaded) in_deriv_thread = 1;
+    for (int j=t->first; j< t->n; j+= t->stride){
+        tempering_replica *rep = t->reps + j;
+        for (int s=0; s< t->steps; s++){
+            gsl_vector_memcpy(rep->proposal, rep->beta);
+            manhattan_step(rep->rng, rep->proposal, t->info->starting_pt, rep->step);
+            double ll = tempering_ll(t->info, rep, rep->proposal);
+            rep->tried++;
+            if (ll >= rep->ll || log(gsl_rng_uniform(rep->rng)) < (ll - rep->ll)/rep->temp){
+                gsl_vector *swap = rep->beta;
+                rep->beta = rep->proposal;
+                rep->proposal = swap;
+                rep->ll = ll;
+                rep->accepted++;
+                if (ll > rep->best_ll){
+                    rep->best_ll = ll;
+                    gsl_vector_memcpy(rep->best, rep->beta);
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+static apop_model * apop_tempering(infostruct *i){
+    apop_model *ep = i->model;
+    apop_mle_settings *mp = Apop_settings_get_group(ep, apop_mle);
+    int n = GSL_MAX(mp->replicas, 1);
+    int steps = GSL_MAX(mp->iters_fixed_T, 1);
+    int threadct = in_deriv_thread ? 1 : GSL_MAX(1, GSL_MIN(n, apop_opts.thread_count));
+    i->starting_pt = apop_vector_map(i->beta, set_start);
+    tempering_replica reps[n];
+    for (int j=0; j< n; j++){
+        double temp = (n == 1) ? 1 : pow(mp->t_initial, j/(n-1.));
+        reps[j] = (tempering_replica){.model = (threadct==1) ? ep : apop_model_copy(*ep),
+                        .beta = apop_vector_copy(i->beta), .best = apop_vector_copy(i->beta),
+                        .proposal = gsl_vector_alloc(i->beta->size),
+                        .rng = apop_rng_alloc(mp->rng ? gsl_rng_get(mp->rng) : apop_opts.rng_seed++),
+                        .temp = temp, .step = mp->step_size * sqrt(temp)};
+        reps[j].ll = reps[j].best_ll = tempering_ll(i, reps+j, reps[j].beta);
+        gsl_vector_memcpy(reps[j].best, reps[j].beta);
+    }
+    tempering_thread t[threadct];
+    pthread_t thread_id[threadct];
+    for (int k=0; k< threadct; k++)
+        t[k] = (tempering_thread){.info=i, .reps=reps, .first=k, .stride=threadct,
+                                  .n=n, .steps=steps, .threaded=threadct > 1};
+    mle_sigint_catch();
+    for (int round=0; round*steps < mp->max_iterations && !ctrl_c; round++){
+        if (threadct==1) tempering_loop(t);
+        else {
+            for (int k=0; k< threadct; k++)
+                pthread_create(&thread_id[k], NULL, tempering_loop, t+k);
+            for (int k=0; k< threadct; k++)
+                pthread_join(thread_id[k], NULL);
+        }
+        //Propose swaps between neighbors, alternating the even and odd pairs.
+        for (int j=round%2; j+1< n; j+= 2){
+            double a = (reps[j+1].ll - reps[j].ll) * (1/reps[j].temp - 1/reps[j+1].temp);
+            if (a >= 0 || log(gsl_rng_uniform(reps[0].rng)) < a){
+                gsl_vector *swap = reps[j].beta;
+                reps[j].beta = reps[j+1].beta;
+                reps[j+1].beta = swap;
+                double swap_ll = reps[j].ll;
+                reps[j].ll = reps[j+1].ll;
+                reps[j+1].ll = swap_ll;
+            }
+        }
+    }
+    mle_sigint_release();
+
+    int best = 0;
+    for (int j=0; j< n; j++){
+        if (reps[j].best_ll > reps[best].best_ll) best = j;
+        if (mp->verbose){
+            if (!j) printf("temperature\tacceptance\tbest log likelihood\n");
+            printf("%g\t%g\t%g\n", reps[j].temp, reps[j].accepted/(reps[j].tried+0.0), reps[j].best_ll);
+        }
+    }
+    apop_param_unpack(reps[best].best, ep);
+    i->best_ll = reps[best].best_ll;
+    int apopstatus = gsl_finite(i->best_ll) ? 0 : -1;
+    for (int j=0; j< n; j++){
+        if (threadct > 1) apop_model_free(reps[j].model);
+        gsl_vector_free(reps[j].beta);
+        gsl_vector_free(reps[j].proposal);
+        gsl_vector_free(reps[j].best);
+        gsl_rng_free(reps[j].rng);
+    }
+    gsl_vector_free(i->starting_pt);
+    gsl_vector_free(i->beta);
+    auxinfo(ep->parameters, i, apopstatus, i->best_ll);
+    return ep;
+}
+
 /* This function calls the various GSL root-finding algorithms to find the zero of the score.
    Cut/pasted/modified from the GSL documentation.  */
 static apop_model * find_roots (infostruct p) {
@@ -929,7 +1694,7 @@ static apop_model * find_roots (infostruct p) {
     } while (status == GSL_CONTINUE && iter < mlep->max_iterations);
     if (GSL_SUCCESS) apopstatus = 0;
     Apop_notify(2, "status = %s\n", gsl_strerror(status));
-    apop_data_unpack(s->x, dist->parameters);
+    apop_param_unpack(s->x, dist);
     gsl_multiroot_fsolver_free (s);
     gsl_vector_free (p.beta);
     auxinfo(dist->parameters, &p, apopstatus, 0); //root-finders don't store best val.
@@ -23,6 +23,7 @@ The above two points mean that you probably don't need to call this function dir
 apop_model * apop_model_clear(apop_data * data, apop_model *model){
     Get_vmsizes(data)
     int width = msize2 ? msize2 : -firstcol;//use the vector only if there's no matrix.
+    if (data && data->sparse) width = msize2 + data->sparse->size2;
     Apop_stopif(model->dsize==-1 && !width, model->error='d', 0, "The model's dsize==-1, meaning size=data width, but the input data has NULL vector and matrix.");
     Apop_stopif(model->vbase==-1 && !width, model->error='d', 0, "The model's vbase==-1, meaning size=data width, but the input data has NULL vector and matrix.");
     Apop_stopif(model->m1base==-1 && !width, model->error='d', 0, "The model's m1base==-1, meaning size=data width, but the input data has NULL vector and matrix.");
@@ -71,6 +72,7 @@ void apop_model_free (apop_model * free_me){
         free(free_me->more);
     if (free_me->info)
         apop_data_free(free_me->info);
+    apop_pack_plan_free(free_me->pack_plan);
 	free(free_me);
 }
 
@@ -159,6 +161,8 @@ apop_model * apop_model_copy(apop_model in){
     }
     int i=0; 
     out->settings = NULL;
+    memset(out->settings_cache, 0, sizeof(out->settings_cache)); //those pointed into in.settings.
+    out->pack_plan = NULL; //that described in.parameters.
     if (in.settings)
         do 
             apop_settings_copy_group(out, &in, in.settings[i].name);
@@ -274,6 +278,10 @@ void apop_score(apop_data *d, gsl_vector *out, apop_model *m){
         m->score(d, out, m);
         return;
     }
+    if (m->log_likelihood_score){
+        m->log_likelihood_score(d, out, m);
+        return;
+    }
     gsl_vector * numeric_default = apop_numerical_gradient(d, m);
     gsl_vector_memcpy(out, numeric_default);
     gsl_vector_free(numeric_default);
@@ -10,12 +10,23 @@
 \ingroup names
 */
 apop_name * apop_name_alloc(void){
-    apop_name * init_me = malloc(sizeof(apop_name));
+    apop_name * init_me = apop_arena_malloc(NULL, sizeof(apop_name));
     Apop_stopif(!init_me, return NULL, 0, "malloc failed. Probably out of memory.");
     *init_me = (apop_name){ };
 	return init_me;
 }
 
+/* Extend a list of names by one slot. On the heap, that's a realloc. In the arena, which can't
+   realloc, reserve room in powers of two so a long run of adds doesn't copy the list every time. */
+static char **grow_list(apop_name const *n, char **list, int newct){
+    if (!apop_arena_owns(n)) return realloc(list, sizeof(char*) * newct);
+    int oldct = newct-1;
+    if (oldct && (oldct & (oldct-1))) return list; //not at a power of two, so there's still room.
+    char **out = apop_arena_malloc(n, sizeof(char*) * (oldct ? 2*oldct : 1));
+    if (oldct) memcpy(out, list, sizeof(char*) * oldct);
+    return out;
+}
+
 /** Adds a name to the \ref apop_name structure. Puts it at the end of the given list.
 
 \param n 	An existing, allocated \ref apop_name structure.
@@ -36,22 +47,20 @@ int apop_name_add(apop_name * n, char const *add_me, char type){
         return 1;
 	} 
 	if (type == 'v'){
-		n->vector	= realloc(n->vector,  strlen(add_me) + 1);
-		strcpy(n->vector, add_me);
+		apop_arena_free(n->vector);
+		n->vector	= apop_arena_strdup(n, add_me);
 		return 1;
 	} 
 	if (type == 'r'){
 		n->rowct++;
-		n->row	= realloc(n->row, sizeof(char*) * n->rowct);
-		n->row[n->rowct -1]	= malloc(strlen(add_me) + 1);
-		strcpy(n->row[n->rowct -1], add_me);
+		n->row	= grow_list(n, n->row, n->rowct);
+		n->row[n->rowct -1]	= apop_arena_strdup(n, add_me);
 		return n->rowct;
 	} 
 	if (type == 't'){
 		n->textct++;
-		n->text	= realloc(n->text, sizeof(char*) * n->textct);
-		n->text[n->textct -1]	= malloc(strlen(add_me) + 1);
-		strcpy(n->text[n->textct -1], add_me);
+		n->text	= grow_list(n, n->text, n->textct);
+		n->text[n->textct -1]	= apop_arena_strdup(n, add_me);
 		return n->textct;
 	}
 	//else assume (type == 'c')
@@ -59,9 +68,8 @@ int apop_name_add(apop_name * n, char const *add_me, char type){
             2,"You gave me >%c<, I'm assuming you meant c; "
                              " copying column names.", type);
 		n->colct++;
-		n->column	= realloc(n->column, sizeof(char*) * n->colct);
-		n->column[n->colct -1]	= malloc(strlen(add_me) + 1);
-		strcpy(n->column[n->colct -1], add_me);
+		n->column	= grow_list(n, n->column, n->colct);
+		n->column[n->colct -1]	= apop_arena_strdup(n, add_me);
 		return n->colct;
 }
 
@@ -103,6 +111,7 @@ void apop_name_print(apop_name * n){
 \ingroup names 	*/
 void  apop_name_free(apop_name * free_me){
     if (!free_me) return; //only needed if users are doing tricky things like newdata = (apop_data){.matrix=...};
+    if (apop_arena_owns(free_me)) return; //everything inside went to the arena as well.
 	for (size_t i=0; i < free_me->colct; i++)  free(free_me->column[i]);
 	for (size_t i=0; i < free_me->textct; i++) free(free_me->text[i]);
 	for (size_t i=0; i < free_me->rowct; i++)  free(free_me->row[i]);
@@ -9,7 +9,6 @@
  */
 
 #include "apop_internal.h"
-#include <search.h> //lsearch; bsearch is in stdlib.
 
 /** For many, it is a knee-jerk reaction to a parameter estimation to test whether each individual parameter differs from zero. This function does that.
 
@@ -67,28 +66,84 @@ static int strcmpwrap(const void *a, const void *b){
   This is basically running "select distinct datacol from data order by datacol", but without the aid of the database.
 
   \param v a vector of items
-  \return a sorted vector of the distinct elements that appear in the input.
+  \return a sorted vector of the distinct elements that appear in the input, or \c NULL if the input is \c NULL or empty.
   \li NaNs appear at the end of the sort order.
   \see apop_text_unique_elements 
 */
 gsl_vector * apop_vector_unique_elements(const gsl_vector *v){
-    size_t prior_elmt_ctr = 107;
+    if (!v || !v->size) return NULL;
+    //Sort a copy, then keep the first of each run of equal elements.
+    double *elmts = malloc(sizeof(double)*v->size);
+    for (size_t i=0; i< v->size; i++)
+        elmts[i] = gsl_vector_get(v, i);
+    qsort(elmts, v->size, sizeof(double), compare_doubles);
     size_t elmt_ctr = 0;
-    double *elmts = NULL;
-    for (size_t i=0; i< v->size; i++){
-        if (prior_elmt_ctr != elmt_ctr)
-            elmts = realloc(elmts, sizeof(double)*(elmt_ctr+1));
-        prior_elmt_ctr = elmt_ctr;
-        double val = gsl_vector_get(v, i);
-        lsearch(&val, elmts, &elmt_ctr, sizeof(double), compare_doubles);
-        if (prior_elmt_ctr < elmt_ctr)
-            qsort(elmts, elmt_ctr, sizeof(double), compare_doubles);
-    }
+    for (size_t i=0; i< v->size; i++)
+        if (!elmt_ctr || compare_doubles(elmts+i, elmts+elmt_ctr-1))
+            elmts[elmt_ctr++] = elmts[i];
     gsl_vector *out = apop_array_to_vector(elmts, elmt_ctr);
     free(elmts);
     return out;
 }
 
+/* Dictionary-encode a text column in one hashing pass. Each distinct string gets a code;
+   on return, the codes index the sorted list of distinct strings, *uniques, which
+   points into the original data (so don't free the strings themselves).
+
+   If codes is not NULL, it has one slot per row, and I fill it with each row's code.
+   Returns the number of distinct strings. */
+static size_t text_encode(const apop_data *d, size_t col, size_t *codes, char ***uniques){
+    size_t rows = d->textsize[0], ct = 0, table_size = 64;
+    size_t *table = malloc(sizeof(size_t)*table_size); //indices into *uniques, plus one; 0 = empty.
+    memset(table, 0, sizeof(size_t)*table_size);
+    size_t space = 16;
+    char **elmts = malloc(sizeof(char*)*space);
+
+    for (size_t i=0; i< rows; i++){
+        char *val = d->text[i][col];
+        size_t slot = apop_string_hash(val) & (table_size-1);
+        for ( ; table[slot]; slot = (slot+1) & (table_size-1)){
+            char *seen = elmts[table[slot]-1];
+            if (seen == val || !strcmp(seen, val)) break; //pooled text is interned, so the pointers match
+        }
+        if (!table[slot]){
+            if (ct == space) elmts = realloc(elmts, sizeof(char*)*(space*=2));
+            elmts[ct++] = val;
+            table[slot] = ct;
+            if (2*ct > table_size){ //rehash
+                free(table);
+                table_size *= 2;
+                table = malloc(sizeof(size_t)*table_size);
+                memset(table, 0, sizeof(size_t)*table_size);
+                for (size_t j=0; j< ct; j++){
+                    size_t s = apop_string_hash(elmts[j]) & (table_size-1);
+                    while (table[s]) s = (s+1) & (table_size-1);
+                    table[s] = j+1;
+                }
+            }
+            if (codes) codes[i] = ct-1;
+        } else if (codes) codes[i] = table[slot]-1;
+    }
+    free(table);
+
+    //Sort the dictionary, then translate the first-seen codes to sorted positions.
+    size_t *order = malloc(sizeof(size_t)*(ct ? ct : 1));
+    char **sorted = malloc(sizeof(char*)*(ct ? ct : 1));
+    for (size_t j=0; j< ct; j++) sorted[j] = elmts[j];
+    qsort(sorted, ct, sizeof(char*), strcmpwrap);
+    if (codes){
+        for (size_t j=0; j< ct; j++){
+            char **posn = bsearch(elmts+j, sorted, ct, sizeof(char*), strcmpwrap);
+            order[j] = posn - sorted;
+        }
+        for (size_t i=0; i< rows; i++) codes[i] = order[codes[i]];
+    }
+    free(order);
+    free(elmts);
+    *uniques = sorted;
+    return ct;
+}
+
 /** Give me a column of text, and I'll give you a sorted list of the unique
   elements. 
   This is basically running "select distinct * from datacolumn", but without 
@@ -97,30 +152,17 @@ gsl_vector * apop_vector_unique_elements(const gsl_vector *v){
   \param d An \ref apop_data set with a text component
   \param col The text column you want me to use.
   \return An \ref apop_data set with a single sorted column of text, where each unique text input appears once.
+  \li Distinct elements are found via a hash table in one pass over the column, so the cost is linear in the number of rows, plus a sort of the distinct elements.
   \see apop_vector_unique_elements
 */
 apop_data * apop_text_unique_elements(const apop_data *d, size_t col){
-  char   **tval;
-
-  //first element for free
-  size_t prior_elmt_ctr, elmt_ctr = 1;
-  char **telmts = malloc(sizeof(char**)*2);
-  telmts[0] = d->text[0][col];
-
-    for (int i=1; i< d->textsize[0]; i++){
-        prior_elmt_ctr  = elmt_ctr;
-        tval    =  &(d->text[i][col]);
-        lsearch (tval, telmts, &elmt_ctr, sizeof(char*), strcmpwrap);
-        if (prior_elmt_ctr  < elmt_ctr){
-            qsort(telmts, elmt_ctr, sizeof(char*), strcmpwrap);
-            telmts = realloc(telmts, sizeof(char**)*(elmt_ctr+1));
-        }
-    }
+    char **telmts;
+    size_t elmt_ctr = text_encode(d, col, NULL, &telmts);
 
     //pack and ship
     apop_data *out = apop_text_alloc(NULL, elmt_ctr, 1);
     for (int j=0; j< elmt_ctr; j++)
-        apop_text_add(out, j, 0, telmts[j]);
+        apop_text_add(out, j, 0, "%s", telmts[j]);
     free(telmts);
     return out;
 }
@@ -163,21 +205,22 @@ static apop_data * dummies_and_factors_core(apop_data *d, int col, char type,
                             apop_data **factor_list){
     size_t index, elmt_ctr = 0;
     gsl_vector *delmts = NULL;
-    char **telmts = NULL;//unfortunately needed for the bsearch.
+    char **telmts = NULL;
+    size_t *codes = NULL;
 
     //first, create an ordered list of unique elements.
     //Record that list for use in this function, and in a ->more page of the data set.
     char *catname =  make_catname(d, col, type);
     if (type == 't'){
-        *factor_list = apop_data_add_page(d, apop_text_unique_elements(d, col), catname);
-        elmt_ctr = (*factor_list)->textsize[0];
-        //awkward format conversion:
-        telmts = malloc(sizeof(char*)*elmt_ctr);
-        for (size_t j=0; j< elmt_ctr; j++)
-            asprintf(&(telmts[j]), "%s", (*factor_list)->text[j][0]);
-        (*factor_list)->vector = gsl_vector_alloc(elmt_ctr);
-        for (size_t i=0; i< (*factor_list)->vector->size; i++)
-            apop_data_set(*factor_list, i, -1, i);
+        //One hashing pass gives both the dictionary and each row's code.
+        codes = malloc(sizeof(size_t)*d->textsize[0]);
+        elmt_ctr = text_encode(d, col, codes, &telmts);
+        apop_data *dict = apop_text_alloc(apop_data_alloc(elmt_ctr), elmt_ctr, 1);
+        for (size_t i=0; i< elmt_ctr; i++){
+            apop_text_add(dict, i, 0, "%s", telmts[i]);
+            apop_data_set(dict, i, -1, i);
+        }
+        *factor_list = apop_data_add_page(d, dict, catname);
     } else {
         APOP_COL(d, col, to_search);
         delmts = apop_vector_unique_elements(to_search);
@@ -199,14 +242,21 @@ static apop_data * dummies_and_factors_core(apop_data *d, int col, char type,
             : (col >=0 ? d->matrix->size1 : d->vector->size);
     apop_data *out = (dummyfactor == 'd')
                 ? apop_data_calloc(0, s, (keep_first ? elmt_ctr : elmt_ctr-1))
-                : d;
+                : (dummyfactor == 's') ? apop_data_alloc() : d;
+    if (dummyfactor == 's') //one entry per row at most
+        out->sparse = apop_sparse_alloc(s, (keep_first ? elmt_ctr : elmt_ctr-1), s);
     for (size_t i=0; i< s; i++){
         if (type == 'd'){
             double val = apop_data_get(d, i, col);
             index = ((size_t)bsearch(&val, delmts->data, elmt_ctr, sizeof(double), compare_doubles) - (size_t)delmts->data)/sizeof(double);
-        } else 
-            index   = ((size_t)bsearch(&(d->text[i][col]), telmts, elmt_ctr, sizeof(char**), strcmpwrap) - (size_t)telmts)/sizeof(char**);
-        if (dummyfactor == 'd'){
+        } else
+            index = codes[i];
+        if (dummyfactor == 's'){
+            size_t *ctr = &out->sparse->rowstart[i+1];
+            *ctr = out->sparse->rowstart[i];
+            if (keep_first || index > 0)
+                out->sparse->col[(*ctr)++] = keep_first ? index : index-1;
+        } else if (dummyfactor == 'd'){
             if (keep_first)
                 gsl_matrix_set(out->matrix, i, index,1); 
             else if (index > 0)   //else don't keep first and index==0; throw it out. 
@@ -215,7 +265,7 @@ static apop_data * dummies_and_factors_core(apop_data *d, int col, char type,
             apop_data_set(out, i, datacol, index); 
     }
     //Add names:
-    if (dummyfactor == 'd'){
+    if (dummyfactor == 'd' || dummyfactor == 's'){
         char *basename = apop_get_factor_basename(d, col, type);
         for (size_t i = (keep_first) ? 0 : 1; i< elmt_ctr; i++){
             char n[1000];
@@ -228,11 +278,8 @@ static apop_data * dummies_and_factors_core(apop_data *d, int col, char type,
     }
     if (delmts)
         gsl_vector_free(delmts);
-    if (telmts){
-        for (size_t j=0; j< elmt_ctr; j++)
-            free(telmts[j]);
-        free(telmts);
-    }
+    free(telmts);
+    free(codes);
     free(catname);
     return out;
 }
@@ -274,16 +321,22 @@ the table, which is equivalent to <tt>append='e'</tt>.
 \param append If \c 'e' or \c 'y', append the dummy grid to the end of the original data
 matrix. If \c 'i', insert in place, immediately after the original data column. (default = \c 'n')
 \param remove If \c 'y', remove the original data or text column. (default = \c 'n')
+\param sparse If \c 'y', return the dummies in the \c sparse element of the output
+(see \ref apop_sparse) instead of a dense matrix. With <tt>.append</tt> set to anything
+but \c 'n', the dummies are put in (or added to the right of) the input data's \c sparse
+block, at the end of its columns. \ref apop_dot and \ref apop_ols use the sparse block
+directly, so a variable with thousands of categories costs one entry per row, not one
+column per category. (default = \c 'n')
 
 \return An \ref apop_data set whose \c matrix element is the one-zero
-matrix of dummies. If you used <tt>.append</tt>, then this is the main matrix.
+matrix of dummies (or whose \c sparse element holds them, if <tt>.sparse='y'</tt>). If you used <tt>.append</tt>, then this is the main matrix.
 Also, I add a page named <tt>"\<categories for your_var\>"</tt> giving a reference table of names and column numbers (where <tt>your_var</tt> is the appropriate column heading).
 \exception out->error=='a' allocation error
 \exception out->error=='d' dimension error
 \li NaNs appear at the end of the sort order.
 \li This function uses the \ref designated syntax for inputs.
 */
-APOP_VAR_HEAD apop_data * apop_data_to_dummies(apop_data *d, int col, char type, int keep_first, char append, char remove){
+APOP_VAR_HEAD apop_data * apop_data_to_dummies(apop_data *d, int col, char type, int keep_first, char append, char remove, char sparse){
     apop_data *apop_varad_var(d, NULL)
     Apop_stopif(!d, return NULL, 1, "You sent me a NULL data set for apop_data_to_dummies. Returning NULL.")
     int apop_varad_var(col, 0)
@@ -291,6 +344,7 @@ APOP_VAR_HEAD apop_data * apop_data_to_dummies(apop_data *d, int col, char type,
     int apop_varad_var(keep_first, 0)
     char apop_varad_var(append, 'n')
     char apop_varad_var(remove, 'n')
+    char apop_varad_var(sparse, 'n')
     if (remove =='y' && type == 't') Apop_notify(1, "Remove isn't implemented for text source columns yet.");
 APOP_VAR_ENDHEAD
     if (type == 'd'){
@@ -304,27 +358,47 @@ APOP_VAR_ENDHEAD
                                 0, "You asked for the text element %i but "
                                     "the data's text element has only %zu elements.", col, d->textsize[1]);
     apop_data *fdummy;
-    apop_data *dummies= dummies_and_factors_core(d, col, type, keep_first, 0, 'd', &fdummy);
+    apop_data *dummies= dummies_and_factors_core(d, col, type, keep_first, 0, (sparse=='y' ? 's' : 'd'), &fdummy);
     //Now process the append and remove options.
     size_t orig_size = d->matrix ? d->matrix->size1 : 0;
     int rm_list[orig_size+1];
     memset (rm_list, 0, (orig_size+1)*sizeof(int)); 
+    if (sparse=='y' && (append =='y' || append == 'e' || append ==1 || append=='i')){
+        if (append=='i') Apop_notify(1, "Sparse dummies always go after all other columns; appending at the end.");
+        if (remove!='n' && type!='t'){
+            rm_list[col]=1;
+            apop_data_rm_columns(d, rm_list);
+        }
+        int width = (d->matrix ? d->matrix->size2 : 0) + (d->sparse ? d->sparse->size2 : 0);
+        for (int k = d->names->colct; k < width; k++)
+            apop_name_add(d->names, "", 'c'); //pad so the name stacking is aligned (if needed)
+        apop_name_stack(d->names, dummies->names, 'c');
+        if (d->sparse) d->sparse = apop_sparse_stack(d->sparse, dummies->sparse);
+        else {
+            d->sparse = dummies->sparse;
+            dummies->sparse = NULL;
+        }
+        apop_data_free(dummies);
+        return d;
+    }
     if (append =='i'){
         apop_data **split = apop_data_split(d, col+1, 'c');
         //stack names, then matrices
         for (int i=0; i < d->names->colct; i++)
-            free(d->names->column[i]);
+            apop_arena_free(d->names->column[i]);
+        d->names->colct = 0; //the names are rebuilt from the pieces below.
         apop_name_stack(d->names, split[0]->names, 'c');
         for (int k = d->names->colct; k < (split[0]->matrix ? split[0]->matrix->size2 : 0); k++)
             apop_name_add(d->names, "", 'c'); //pad so the name stacking is aligned (if needed)
         apop_name_stack(d->names, dummies->names, 'c');
         apop_name_stack(d->names, split[1]->names, 'c');
-        gsl_matrix_free(d->matrix);
+        apop_arena_matrix_free(d->matrix);
         d->matrix = apop_matrix_stack(split[0]->matrix, dummies->matrix, 'c');
         apop_data_free(dummies);
         apop_data_free(split[0]);
         apop_matrix_stack(d->matrix, split[1]->matrix, 'c', .inplace='y');
         apop_data_free(split[1]);
+        free(split);
         return d;
     }
     if (remove!='n' && type!='t'){
@@ -374,6 +448,7 @@ Also, I add a page named <tt>"<categories for your_var>"</tt> giving a reference
 \exception out->error=='a' allocation error.
 \exception out->error=='d' dimension error.
 \li  If the vector or matrix you wanted to write to is \c NULL, I will allocate it for you.
+\li For text columns, the categories table and the factor for every row come out of one hashing pass over the column, so even columns with thousands of categories are cheap to convert. If the text is in a \ref apop_text_pool, equal strings are recognized by pointer.
 \li This function uses the \ref designated syntax for inputs.
 */
 APOP_VAR_HEAD apop_data *apop_data_to_factors(apop_data *data, char intype, int incol, int outcol){
@@ -500,7 +575,7 @@ SST, and SSR (and calculate the \f$R^2\f$s using those values).
   */
 apop_data *apop_estimate_coefficient_of_determination (apop_model *m){
   double          sse, sst, rsq, adjustment;
-  size_t          indep_ct= m->data->matrix->size2 - 1;
+  size_t          indep_ct= m->data->matrix->size2 - 1 + (m->data->sparse ? m->data->sparse->size2 : 0);
   apop_data       *out    = apop_data_alloc();
     gsl_vector *weights = m->data->weights; //typically NULL.
     apop_data *expected = apop_data_get_page(m->info, "<Predicted>");
@@ -516,7 +591,13 @@ apop_data *apop_estimate_coefficient_of_determination (apop_model *m){
         gsl_vector_free(v_times_w);
     }
     Apop_col(expected, 0, vv);
-    sst = apop_vector_weighted_var(vv, m->data->weights) * (vv->size-1);
+    if (!weights) sst = apop_vector_var(vv) * (vv->size-1);
+    else {  //sum w (y - ybar)^2, on the same scale as the weighted SSE.
+        double ybar = apop_vector_weighted_mean(vv, weights);
+        sst = 0;
+        for (size_t i=0; i< vv->size; i++)
+            sst += gsl_vector_get(weights, i) * gsl_pow_2(gsl_vector_get(vv, i) - ybar);
+    }
     rsq = 1. - (sse/sst);
     adjustment  = ((obs -1.) /(obs - indep_ct)) * (1.-rsq) ;
     apop_data_add_named_elmt(out, "R_squared", rsq);
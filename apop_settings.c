@@ -10,13 +10,15 @@ static size_t get_settings_ct(apop_model *model){
     return ct;
 }
 
-//The Dan J Bernstein string hashing algorithm.
-//Could conceivably save a lot of time under certain settings-heavy circumstances.
-static unsigned long apop_settings_hash(char *str){
-    unsigned long int hash = 5381;
-    char c;
-    while ((c = *str++)) hash = hash*33 + c;
-    return hash;
+/* Each model keeps a small table of pointers to the settings groups it has recently
+   found, indexed by the low bits of the group's hash. A hit is one load and one compare.
+   Slots point into model->settings, so adding or removing a group, which may move
+   that array, clears the table. Each slot is one pointer, so threads that look up
+   settings of a shared model at the same time see either the old slot or the new one. */
+#define Cache_slot(m, key) (m)->settings_cache[(key) % (sizeof((m)->settings_cache)/sizeof((m)->settings_cache[0]))]
+
+static void clear_cache(apop_model *m){
+    memset(m->settings_cache, 0, sizeof(m->settings_cache));
 }
 
 /* Remove a settings group from a model.
@@ -27,7 +29,8 @@ void apop_settings_remove_group(apop_model *m, char *delme){
     if (!m->settings) return;
     int i = 0;
     int ct = get_settings_ct(m);
-    unsigned long delme_hash = apop_settings_hash(delme);
+    unsigned long delme_hash = apop_string_hash(delme);
+    clear_cache(m);
  
     while (m->settings[i].name[0] !='\0'){
         if (m->settings[i].name_hash == delme_hash){
@@ -46,10 +49,11 @@ void *apop_settings_group_alloc(apop_model *model, char *type, void *free_fn, vo
     if(apop_settings_get_grp(model, type, 'c'))  
         apop_settings_remove_group(model, type); 
     int ct = get_settings_ct(model);
+    clear_cache(model);
     model->settings = realloc(model->settings, sizeof(apop_settings_type)*(ct+2));   
     model->settings[ct] = (apop_settings_type) {
                             .setting_group = the_group,
-                            .name_hash = apop_settings_hash(type),
+                            .name_hash = apop_string_hash(type),
                             .free= free_fn, .copy = copy_fn };
     strncpy(model->settings[ct].name, type, 100);
     model->settings[ct+1] = (apop_settings_type) { };
@@ -64,14 +68,23 @@ apop_model *apop_settings_group_alloc_wm(apop_model *model, char *type, void *fr
 
 /* This function is used internally by the macro \ref Apop_settings_get_group. Use that.  */
 void * apop_settings_get_grp(apop_model *m, char *type, char fail){
+    return apop_settings_get_grp_key(m, type, 0, fail);
+}
+
+/* As above, but with the hash of \c type already calculated (typically at compile
+   time, via \c Apop_settings_key). If <tt>key==0</tt>, I calculate it here. */
+void * apop_settings_get_grp_key(apop_model *m, char *type, unsigned long key, char fail){
     //Used only for finding the non-blank groups.
     Apop_stopif(!m, return NULL, 0, "you gave me a NULL model as input.");
     if (!m->settings) return NULL;
-    int i;
-    unsigned long type_hash = apop_settings_hash(type);
-    for (i=0; m->settings[i].name[0] !='\0'; i++)
-       if (type_hash == m->settings[i].name_hash)
+    if (!key) key = apop_string_hash(type);
+    apop_settings_type *hit = Cache_slot(m, key);
+    if (hit && hit->name_hash == key) return hit->setting_group;
+    for (int i=0; m->settings[i].name[0] !='\0'; i++)
+       if (key == m->settings[i].name_hash){
+           Cache_slot(m, key) = &m->settings[i];
            return m->settings[i].setting_group;
+       }
     Apop_assert(fail != 'f', "I couldn't find the settings group %s in the given model.", type);
     return NULL; //else, just return NULL and let the caller sort it out.
 }
@@ -89,7 +102,7 @@ void apop_settings_copy_group(apop_model *outm, apop_model *inm, char *copyme){
     void *g =  apop_settings_get_grp(inm, copyme, 'c');
     Apop_stopif(!g, outm->error='s'; return, 0, "Couldn't find the group you wanted me to copy. Not copying anything; setting outmodel->error='s'.");
     int i;
-    unsigned long type_hash = apop_settings_hash(copyme);
+    unsigned long type_hash = apop_string_hash(copyme);
     for (i=0; inm->settings[i].name[0] !='\0'; i++)//retrieve the index.
        if (type_hash == inm->settings[i].name_hash)
            break;
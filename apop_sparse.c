@@ -0,0 +1,277 @@
+/** \file apop_sparse.c  Compressed-row sparse blocks, used to hold large grids of dummy variables. */
+/* Copyright (c) 2026 by Ben Klemens.  Licensed under the modified GNU GPL v2; see COPYING and COPYING2.
+
+An \ref apop_data set's \c sparse element holds columns that sit logically to the right of
+its matrix: the full design matrix is \f$X = [M | S]\f$. Only the handful of
+operations that regressions need know about \c S: the products in \ref apop_dot, copying,
+and freeing.
+*/
+
+#include "apop_internal.h"
+
+/** Allocate a sparse block in compressed-row form.
+
+\param size1 The number of rows.
+\param size2 The number of columns.
+\param nonzeros The number of entries to make room for. The \c col array will have this many elements.
+\return A block with <tt>rowstart</tt> zeroed (i.e., no entries yet) and <tt>value==NULL</tt>,
+meaning that every stored entry is one. If you need other values, allocate
+<tt>nonzeros</tt> doubles for <tt>value</tt> yourself.
+\exception NULL on allocation failure.
+\ingroup data_struct
+*/
+apop_sparse *apop_sparse_alloc(size_t size1, size_t size2, size_t nonzeros){
+    apop_sparse *out = malloc(sizeof(apop_sparse));
+    Apop_stopif(!out, return NULL, 0, "malloc failed. Probably out of memory.");
+    *out = (apop_sparse){.size1=size1, .size2=size2,
+                         .rowstart = calloc(size1+1, sizeof(size_t)),
+                         .col = malloc(sizeof(size_t)*(nonzeros ? nonzeros : 1))};
+    Apop_stopif(!out->rowstart || !out->col, apop_sparse_free(out); return NULL,
+            0, "malloc failed. Probably out of memory.");
+    return out;
+}
+
+/** Free a sparse block. As with \c free(), sending in \c NULL is OK.
+\ingroup data_struct */
+void apop_sparse_free(apop_sparse *s){
+    if (!s) return;
+    free(s->rowstart);
+    free(s->col);
+    free(s->value);
+    free(s);
+}
+
+/** Return a newly allocated copy of a sparse block.
+\ingroup data_struct */
+apop_sparse *apop_sparse_copy(apop_sparse const *in){
+    if (!in) return NULL;
+    size_t nnz = in->rowstart[in->size1];
+    apop_sparse *out = apop_sparse_alloc(in->size1, in->size2, nnz);
+    Apop_stopif(!out, return NULL, 0, "Allocation error.");
+    memcpy(out->rowstart, in->rowstart, sizeof(size_t)*(in->size1+1));
+    memcpy(out->col, in->col, sizeof(size_t)*nnz);
+    if (in->value){
+        out->value = malloc(sizeof(double)*(nnz ? nnz : 1));
+        Apop_stopif(!out->value, apop_sparse_free(out); return NULL, 0, "Allocation error.");
+        memcpy(out->value, in->value, sizeof(double)*nnz);
+    }
+    return out;
+}
+
+/** Get the value at a given row and column of a sparse block; zero if there is no entry.
+\ingroup data_struct */
+double apop_sparse_get(apop_sparse const *s, size_t row, size_t col){
+    Apop_stopif(!s, return GSL_NAN, 0, "NULL sparse block. Returning NaN.");
+    Apop_stopif(row >= s->size1 || col >= s->size2, return GSL_NAN, 0, "Asked for (%zu, %zu), but "
+            "the block is %zu X %zu. Returning NaN.", row, col, s->size1, s->size2);
+    double out = 0;
+    for (size_t k = s->rowstart[row]; k < s->rowstart[row+1]; k++)
+        if (s->col[k] == col) out += s->value ? s->value[k] : 1;
+    return out;
+}
+
+/** Expand a sparse block into a dense \c gsl_matrix.
+\ingroup data_struct */
+gsl_matrix *apop_sparse_to_matrix(apop_sparse const *s){
+    if (!s) return NULL;
+    gsl_matrix *out = gsl_matrix_calloc(s->size1, s->size2);
+    Apop_stopif(!out, return NULL, 0, "Allocation error.");
+    for (size_t i=0; i< s->size1; i++)
+        for (size_t k = s->rowstart[i]; k < s->rowstart[i+1]; k++)
+            *gsl_matrix_ptr(out, i, s->col[k]) += s->value ? s->value[k] : 1;
+    return out;
+}
+
+/* Put the columns of right to the right of left's columns. Frees left; right is untouched. */
+apop_sparse *apop_sparse_stack(apop_sparse *left, apop_sparse const *right){
+    Apop_stopif(left->size1 != right->size1, return left, 0, "The blocks have %zu and %zu rows; "
+            "can't stack them. Returning the left block unchanged.", left->size1, right->size1);
+    size_t nnz = left->rowstart[left->size1] + right->rowstart[right->size1];
+    apop_sparse *out = apop_sparse_alloc(left->size1, left->size2 + right->size2, nnz);
+    Apop_stopif(!out, return left, 0, "Allocation error. Returning the left block unchanged.");
+    if (left->value || right->value) out->value = malloc(sizeof(double)*(nnz ? nnz : 1));
+    size_t ctr = 0;
+    for (size_t i=0; i< left->size1; i++){
+        for (size_t k = left->rowstart[i]; k < left->rowstart[i+1]; k++, ctr++){
+            out->col[ctr] = left->col[k];
+            if (out->value) out->value[ctr] = left->value ? left->value[k] : 1;
+        }
+        for (size_t k = right->rowstart[i]; k < right->rowstart[i+1]; k++, ctr++){
+            out->col[ctr] = right->col[k] + left->size2;
+            if (out->value) out->value[ctr] = right->value ? right->value[k] : 1;
+        }
+        out->rowstart[i+1] = ctr;
+    }
+    apop_sparse_free(left);
+    return out;
+}
+
+#define Sval(s, k) ((s)->value ? (s)->value[k] : 1)
+
+/* y += S x. */
+void apop_sparse_mv(apop_sparse const *s, gsl_vector const *x, gsl_vector *y){
+    for (size_t i=0; i< s->size1; i++){
+        double sum = 0;
+        for (size_t k = s->rowstart[i]; k < s->rowstart[i+1]; k++)
+            sum += Sval(s, k) * gsl_vector_get(x, s->col[k]);
+        *gsl_vector_ptr(y, i) += sum;
+    }
+}
+
+/* y += S' x. */
+void apop_sparse_tv(apop_sparse const *s, gsl_vector const *x, gsl_vector *y){
+    for (size_t i=0; i< s->size1; i++){
+        double xi = gsl_vector_get(x, i);
+        for (size_t k = s->rowstart[i]; k < s->rowstart[i+1]; k++)
+            *gsl_vector_ptr(y, s->col[k]) += Sval(s, k) * xi;
+    }
+}
+
+/* out += S' M, which is size2 X M->size2; if flip, write the transpose instead. */
+void apop_sparse_tm(apop_sparse const *s, gsl_matrix const *m, gsl_matrix *out, char flip){
+    for (size_t i=0; i< s->size1; i++)
+        for (size_t k = s->rowstart[i]; k < s->rowstart[i+1]; k++)
+            for (size_t c=0; c< m->size2; c++){
+                double add = Sval(s, k) * gsl_matrix_get(m, i, c);
+                if (flip) *gsl_matrix_ptr(out, c, s->col[k]) += add;
+                else      *gsl_matrix_ptr(out, s->col[k], c) += add;
+            }
+}
+
+/* out += A' B. With indicator blocks, this is just a table of counts. */
+static void sparse_tsp(apop_sparse const *a, apop_sparse const *b, gsl_matrix *out){
+    for (size_t i=0; i< a->size1; i++)
+        for (size_t ka = a->rowstart[i]; ka < a->rowstart[i+1]; ka++)
+            for (size_t kb = b->rowstart[i]; kb < b->rowstart[i+1]; kb++)
+                *gsl_matrix_ptr(out, a->col[ka], b->col[kb]) += Sval(a, ka) * Sval(b, kb);
+}
+
+/* out += S D, where D is size2 X out->size2, or out->size2 X size2 if flip. */
+static void sparse_mm(apop_sparse const *s, gsl_matrix const *d, char flip, gsl_matrix *out){
+    for (size_t i=0; i< s->size1; i++)
+        for (size_t k = s->rowstart[i]; k < s->rowstart[i+1]; k++)
+            for (size_t c=0; c< out->size2; c++)
+                *gsl_matrix_ptr(out, i, c) += Sval(s, k) *
+                            (flip ? gsl_matrix_get(d, c, s->col[k]) : gsl_matrix_get(d, s->col[k], c));
+}
+
+/* The diagonal of S'S, i.e., the sum of squares of each column. For indicators, counts. */
+void apop_sparse_col_ss(apop_sparse const *s, gsl_vector *out){
+    gsl_vector_set_zero(out);
+    for (size_t k=0; k< s->rowstart[s->size1]; k++)
+        *gsl_vector_ptr(out, s->col[k]) += gsl_pow_2(Sval(s, k));
+}
+
+/* Does every row have at most one entry? Then S'S is diagonal. */
+char apop_sparse_is_indicator(apop_sparse const *s){
+    for (size_t i=0; i< s->size1; i++)
+        if (s->rowstart[i+1] - s->rowstart[i] > 1) return 0;
+    return 1;
+}
+
+#define Xrows(d) ((d)->matrix ? (d)->matrix->size1 : (d)->sparse ? (d)->sparse->size1 : 0)
+#define Xdense(d) ((d)->matrix ? (d)->matrix->size2 : 0)
+#define Xcols(d) (Xdense(d) + ((d)->sparse ? (d)->sparse->size2 : 0))
+#define Has_sparse(d) ((d)->sparse && (d)->sparse->size2)
+
+/* X1' X2, or X1' v if X2 is NULL. */
+static void xpy(apop_data const *d1, apop_data const *d2, gsl_vector const *v, apop_data *out){
+    size_t p1 = Xdense(d1), k1 = Xcols(d1);
+    if (v){
+        out->vector = apop_arena_vector(out, k1, 1);
+        if (p1){
+            gsl_vector_view top = gsl_vector_subvector(out->vector, 0, p1);
+            gsl_blas_dgemv(CblasTrans, 1, d1->matrix, v, 0, &top.vector);
+        }
+        if (Has_sparse(d1)){
+            gsl_vector_view bottom = gsl_vector_subvector(out->vector, p1, k1-p1);
+            apop_sparse_tv(d1->sparse, v, &bottom.vector);
+        }
+        return;
+    }
+    size_t p2 = Xdense(d2), k2 = Xcols(d2);
+    out->matrix = apop_arena_matrix(out, k1, k2, 1);
+    if (p1 && p2){
+        gsl_matrix_view tl = gsl_matrix_submatrix(out->matrix, 0, 0, p1, p2);
+        gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, d1->matrix, d2->matrix, 0, &tl.matrix);
+    }
+    if (p1 && Has_sparse(d2)){
+        gsl_matrix_view tr = gsl_matrix_submatrix(out->matrix, 0, p2, p1, k2-p2);
+        apop_sparse_tm(d2->sparse, d1->matrix, &tr.matrix, 1);
+    }
+    if (Has_sparse(d1) && p2){
+        gsl_matrix_view bl = gsl_matrix_submatrix(out->matrix, p1, 0, k1-p1, p2);
+        apop_sparse_tm(d1->sparse, d2->matrix, &bl.matrix, 0);
+    }
+    if (Has_sparse(d1) && Has_sparse(d2)){
+        gsl_matrix_view br = gsl_matrix_submatrix(out->matrix, p1, p2, k1-p1, k2-p2);
+        sparse_tsp(d1->sparse, d2->sparse, &br.matrix);
+    }
+}
+
+/* X1 v, or X1 D (D possibly transposed) if v is NULL. */
+static void xb(apop_data const *d1, gsl_vector const *v, gsl_matrix const *dm, char flip, apop_data *out){
+    size_t p1 = Xdense(d1), k1 = Xcols(d1);
+    if (v){
+        out->vector = apop_arena_vector(out, Xrows(d1), 1);
+        if (p1){
+            gsl_vector_const_view top = gsl_vector_const_subvector(v, 0, p1);
+            gsl_blas_dgemv(CblasNoTrans, 1, d1->matrix, &top.vector, 0, out->vector);
+        }
+        if (Has_sparse(d1)){
+            gsl_vector_const_view bottom = gsl_vector_const_subvector(v, p1, k1-p1);
+            apop_sparse_mv(d1->sparse, &bottom.vector, out->vector);
+        }
+        return;
+    }
+    size_t c = flip ? dm->size1 : dm->size2;
+    out->matrix = apop_arena_matrix(out, Xrows(d1), c, 1);
+    if (p1){
+        gsl_matrix_const_view top = flip ? gsl_matrix_const_submatrix(dm, 0, 0, c, p1)
+                                         : gsl_matrix_const_submatrix(dm, 0, 0, p1, c);
+        gsl_blas_dgemm(CblasNoTrans, flip ? CblasTrans : CblasNoTrans, 1, d1->matrix, &top.matrix, 0, out->matrix);
+    }
+    if (Has_sparse(d1)){
+        gsl_matrix_const_view bottom = flip ? gsl_matrix_const_submatrix(dm, 0, p1, c, k1-p1)
+                                            : gsl_matrix_const_submatrix(dm, p1, 0, k1-p1, c);
+        sparse_mm(d1->sparse, &bottom.matrix, flip, out->matrix);
+    }
+}
+
+/* The part of apop_dot that handles data sets with a sparse block. The supported
+   forms are the ones a regression needs: X'Y for Y a vector, a dense matrix, or another
+   [matrix | sparse] set; and X b for b a vector or a (possibly transposed) dense matrix,
+   plus the vector-first versions of these. */
+apop_data *apop_sparse_dot(apop_data const *d1, apop_data const *d2, char form1, char form2){
+    char t1 = (form1 == 'p' || form1 == 't' || form1 == 1);
+    char t2 = (form2 == 'p' || form2 == 't' || form2 == 1);
+    char x1 = (d1->matrix || d1->sparse) && form1 != 'v';
+    char x2 = (d2->matrix || d2->sparse) && form2 != 'v';
+    Apop_stopif(!x1 && !d1->vector, return NULL, 0, "The left data set has neither a "
+                        "usable matrix nor a vector. Returning NULL.");
+    Apop_stopif(!x2 && !d2->vector, return NULL, 0, "The right data set has neither a "
+                        "usable matrix nor a vector. Returning NULL.");
+    apop_data *out = apop_data_alloc();
+    #define Sdimcheck(lr, rr) Apop_stopif((lr)!=(rr), out->error='d'; return out,\
+        0, "mismatched dimensions: inner dimensions are %zu and %zu.", (size_t)(lr), (size_t)(rr));
+    if (x1 && t1 && (!x2 || !t2)){ //X1' X2 or X1' v
+        Sdimcheck(Xrows(d1), x2 ? Xrows(d2) : d2->vector->size)
+        xpy(d1, x2 ? d2 : NULL, x2 ? NULL : d2->vector, out);
+    } else if (x1 && !t1 && (!x2 || !d2->sparse)){ //X1 v or X1 D
+        Sdimcheck(Xcols(d1), x2 ? (t2 ? d2->matrix->size2 : d2->matrix->size1) : d2->vector->size)
+        xb(d1, x2 ? NULL : d2->vector, x2 ? d2->matrix : NULL, t2, out);
+    } else if (!x1 && x2 && !t2){ //v X2 == X2' v
+        Sdimcheck(d1->vector->size, Xrows(d2))
+        xpy(d2, NULL, d1->vector, out);
+    } else if (!x1 && x2 && t2){  //v X2' == X2 v
+        Sdimcheck(d1->vector->size, Xcols(d2))
+        xb(d2, d1->vector, NULL, 0, out);
+    } else Apop_stopif(1, out->error='d'; return out, 0, "That combination of transpositions "
+                "isn't implemented for data sets with a sparse block. I can do X'Y and X b, "
+                "where only X and Y may have a sparse block.");
+
+    //As in apop_dot, if using the vector, there's no meaningful name to assign.
+    if (d1->names && x1) apop_name_stack(out->names, d1->names, 'r', t1 ? 'c' : 'r');
+    if (d2->names && x2) apop_name_stack(out->names, d2->names, 'c', t2 ? 'r' : 'c');
+    return out;
+}
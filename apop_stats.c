@@ -579,24 +579,46 @@ double apop_vector_weighted_cov(const gsl_vector *v1, const gsl_vector *v2, cons
 \param in 	An \ref apop_data set. If the weights vector is set, I'll take it into account.
 
 \li This is the sample covariance---dividing by \f$n-1\f$, not \f$n\f$.
+\li I find the column means, then the whole matrix from one symmetric rank-\f$k\f$ update
+using the centered data, threaded over \c apop_opts.thread_count threads. Each element
+matches \ref apop_vector_weighted_cov on the corresponding columns.
+\li The update scales each row by the square root of its weight, so weights may not be negative.
 
 \return Returns a \ref apop_data set the variance/covariance matrix relating each column with each other.
 \exception out->error='a'  Allocation error.
+\exception out->error='w'  A weight is negative.
 \ingroup matrix_moments */
 apop_data *apop_data_covariance(const apop_data *in){
     Apop_assert_c(in,  NULL, 1, "You sent me a NULL apop_data set. Returning NULL.");
     Apop_assert_c(in->matrix,  NULL, 1, "You sent me an apop_data set with a NULL matrix. Returning NULL.");
-    apop_data *out = apop_data_alloc(in->matrix->size2, in->matrix->size2);
+    gsl_matrix const *m = in->matrix;
+    gsl_vector const *w = in->weights;
+    Apop_assert_c(!w || w->size == m->size1, NULL, 0, "The data has %zu rows but %zu weights. Returning NULL.",
+                                                            m->size1, w->size);
+    apop_data *out = apop_data_alloc(m->size2, m->size2);
     Apop_stopif(out->error, return out, 0, "allocation error.");
-    for (size_t i=0; i < in->matrix->size2; i++){
-        for (size_t j=i; j < in->matrix->size2; j++){
-            Apop_col(in, i, v1);
-            Apop_col(in, j, v2);
-            double var = apop_vector_weighted_cov(v1, v2, in->weights);
-            gsl_matrix_set(out->matrix, i,j, var);
-            if (i!=j) gsl_matrix_set(out->matrix, j,i, var);
-        }
+    gsl_vector *sums = gsl_vector_calloc(m->size2);
+    long double wsum = 0;
+    for (size_t i=0; i< m->size1; i++){
+        double wi = w ? gsl_vector_get(w, i) : 1;
+        Apop_stopif(wi < 0, gsl_vector_free(sums); out->error='w'; return out,
+                0, "Weight %zu is negative (%g); I can't take the covariance.", i, wi);
+        gsl_vector_const_view row = gsl_matrix_const_row(m, i);
+        gsl_blas_daxpy(wi, &row.vector, sums);
+        wsum += wi;
     }
+    gsl_vector *mean = apop_vector_copy(sums);
+    gsl_vector_scale(mean, 1/(double)wsum);
+    apop_crossprod(m, mean, w, out->matrix);
+
+    /* As in apop_vector_weighted_cov, weights that sum to under 1.1 are taken to be
+       probabilities, and then the count is the number of rows. That cov is
+       [sum wxy - (sum wx)(sum wy)/len]/(len-1) = [crossprod + (sum wx)(sum wy)(1/wsum - 1/len)]/(len-1). */
+    double len = (wsum < 1.1 ? m->size1 : wsum);
+    if (len != wsum) gsl_blas_dger(1/(double)wsum - 1/len, sums, sums, out->matrix);
+    gsl_matrix_scale(out->matrix, 1/(len-1));
+    gsl_vector_free(sums);
+    gsl_vector_free(mean);
     apop_name_stack(out->names, in->names, 'c');
     apop_name_stack(out->names, in->names, 'r', 'c');
     return out;
@@ -611,14 +633,17 @@ apop_data *apop_data_covariance(const apop_data *in){
 \ingroup matrix_moments */
 apop_data *apop_data_correlation(const apop_data *in){
     apop_data *out = apop_data_covariance(in);
-    for(size_t i=0; i< in->matrix->size2; i++){
-        Apop_col(in, i, cvin);
-        Apop_col(out, i, cvout);
-        Apop_row(out, i, rvout);
-        double std_dev = sqrt(apop_vector_weighted_var(cvin, in->weights));
-        gsl_vector_scale(cvout, 1.0/std_dev);
-        gsl_vector_scale(rvout, 1.0/std_dev);
+    if (!out || out->error) return out;
+    size_t p = out->matrix->size1;
+    gsl_vector *inv_sd = gsl_vector_alloc(p);
+    for (size_t i=0; i< p; i++)
+        gsl_vector_set(inv_sd, i, 1/sqrt(gsl_matrix_get(out->matrix, i, i)));
+    for (size_t i=0; i< p; i++){
+        Apop_matrix_row(out->matrix, i, rvout);
+        gsl_vector_mul(rvout, inv_sd);
+        gsl_vector_scale(rvout, gsl_vector_get(inv_sd, i));
     }
+    gsl_vector_free(inv_sd);
     return out;
 }
 
@@ -129,8 +129,8 @@ APOP_VAR_HEAD apop_data * apop_f_test (apop_model *est, apop_data *contrast){
 
     apop_data *out = apop_f_test_base(est, contrast);
     if (free_data) {apop_data_free(contrast); return out;}
-    if (free_matrix) gsl_matrix_free(contrast->matrix);
-    if (free_vector) gsl_vector_free(contrast->vector);
+    if (free_matrix) apop_arena_matrix_free(contrast->matrix);
+    if (free_vector) apop_arena_vector_free(contrast->vector);
     return out;
 APOP_VAR_ENDHEAD
     apop_data *out = apop_data_alloc();
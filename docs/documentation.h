@@ -1990,6 +1990,7 @@ Outlineheader moreasst Assorted
 A few more descriptive methods:
 
 \li\ref apop_matrix_pca : Principal component analysis
+\li\ref apop_pca_query : Principal component analysis on a query too large to read into memory
 \li\ref apop_anova : One-way or two-way ANOVA tables
 
 
@@ -15,8 +15,20 @@
     int maxsize = GSL_MAX(vsize, GSL_MAX(msize1, d?d->textsize[0]:0));\
     (void)(tsize||wsize||firstcol||maxsize) /*prevent unused variable complaints */;
 
-// Define a static variable, and initialize on first use.
-#define Staticdef(type, name, def) static type (name) = NULL; if (!(name)) (name) = (def);
+/* Run the code in the trailing arguments once for every element of the vector and then
+ the matrix of d, with x set to the element. Rows are walked by pointer, so this is the
+ tight loop for likelihoods that treat the data as an unordered list of scalars. */
+#define Apop_data_elements(d, x, ...) { \
+    if ((d)->vector) for (size_t apop_i_=0; apop_i_< (d)->vector->size; apop_i_++){ \
+        double x = (d)->vector->data[apop_i_*(d)->vector->stride]; __VA_ARGS__ } \
+    if ((d)->matrix) for (size_t apop_r_=0; apop_r_< (d)->matrix->size1; apop_r_++){ \
+        double const *apop_row_ = (d)->matrix->data + apop_r_*(d)->matrix->tda; \
+        for (size_t apop_c_=0; apop_c_< (d)->matrix->size2; apop_c_++){ \
+            double x = apop_row_[apop_c_]; __VA_ARGS__ } } }
+
+// Define a static variable, and initialize on first use. Statics never come from the arena.
+#define Staticdef(type, name, def) static type (name) = NULL; \
+    if (!(name)) {char apop_arena_was = apop_arena_hold(1); (name) = (def); apop_arena_hold(apop_arena_was);}
 
 // Check for NULL and complain if so.
 #define Nullcheck(in, errval) Apop_assert_c(in, errval, apop_errorlevel, "%s is NULL.", #in)
@@ -28,17 +40,36 @@
 //deprecated:
 #define Nullcheck_p(in, errval) Nullcheck_mp(in, errval) 
 
+/* The Dan J Bernstein string hash, for settings-group names, the text pool, and factor
+ coding. Apop_settings_key in settings.h does the same at compile time; keep them in sync. */
+static inline unsigned long apop_string_hash(char const *str){
+    unsigned long hash = 5381;
+    for (unsigned char const *c = (unsigned char const*)str; *c; c++)
+        hash = hash*33 + *c;
+    return hash;
+}
+
 //in apop_conversions.c Extend a string.
 void xprintf(char **q, char *format, ...);
 #define XN(in) ((in) ? (in) : "")
 
 #include <sqlite3.h>
 #include <stddef.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_matrix.h>
 int apop_use_sqlite_prepared_statements(size_t col_ct);
 int apop_prepare_prepared_statements(char const *tabname, size_t col_ct, sqlite3_stmt **statement);
 char *prep_string_for_sqlite(int prepped_statements, char const *astring);//apop_conversions.c
+struct apop_data;
+int apop_query_blocks(char const *query, size_t block_size, int (*fn)(struct apop_data *block, void *arg), void *arg); //apop_db.c
 void apop_gsl_error(char const *reason, char const *file, int line, int gsl_errno); //apop_linear_algebra.c
 
+//apop_linear_algebra.c. Blocked, threaded products: c = alpha op(a) op(b) + beta c, and the
+//weighted, centered cross-product sum_i w_i (x_i - center)(x_i - center)'.
+void apop_gemm(CBLAS_TRANSPOSE_t lt, CBLAS_TRANSPOSE_t rt, double alpha, gsl_matrix const *a,
+                                     gsl_matrix const *b, double beta, gsl_matrix *c);
+void apop_crossprod(gsl_matrix const *x, gsl_vector const *center, gsl_vector const *w, gsl_matrix *out);
+
 //For when we're forced to use a global variable.
 #undef threadlocal
 #ifdef _ISOC11_SOURCE 
@@ -50,3 +81,35 @@ void apop_gsl_error(char const *reason, char const *file, int line, int gsl_errn
 #else
     #define threadlocal
 #endif
+
+//apop_arena.c. Parts of an object come from the arena iff the owner does; owner==NULL means a new top-level object.
+char apop_arena_owns(void const *ptr);
+char apop_arena_hold(char hold);
+void *apop_arena_malloc(void const *owner, size_t size);
+void apop_arena_free(void *ptr);
+char *apop_arena_strdup(void const *owner, char const *in);
+gsl_vector *apop_arena_vector(void const *owner, size_t size, char zero);
+gsl_matrix *apop_arena_matrix(void const *owner, size_t size1, size_t size2, char zero);
+void apop_arena_vector_free(gsl_vector *v);
+void apop_arena_matrix_free(gsl_matrix *m);
+
+//apop_sparse.c. This file precedes types.h, so use the struct tags.
+struct apop_sparse; struct apop_data;
+struct apop_sparse *apop_sparse_stack(struct apop_sparse *left, struct apop_sparse const *right);
+void apop_sparse_mv(struct apop_sparse const *s, gsl_vector const *x, gsl_vector *y);
+void apop_sparse_tv(struct apop_sparse const *s, gsl_vector const *x, gsl_vector *y);
+void apop_sparse_tm(struct apop_sparse const *s, gsl_matrix const *m, gsl_matrix *out, char flip);
+void apop_sparse_col_ss(struct apop_sparse const *s, gsl_vector *out);
+char apop_sparse_is_indicator(struct apop_sparse const *s);
+struct apop_data *apop_sparse_dot(struct apop_data const *d1, struct apop_data const *d2, char form1, char form2);
+
+//apop_dual.c. Evaluate log_likelihood_dual; gradient and hessian may be NULL.
+struct apop_model;
+double apop_dual_ll(struct apop_data *d, struct apop_model *m, gsl_vector *gradient, gsl_matrix *hessian);
+
+//apop_conversions.c. apop_data_pack(m->parameters, out, .all_pages='y') and its inverse, via a plan cached on the model.
+struct apop_pack_plan;
+void apop_param_pack(struct apop_model *m, gsl_vector *out);
+void apop_param_unpack(gsl_vector const *in, struct apop_model *m);
+size_t apop_param_count(struct apop_model *m);
+void apop_pack_plan_free(struct apop_pack_plan *p);
@@ -55,21 +55,31 @@ static double beta_log_likelihood(apop_data *d, apop_model *p){
     ab_type ab = { .alpha = apop_data_get(p->parameters,0,-1),
                    .beta  = apop_data_get(p->parameters,1,-1)
     };
-	return apop_map_sum(d, .fn_dp = betamap, .param=&ab) + gsl_sf_lnbeta(ab.alpha, ab.beta) * tsize;
+	return apop_map_sum(d, .fn_dp = betamap, .param=&ab) - gsl_sf_lnbeta(ab.alpha, ab.beta) * tsize;
 }
 
-static double dbeta_callback(double x){ return log(1-x); }
-
-static void beta_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
-    Nullcheck_mpd(d, m, )
+/* Both logs per element are shared by the log likelihood and the score. As with
+ betamap, elements outside of [0, 1] add nothing to the sums. */
+static double beta_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *m){
+    Nullcheck_mpd(d, m, GSL_NAN)
     Get_vmsizes(d) //tsize
-    double bb	= gsl_vector_get(m->parameters->vector, 0);
-    double a	= gsl_vector_get(m->parameters->vector, 1);
-    double lnsum = apop_map_sum(d, log);
-    double ln_x_minus_1_sum = apop_map_sum(d, dbeta_callback);
+    double alpha = gsl_vector_get(m->parameters->vector, 0);
+    double beta  = gsl_vector_get(m->parameters->vector, 1);
+    long double lnsum = 0, ln_one_less_sum = 0;
+    Apop_data_elements(d, x,
+        if (x < 0 || x > 1) continue;
+        lnsum += log(x);
+        ln_one_less_sum += log(1-x);
+    )
 	//Psi is the derivative of the log gamma function.
-	gsl_vector_set(gradient, 0, lnsum  + (-gsl_sf_psi(a) + gsl_sf_psi(a+bb))*tsize);
-	gsl_vector_set(gradient, 1, ln_x_minus_1_sum  + (-gsl_sf_psi(bb) + gsl_sf_psi(a+bb))*tsize);
+    double psi_ab = gsl_sf_psi(alpha+beta);
+	gsl_vector_set(gradient, 0, lnsum  + (psi_ab - gsl_sf_psi(alpha))*tsize);
+	gsl_vector_set(gradient, 1, ln_one_less_sum  + (psi_ab - gsl_sf_psi(beta))*tsize);
+    return (alpha-1)*lnsum + (beta-1)*ln_one_less_sum - gsl_sf_lnbeta(alpha, beta) * tsize;
+}
+
+static void beta_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
+    beta_ll_and_score(d, gradient, m);
 }
 
 static double beta_constraint(apop_data *data, apop_model *v){
@@ -99,5 +109,5 @@ static void beta_print(apop_model *m){
 }
 
 apop_model apop_beta = {"Beta distribution", 2,0,0, .dsize=1, .estimate = beta_estimate, 
-    .log_likelihood = beta_log_likelihood, .score = beta_dlog_likelihood, 
+    .log_likelihood = beta_log_likelihood, .score = beta_dlog_likelihood, .log_likelihood_score = beta_ll_and_score,
     .constraint = beta_constraint, .draw = beta_rng, .cdf = beta_cdf, .print=beta_print};
@@ -25,16 +25,34 @@ static double dirichlet_log_likelihood(apop_data *d, apop_model *p){
 	return apop_map_sum(d, .fn_vp = dirichletlnmap, .param=p->parameters->vector, .part='r');
 }
 
-static void dirichlet_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
-    Nullcheck_mpd(d, m, );
+/* gsl_ran_dirichlet_lnpdf recalculates the lngamma terms for every row; here they're
+ calculated once, and the per-row work is just the column sums of ln x. */
+static double dirichlet_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *m){
+    Nullcheck_mpd(d, m, GSL_NAN);
+    Apop_stopif(!m->parameters->vector, return GSL_NAN, 0, "parameters should be in inmodel->parameters->vector.");
     double param_sum = apop_sum(m->parameters->vector);
-    int n = d->matrix->size1;
-    for(size_t i=0; i < m->parameters->vector->size; i ++){
-        double thisparam = gsl_vector_get(m->parameters->vector, i);
-        Apop_col(d, i, onecol);
-        gsl_vector_set(gradient, i,  //Psi is the derivative of the log gamma function.
-                apop_vector_map_sum(onecol, log) + n*gsl_sf_psi(param_sum) - n*gsl_sf_psi(thisparam));
+    Apop_stopif(fabs(param_sum)<1e-5, return GSL_NAN, 0, "Parameter total is too close to zero.");
+    Apop_stopif(isnan(param_sum), return GSL_NAN, 0, "NaN parameter.");
+    size_t k = m->parameters->vector->size, n = d->matrix->size1;
+    long double lnsums[k];
+    memset(lnsums, 0, sizeof(lnsums));
+    for (size_t i=0; i< n; i++){
+        double const *row = d->matrix->data + i*d->matrix->tda;
+        for (size_t j=0; j< k; j++) lnsums[j] += log(row[j]);
+    }
+    double psi_sum = gsl_sf_psi(param_sum);
+    long double ll = n*gsl_sf_lngamma(param_sum);
+    for (size_t j=0; j< k; j++){
+        double thisparam = gsl_vector_get(m->parameters->vector, j);
+        ll += (thisparam-1)*lnsums[j] - n*gsl_sf_lngamma(thisparam);
+        //Psi is the derivative of the log gamma function.
+        gsl_vector_set(gradient, j, lnsums[j] + n*psi_sum - n*gsl_sf_psi(thisparam));
     }
+    return ll;
+}
+
+static void dirichlet_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
+    dirichlet_ll_and_score(d, gradient, m);
 }
 
 static double dirichlet_constraint(apop_data *data, apop_model *v){
@@ -49,4 +67,5 @@ static void dirichlet_rng(double *out, gsl_rng *r, apop_model* eps){
 
 apop_model apop_dirichlet = {"Dirichlet distribution", -1,0,0, .dsize=-1,
     .log_likelihood = dirichlet_log_likelihood, .score = dirichlet_dlog_likelihood,
+    .log_likelihood_score = dirichlet_ll_and_score,
     .constraint = dirichlet_constraint, .draw = dirichlet_rng};
@@ -65,6 +65,16 @@ static void exponential_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop
 	gsl_vector_set(gradient,0, d_likelihood);
 }
 
+//Both the log likelihood and the score are functions of the data sum alone.
+static double exponential_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *p){
+    Nullcheck_mpd(d, p, GSL_NAN);
+    Get_vmsizes(d) //tsize
+    double mu = gsl_vector_get(p->parameters->vector, 0);
+    double sum = (d->matrix ? apop_matrix_sum(d->matrix):0) + (d->vector ? apop_sum(d->vector) : 0);
+	gsl_vector_set(gradient,0, sum/gsl_pow_2(mu) - tsize/mu);
+	return -sum/mu - tsize * log(mu);
+}
+
 /* \adoc RNG Just a wrapper for \c gsl_ran_exponential.  */
 static void exponential_rng(double *out, gsl_rng* r, apop_model *p){
 	*out = gsl_ran_exponential(r, p->parameters->vector->data[0]);
@@ -72,5 +82,6 @@ static void exponential_rng(double *out, gsl_rng* r, apop_model *p){
 
 apop_model apop_exponential = {"Exponential distribution", 1,0,0,.dsize=1,
 	 .estimate = exponential_estimate, .log_likelihood = exponential_log_likelihood, 
-     .score = exponential_dlog_likelihood, .constraint = beta_greater_than_x_constraint, 
+     .score = exponential_dlog_likelihood, .log_likelihood_score = exponential_ll_and_score,
+     .constraint = beta_greater_than_x_constraint, 
      .draw = exponential_rng, .cdf = expo_cdf};
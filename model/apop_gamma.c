@@ -47,21 +47,28 @@ static double gamma_log_likelihood(apop_data *d, apop_model *p){
     return llikelihood;
 }
 
-static double a_callback(double x, void *ab){ return log(x)- *(double*)ab; }
-
-static double b_callback(double x, void *abv){ 
-    double *ab = abv;
-    return x/gsl_pow_2(ab[0]) - ab[1]; 
+/* As with apply_for_gamma, zeros add nothing to the log likelihood, and so nothing
+ to the score either. */
+static double gamma_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *p){
+    Nullcheck_mpd(d, p, GSL_NAN)
+    double  a = gsl_vector_get(p->parameters->vector, 0),
+        	b = gsl_vector_get(p->parameters->vector, 1);
+    long double lnsum = 0, xsum = 0;
+    size_t n = 0;
+    Apop_data_elements(d, x,
+        if (!x) continue;
+        lnsum += log(x);
+        xsum += x;
+        n++;
+    )
+    double ln_b = log(b);
+    gsl_vector_set(gradient, 0, lnsum - n*(gsl_sf_psi(a) + ln_b));
+    gsl_vector_set(gradient, 1, xsum/gsl_pow_2(b) - n*a/b);
+    return (a-1)*lnsum - xsum/b - n*(gsl_sf_lngamma(a) + a*ln_b);
 }
 
 static void gamma_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *p){
-    Nullcheck_mp(p, ) 
-    double  a = gsl_vector_get(p->parameters->vector, 0),
-        	b = gsl_vector_get(p->parameters->vector, 1);
-    double psi_a_ln_b  = gsl_sf_psi(a) + log(b);
-    double b_and_ab[2] = {b, a/b};
-    gsl_vector_set(gradient, 0, apop_map_sum(d, .fn_dp = a_callback, .param=&psi_a_ln_b));
-    gsl_vector_set(gradient, 1, apop_map_sum(d, .fn_dp = b_callback, .param=&b_and_ab));
+    gamma_ll_and_score(d, gradient, p);
 }
 
 /* \adoc RNG Just a wrapper for \c gsl_ran_gamma.
@@ -81,5 +88,6 @@ static double gamma_cdf(apop_data *d, apop_model *params){
 }
 
 apop_model apop_gamma = {"Gamma distribution", 2,0,0, .dsize=1, 
-      .log_likelihood = gamma_log_likelihood, .score = gamma_dlog_likelihood, 
+      .log_likelihood = gamma_log_likelihood, .score = gamma_dlog_likelihood,
+      .log_likelihood_score = gamma_ll_and_score,
       .constraint = gamma_constraint, .cdf = gamma_cdf, .draw = gamma_rng};
@@ -13,8 +13,9 @@ Provenance:
             COPYING2. Those BK edits made during time working as a gov't
             employee are public domain.
 
-    By the way, search the code for execnt: many functions will let you
-    query how many times they have been hit, which you might find to be useful.
+    The FORTRAN kept its scratch in static locals, and the C wrapper kept its workspace
+    in globals; both are gone. Each fit or prediction builds its own workspace, so
+    loess models can be estimated and used for prediction in several threads at once.
 
 \amodel apop_loess Regression via loess smoothing
 
@@ -49,6 +50,20 @@ In any case, all data is copied into the model's \ref apop_loess_settings. The c
 is primarily FORTRAN code from 1988 converted to C; the data thus has to be converted
 into a relatively obsolete internal format.
 
+The local regressions, one at each vertex of the k-d tree (or at each data point if
+<tt>.lo_s.control.surface="direct"</tt>), are split across \ref apop_opts_type
+"apop_opts.thread_count" threads.
+
+There is no global state, so you can also estimate loess models on different data sets
+in your own threads; in that case, set <tt>apop_opts.thread_count=1</tt> so the fits
+don't each start threads of their own.
+
+With the default interpolated surface, estimation keeps the k-d tree and the fits at
+its vertices ready for use, so \ref apop_predict only blends vertex values for each
+new point, in a loop split across \ref apop_opts_type "apop_opts.thread_count" threads
+for large batches. Confidence bands (<tt>.want_predict_ci='y'</tt>) still need a pass
+over the data for every prediction.
+
 
 \adoc    Parameter_format  The parameter vector is unused. 
 \adoc    estimated_parameters None.  
@@ -239,10 +254,10 @@ static void dqrsl_(double *x, integer *ldx, integer *n, integer * k, double *qra
         double *qy, double *qty, double *b, double *rsd, double *xb, integer job, integer *info) {
 
     integer x_dim1, i__1, i__2;
-    static integer i__, j;
-    static double t, temp;
-    static integer jj, ju, kp1;
-    static logical cb, cr, cxb, cqy, cqty;
+    integer i__, j;
+    double t, temp;
+    integer jj, ju, kp1;
+    logical cb, cr, cxb, cqy, cqty;
 
     x_dim1 = *ldx;
     x -= 1 + x_dim1;
@@ -459,11 +474,11 @@ static void dsvdc_(double *x, integer *ldx, integer *n, integer * p, double *s,
         double *v, integer *ldv, double *work, integer *job, integer * info) {
     integer x_dim1, u_dim1, v_dim1, i__2, i__3;
     double d__1;
-    static double b, c__, f, g, t, t1, el, cs, sl, sm, sn, acc, emm1, smm1;
-    static double test, scale, shift, ztest;
-    static integer i__, j, k, l, m, kk, ll, mm, ls, lu, lm1, mm1, lp1, mp1, nct, ncu, lls, nrt;
-    static integer kase, jobu, iter, nctp1, nrtp1, maxit;
-    static logical wantu, wantv;
+    double b, c__, f, g, t, t1, el, cs, sl, sm, sn, acc, emm1, smm1;
+    double test, scale, shift, ztest;
+    integer i__, j, k, l, m, kk, ll, mm, ls, lu, lm1, mm1, lp1, mp1, nct, ncu, lls, nrt;
+    integer kase, jobu, iter, nctp1, nrtp1, maxit;
+    logical wantu, wantv;
 
     x_dim1 = *ldx;
     x -= 1 + x_dim1;
@@ -834,8 +849,12 @@ L610:
 #define	GAUSSIAN	1
 #define SYMMETRIC	0
 
-static long	*iv, liv, lv, tau;
-static double *v;
+/* The workspace for the FORTRAN-style routines, laid out by lowesd_ (or by loess_grow,
+   from a saved k-d tree). Each fit or prediction builds its own and frees it when done. */
+typedef struct {
+    long *iv, liv, lv, tau;
+    double *v;
+} loess_work;
 
 /* begin ehg's FORTRAN-callable C-codes */
 
@@ -916,17 +935,14 @@ static integer ifloor(double x) {
 
 static void ehg126_(integer *d__, integer *n, integer *vc, double *x, double *v, integer *nvmax) {
     integer v_dim1, x_dim1;
-    static integer execnt = 0, i__, j, k;
-    static double t, mu, beta, alpha, machin;
+    integer i__, j, k;
+    double t, mu, beta, alpha, machin = DBL_MAX;
 
     x_dim1 = *n;
     x -= 1 + x_dim1;
     v_dim1 = *nvmax;
     v -= 1 + v_dim1;
 
-    ++execnt;
-    if (execnt == 1)
-        machin = DBL_MAX;
 /*     fill in vertices for bounding box of $x$ */
 /*     lower left, upper right */
     for (k = 1; k <= *d__; ++k) {
@@ -959,8 +975,8 @@ static void ehg125_(integer *p, integer *nv, double *v, integer *vhit, integer n
        integer k, double *t, integer *r__, integer *s, integer *f, integer *l, integer *u) {
 
     integer f_dim1, l_dim1, u_dim1, v_dim1;
-    static integer h__, i__, j, m, i3, mm, execnt = 0;
-    static logical match;
+    integer h__, i__, j, m, i3, mm;
+    logical match;
 
     --vhit;
     v_dim1 = nvmax;
@@ -972,7 +988,6 @@ static void ehg125_(integer *p, integer *nv, double *v, integer *vhit, integer n
     f_dim1 = *r__;
     f -= 1 + (f_dim1 << 1);
 
-    ++execnt;
     h__ = *nv;
     for (i__ = 1; i__ <= *r__; ++i__)
         for (j = 1; j <= *s; ++j) {
@@ -1010,14 +1025,13 @@ static void ehg125_(integer *p, integer *nv, double *v, integer *vhit, integer n
 static void find_kth_smallest(integer il, integer ir, integer k, integer nk, double *p, integer *pi) {
     //Formerly ehg106
     integer p_dim1;
-    static integer execnt = 0, i__, j, l, r, ii;
-    static double t;
+    integer i__, j, l, r, ii;
+    double t;
 
     --pi;
     p_dim1 = nk;
     p -= 1 + p_dim1;
 
-    ++execnt;
     /*     find the $k$-th smallest of $n$ elements */
     /*     Floyd+Rivest, CACM Mar '75, Algorithm 489 */
     l = il;
@@ -1068,8 +1082,8 @@ static integer idamax(integer n, double *dx, integer incx) {
     /*     Finds the index of element having max. absolute value. */
     /*     jack dongarra, linpack, 3/11/78. */
     int ret_val = 1;
-    static integer i__, ix;
-    static double dmax__;
+    integer i__, ix;
+    double dmax__;
     --dx;
 
     if (n < 1)
@@ -1101,9 +1115,9 @@ static void ehg124_(integer *ll, integer *uu, integer d__, integer n, integer *n
         integer *lo, integer *hi, integer *c__, double *v, integer *vhit, integer nvmax, integer *
         fc, double *fd, integer *dd) {
     integer c_dim1, v_dim1, v_offset, x_dim1, x_offset, i__1, i__3;
-    static integer execnt = 0, k, l, m, p, u, i4, check, lower, upper, inorm2, offset;
-    static logical i1, i2, leaf;
-    static double diag[8], diam, sigma[8];
+    integer k, l, m, p, u, i4, check, lower, upper, inorm2, offset;
+    logical i1, i2, leaf;
+    double diag[8], diam, sigma[8];
 
     --pi; --hi; --lo; --xi; --a; --vhit;
     x_dim1 = n;
@@ -1113,7 +1127,6 @@ static void ehg124_(integer *ll, integer *uu, integer d__, integer n, integer *n
     v_dim1 = nvmax;
     v -= v_offset = 1 + v_dim1;
 
-    ++execnt;
     p = 1;
     l = *ll;
     u = *uu;
@@ -1204,8 +1217,8 @@ static void ehg127_(double *q, integer *n, integer *d__, integer *nf, double *f,
 
     integer b_dim1, x_dim1, b_offset;
     double d__1;
-    static integer execnt = 0, i__, j, i3, i9, jj, info, jpvt, inorm2, column;
-    static double g[15], i2, rho, scal, machep, colnor[15];
+    integer i__, j, i3, i9, jj, info, jpvt, inorm2, column;
+    double g[15], i2, rho, scal, colnor[15], machep = DBL_EPSILON;
 
     --rw; --y; --psi;
     x_dim1 = *n;
@@ -1220,9 +1233,6 @@ static void ehg127_(double *q, integer *n, integer *d__, integer *nf, double *f,
     e -= 16;
     --dgamma; --qraux; --work; --cdeg;
 
-    ++execnt;
-    if (execnt == 1)
-        machep = DBL_EPSILON;
     /*     sort by distance */
     for (i3 = 1; i3 <= *n; ++i3)
         dist[i3] = 0.;
@@ -1339,15 +1349,11 @@ static void ehg127_(double *q, integer *n, integer *d__, integer *nf, double *f,
 
 static void ehg129_(integer *l, integer *u, integer *d__, double *x, integer *pi, integer n, double *sigma) {
     integer x_dim1;
-    static integer execnt = 0;
-    static double t, beta, alpha, machin;
+    double t, beta, alpha, machin = DBL_MAX;
     --sigma;
     --pi;
     x_dim1 = n;
     x -= 1 + x_dim1;
-    ++execnt;
-    if (execnt == 1)
-        machin = DBL_MAX;
     for (integer k = 1; k <= *d__; ++k) {
         alpha = machin;
         beta = -machin;
@@ -1372,9 +1378,9 @@ static void ehg131_(double *x, double *y, double *rw, double *trl,
     integer lq_dim1, lq_offset, c_dim1, c_offset, lf_dim1, lf_dim2, lf_offset,
 	     v_dim1, v_offset, vval_dim1, vval_offset, vval2_dim1, vval2_offset, x_dim1, x_offset;
 
-    static integer execnt = 0, j, i1, i2;
-    static double delta[8];
-    static integer identi;
+    integer j, i1, i2;
+    double delta[8];
+    integer identi;
 
     --psi; --pi; 
     x_dim1 = *n;
@@ -1399,7 +1405,6 @@ static void ehg131_(double *x, double *y, double *rw, double *trl,
     lq -= lq_offset = 1 + lq_dim1;
     --w; --eta; --b; --cdeg;
 
-    ++execnt;
     if (! (*d__ <= 8))
         loess_error(101);
 /*     build $k$-d tree */
@@ -1433,8 +1438,8 @@ static void ehg133_(integer *n, integer *d__, integer *vc, integer *nvmax, integ
         double *vval, double *xi, integer m, double *z__, double *s) {
     integer c_dim1, c_offset, v_dim1, v_offset, vval_dim1, vval_offset, z_dim1, z_offset;
 
-    static integer execnt = 0, i__, i1;
-    static double delta[8];
+    integer i__, i1;
+    double delta[8];
 
     vval_dim1 = *d__ - 0 + 1;
     vval -= vval_offset = 0 + vval_dim1;
@@ -1446,7 +1451,6 @@ static void ehg133_(integer *n, integer *d__, integer *vc, integer *nvmax, integ
     z_dim1 = m;
     z__ -= z_offset = 1 + z_dim1;
 
-    ++execnt;
     for (i__ = 1; i__ <= m; ++i__) {
         for (i1 = 1; i1 <= *d__; ++i1)
             delta[i1 - 1] = z__[i__ + i1 * z_dim1];
@@ -1478,8 +1482,8 @@ static void set_cs(integer d, integer i, double *c1, double *c2, double *c3){
 static void ehg141_(double *trl, integer *n, integer *deg, integer *k, integer *d,
         integer *nsing, integer *dk, double * delta1, double *delta2) {
 
-    static integer i;
-    static double z, c1, c2, c3, c4, corx;
+    integer i;
+    double z, c1, c2, c3, c4, corx;
 
 /*     coef, d, deg, del */
     if (*deg == 0)
@@ -1503,7 +1507,7 @@ static void ehg141_(double *trl, integer *n, integer *deg, integer *k, integer *
 } /* ehg141_ */
 
 static void lowesc_(integer *n, double *l, double *ll, double *trl, double *delta1, double *delta2) {
-    static integer execnt = 0, i__, j;
+    integer i__, j;
     integer l_dim1, ll_dim1;
 
     ll_dim1 = *n;
@@ -1511,7 +1515,6 @@ static void lowesc_(integer *n, double *l, double *ll, double *trl, double *delt
     l_dim1 = *n;
     l -= 1 + l_dim1;
 
-    ++execnt;
 /*     compute $LL~=~(I-L)(I-L)'$ */
     for (i__ = 1; i__ <= *n; ++i__)
         --l[i__ + i__ * l_dim1];
@@ -1539,7 +1542,7 @@ static void lowesc_(integer *n, double *l, double *ll, double *trl, double *delt
 static void ehg169_(integer d__, integer *vc, integer *nc, integer *ncmax, integer *nv, 
         integer nvmax, double *v, integer *a, double *xi, integer *c__, integer *hi, integer *lo) {
     integer c_dim1, v_dim1, v_offset, i__1, i__3;
-    static integer execnt = 0, i__, j, k, p, mc, mv, novhit[1];
+    integer i__, j, k, p, mc, mv, novhit[1];
 
     --lo;
     --hi;
@@ -1550,7 +1553,6 @@ static void ehg169_(integer d__, integer *vc, integer *nc, integer *ncmax, integ
     v_dim1 = nvmax;
     v -= v_offset = 1 + v_dim1;
 
-    ++execnt;
     /*     as in bbox */
     /*     remaining vertices */
     for (i__ = 2; i__ <= *vc - 1; ++i__) {
@@ -1636,10 +1638,9 @@ static double ehg176_(double *z) {
 
 static void lowesa_(double *trl, integer *n, integer *d__,
             integer *tau, integer *nsing, double *delta1, double *delta2) {
-    static integer execnt = 0, dka, dkb;
-    static double d1a, d1b, d2a, d2b, alpha;
+    integer dka, dkb;
+    double d1a, d1b, d2a, d2b, alpha;
 
-    ++execnt;
     ehg141_(trl, n, &c__1, tau, d__, nsing, &dka, &d1a, &d2a);
     ehg141_(trl, n, &c__2, tau, d__, nsing, &dkb, &d1b, &d2b);
     alpha = (double) (*tau - dka) / (double) (dkb - dka);
@@ -1653,8 +1654,8 @@ static void ehg191_(integer *m, double *z__, double *l, integer *d__, integer *n
 
     integer lq_dim1, c_offset, l_dim1, lf_dim1, lf_dim2, v_offset, vval2_dim1, vval2_offset, z_dim1;
 
-    static integer execnt = 0, i__, j, p, i1, i2, lq1;
-    static double zi[8];
+    integer i__, j, p, i1, i2, lq1;
+    double zi[8];
     z_dim1 = *m;
     z__ -= 1 + z_dim1;
     l_dim1 = *m;
@@ -1673,7 +1674,6 @@ static void ehg191_(integer *m, double *z__, double *l, integer *d__, integer *n
     vval2 -= vval2_offset = 0 + vval2_dim1;
     v -= v_offset = 1 + *nvmax;
 
-    ++execnt;
     for (j = 1; j <= *n; ++j) {
         for (i2 = 1; i2 <= *nv; ++i2)
             for (i1 = 0; i1 <= *d__; ++i1)
@@ -1699,10 +1699,9 @@ static void ehg191_(integer *m, double *z__, double *l, integer *d__, integer *n
 } /* ehg191_ */
 
 static void ehg196_(integer tau, integer d__, double f, double *trl) {
-    static integer execnt = 0, dka, dkb;
-    static double trla, trlb, alpha;
+    integer dka, dkb;
+    double trla, trlb, alpha;
 
-    ++execnt;
     ehg197(1, d__, f, &dka, &trla);
     ehg197(2, d__, f, &dkb, &trlb);
     alpha = (double) (tau - dka) / (double) (dkb - dka);
@@ -1748,11 +1747,11 @@ static double ehg128_(double *z__, integer *d__, integer *ncmax, integer *vc,
         integer *a, double *xi, integer *lo, integer *hi, integer *c__,
         double *v, integer *nvmax, double *vval) {
     integer c_dim1, v_dim1, vval_dim1;
-    static double g[2304]	/* was [9][256] */, h__;
-    static logical i2;
-    static integer execnt = 0, t[20], i__, j, m, i1, i11, i12, ig, ii, lg, ll, nt, ur;
-    static double g0[9], g1[9], s, v0, v1, ge, gn, gs, gw;
-    static double gpe, gpn, gps, gpw, sew, sns, phi0, phi1, psi0, psi1, xibar;
+    double g[2304]	/* was [9][256] */, h__;
+    logical i2;
+    integer t[20], i__, j, m, i1, i11, i12, ig, ii, lg, ll, nt, ur;
+    double g0[9], g1[9], s, v0, v1, ge, gn, gs, gw;
+    double gpe, gpn, gps, gpw, sew, sns, phi0, phi1, psi0, psi1, xibar;
 
     --z__; --hi; --lo; --xi; --a;
     c_dim1 = *vc;
@@ -1762,7 +1761,6 @@ static double ehg128_(double *z__, integer *d__, integer *ncmax, integer *vc,
     v_dim1 = *nvmax;
     v -= 1 + v_dim1;
 
-    ++execnt;
     /*     locate enclosing cell */
     nt = 1;
     t[nt - 1] = 1;
@@ -1958,16 +1956,71 @@ static double ehg128_(double *z__, integer *d__, integer *ncmax, integer *vc,
     return s;
 }
 
-static void ehg136_(double *u, integer *lm, integer *m, integer *n, integer *d__, integer *nf, 
+/* The local fits at the vertices (ehg139_) or at the evaluation points (ehg136_) don't
+   depend on each other, so they are split across apop_opts.thread_count threads. Each
+   fit in ehg127_ sorts psi and overwrites dist, eta, b, and w, so the first thread uses
+   the caller's workspace and every other thread gets its own copies, plus its own
+   rcond, singularity count, and (when finding trace(L)) diagl and vval2 scratch. These
+   are merged after all threads are joined. */
+typedef struct {
+    integer *psi, k, sing, first, last;
+    double *dist, *eta, *b, *w, *diagl, *vval2, rcond;
+    void const *args;
+} loess_fit_thread;
+
+static void loess_run_fits(loess_fit_thread *base, integer fits, integer n, integer nf, 
+                   char trace, integer vval2_size, void *(*fn)(void*), integer *k, double *rcond, integer *sing){
+    int threadct = GSL_MAX(1, GSL_MIN(apop_opts.thread_count, (double)fits*n/2e4));
+    loess_fit_thread t[threadct];
+    pthread_t thread_id[threadct];
+    for (int i=0; i< threadct; i++){
+        t[i] = *base;
+        t[i].k = *k;
+        t[i].rcond = *rcond;
+        t[i].sing = *sing;
+        t[i].first = 1 + fits*i/threadct;
+        t[i].last = fits*(i+1)/threadct;
+        if (!i) continue;
+        t[i].psi = malloc(n*sizeof(integer));
+        t[i].dist = malloc(n*sizeof(double));
+        t[i].eta = malloc(nf*sizeof(double));
+        t[i].b = malloc(nf*(*k)*sizeof(double));
+        t[i].w = malloc(nf*sizeof(double));
+        if (trace){
+            t[i].diagl = calloc(n, sizeof(double));
+            t[i].vval2 = calloc(vval2_size, sizeof(double));
+        }
+        pthread_create(&thread_id[i], NULL, fn, t+i);
+    }
+    fn(t);
+    integer sing_in = *sing;
+    *k = t[0].k;
+    *rcond = t[0].rcond;
+    *sing = t[0].sing;
+    for (int i=1; i< threadct; i++){
+        pthread_join(thread_id[i], NULL);
+        *rcond = GSL_MIN(*rcond, t[i].rcond);
+        *sing += t[i].sing - sing_in;
+        if (trace){
+            for (integer j=0; j< n; j++) base->diagl[j] += t[i].diagl[j];
+            free(t[i].diagl);
+            free(t[i].vval2);
+        }
+        free(t[i].psi); free(t[i].dist); free(t[i].eta); free(t[i].b); free(t[i].w);
+    }
+}
+
+//Fits evaluation points lfirst...llast. See ehg136_ below.
+static void ehg136_range(double *u, integer *lm, integer *m, integer *n, integer *d__, integer *nf, 
         double *f, double *x, integer *psi, double *y, double *rw, integer *kernel, integer *k, 
         double *dist, double *eta, double *b, integer *od, double *o, integer *ihat, double *w, 
-        double *rcond, integer *sing, integer *dd, integer *tdeg, integer *cdeg, double * s) {
+        double *rcond, integer *sing, integer *dd, integer *tdeg, integer *cdeg, double * s,
+        integer lfirst, integer llast) {
 
-    static integer execnt = 0;
     integer o_dim1, b_dim1, b_offset, s_dim1, u_dim1, x_dim1, x_offset;
-    static integer i__, j, l, i1, info, identi;
-    static double q[8], tol, work[15], scale, sigma[15], qraux[15], dgamma[15];
-    static double e[225]	/* was [15][15] */, g[225]	/* was [15][15] */;
+    integer i__, j, l, i1, info, identi;
+    double q[8], tol, work[15], scale, sigma[15], qraux[15], dgamma[15];
+    double e[225]	/* was [15][15] */, g[225]	/* was [15][15] */;
 
     o_dim1 = *m;
     o -= 1 + o_dim1;
@@ -1986,18 +2039,13 @@ static void ehg136_(double *u, integer *lm, integer *m, integer *n, integer *d__
     s -= 0 + s_dim1;
     --cdeg;
 
-    ++execnt;
-    if (! (*k <= *nf - 1))
-        loess_error(104);
-    if (! (*k <= 15))
-        loess_error(105);
-    for (identi = 1; identi <= *n; ++identi)
-        psi[identi] = identi;
-    for (l = 1; l <= *m; ++l) {
+    for (l = lfirst; l <= llast; ++l) {
+        for (identi = 1; identi <= *n; ++identi)
+            psi[identi] = identi;
         for (i1 = 1; i1 <= *d__; ++i1)
             q[i1 - 1] = u[l + i1 * u_dim1];
         ehg127_(q, n, d__, nf, f, &x[x_offset], &psi[1], y, &rw[1],
-            kernel, k, &dist[1], &eta[1], &b[b_offset], od, &w[1], rcond,
+            kernel, k, dist, &eta[1], &b[b_offset], od, &w[1], rcond,
             sing, sigma, e, g, dgamma, qraux, work, &tol, dd, tdeg, &cdeg[1], &s[l * s_dim1]);
         if (*ihat == 1) {
     /*           $L sub {l,l} = */
@@ -2055,11 +2103,39 @@ static void ehg136_(double *u, integer *lm, integer *m, integer *n, integer *d__
             }
         }
     }
+} /* ehg136_range */
+
+struct ehg136_args {
+    double *u; integer *lm, *m, *n, *d__, *nf; double *f, *x, *y, *rw; integer *kernel, *od;
+    double *o; integer *ihat, *dd, *tdeg, *cdeg; double *s;
+};
+
+static void *ehg136_thread(void *in){
+    loess_fit_thread *t = in;
+    struct ehg136_args const *a = t->args;
+    ehg136_range(a->u, a->lm, a->m, a->n, a->d__, a->nf, a->f, a->x, t->psi, a->y, a->rw,
+            a->kernel, &t->k, t->dist, t->eta, t->b, a->od, a->o, a->ihat, t->w, &t->rcond,
+            &t->sing, a->dd, a->tdeg, a->cdeg, a->s, t->first, t->last);
+    return NULL;
+}
+
+static void ehg136_(double *u, integer *lm, integer *m, integer *n, integer *d__, integer *nf, 
+        double *f, double *x, integer *psi, double *y, double *rw, integer *kernel, integer *k, 
+        double *dist, double *eta, double *b, integer *od, double *o, integer *ihat, double *w, 
+        double *rcond, integer *sing, integer *dd, integer *tdeg, integer *cdeg, double * s) {
+    if (! (*k <= *nf - 1))
+        loess_error(104);
+    if (! (*k <= 15))
+        loess_error(105);
+    struct ehg136_args args = {.u=u, .lm=lm, .m=m, .n=n, .d__=d__, .nf=nf, .f=f, .x=x, .y=y,
+            .rw=rw, .kernel=kernel, .od=od, .o=o, .ihat=ihat, .dd=dd, .tdeg=tdeg, .cdeg=cdeg, .s=s};
+    loess_fit_thread base = {.psi=psi, .dist=dist, .eta=eta, .b=b, .w=w, .args=&args};
+    loess_run_fits(&base, *m, *n, *nf, 0, 0, ehg136_thread, k, rcond, sing);
 } /* ehg136_ */
 
 static void ehg137_(double *z__, integer *kappa, integer *leaf, integer *nleaf, integer *d__, 
         integer *nv, integer *nvmax, integer * ncmax, integer *a, double *xi, integer *lo, integer *hi) {
-    static integer execnt = 0, p, pstack[20], stackt;
+    integer p, pstack[20], stackt;
 
     --leaf;
     --z__;
@@ -2068,7 +2144,6 @@ static void ehg137_(double *z__, integer *kappa, integer *leaf, integer *nleaf,
     --xi;
     --a;
     /*     stacktop -> stackt */
-    ++execnt;
     /*     find leaf cells affected by $z$ */
     stackt = 0;
     p = 1;
@@ -2106,22 +2181,23 @@ static void ehg137_(double *z__, integer *kappa, integer *leaf, integer *nleaf,
 
 //BK: Changed phi (the 17th input) from integer to double, because this fn is only called
 //once, and there, dist==phi.
-static void ehg139_(double *v, integer *nvmax, integer *nv, integer *n, integer *d__, 
+//Fits vertices lfirst...llast; diagl and vval2 arrive zeroed. See ehg139_ below.
+static void ehg139_range(double *v, integer *nvmax, integer *nv, integer *n, integer *d__, 
         integer *nf, double *f, double *x, integer *pi, integer *psi, double *y, 
         double *rw, double *trl, integer *kernel, integer *k, double *dist, double *phi,
         double *eta, double *b, integer *od, double *w, double *diagl, double *vval2, 
         integer *ncmax, integer *vc, integer *a, double *xi, integer *lo, integer *hi, integer *c__,
         integer *vhit, double *rcond, integer *sing, integer *dd, integer
-        *tdeg, integer *cdeg, integer *lq, double *lf, logical *setlf, double *s) {
+        *tdeg, integer *cdeg, integer *lq, double *lf, logical *setlf, double *s,
+        integer lfirst, integer llast) {
 
     integer lq_dim1, c_dim1, c_offset, lf_dim1, lf_dim2, b_dim1, b_offset, 
-            s_dim1, v_dim1, v_offset, vval2_dim1, vval2_offset, x_dim1, x_offset, i__1, i__3;
+            s_dim1, v_dim1, v_offset, vval2_dim1, vval2_offset, x_dim1, x_offset, i__3;
 
-    static integer execnt = 0;
-    static double e[225]	/* was [15][15] */;
-    static double q[8], u[225]	/* was [15][15] */, z__[8], i4, i7, tol;
-    static integer i__, j, l, i5, i6, ii, leaf[256], info, ileaf, nleaf, identi;
-    static double term, work[15], scale, sigma[15], qraux[15], dgamma[15];
+    double e[225]	/* was [15][15] */;
+    double q[8], u[225]	/* was [15][15] */, z__[8], i4, i7, tol;
+    integer i__, j, l, i5, i6, ii, leaf[256], info, ileaf, nleaf, identi;
+    double term, work[15], scale, sigma[15], qraux[15], dgamma[15];
 
     --vhit; --diagl; --phi; --dist; --rw; --y;
     --psi; --pi; --w; --eta; --hi; --lo; --xi; --cdeg;
@@ -2143,23 +2219,12 @@ static void ehg139_(double *v, integer *nvmax, integer *nv, integer *n, integer
     c_dim1 = *vc;
     c__ -= c_offset = 1 + c_dim1;
 
-    ++execnt;
     /*     l2fit with trace(L) */
-    if (! (*k <= *nf - 1))
-        loess_error(104);
-    if (! (*k <= 15))
-        loess_error(105);
-    if (*trl != 0.) {
-        for (i5 = 1; i5 <= *n; ++i5)
-            diagl[i5] = 0.;
-        for (i6 = 1; i6 <= *nv; ++i6)
-            for (i5 = 0; i5 <= *d__; ++i5)
-                vval2[i5 + i6 * vval2_dim1] = 0.;
-    }
-    for (identi = 1; identi <= *n; ++identi)
-        psi[identi] = identi;
-    i__1 = *nv;
-    for (l = 1; l <= i__1; ++l) {
+    for (l = lfirst; l <= llast; ++l) {
+        //Start every sort from the identity, so a vertex's fit doesn't depend on which
+        //vertices were fit before it in this thread.
+        for (identi = 1; identi <= *n; ++identi)
+            psi[identi] = identi;
         for (i5 = 1; i5 <= *d__; ++i5)
             q[i5 - 1] = v[l + i5 * v_dim1];
         ehg127_(q, n, d__, nf, f, &x[x_offset], &psi[1], &y[1], &rw[1],
@@ -2239,25 +2304,61 @@ static void ehg139_(double *v, integer *nvmax, integer *nv, integer *n, integer
             }
         }
     }
+} /* ehg139_range */
+
+struct ehg139_args {
+    double *v; integer *nvmax, *nv, *n, *d__, *nf; double *f, *x; integer *pi; double *y, *rw, *trl;
+    integer *kernel, *od, *ncmax, *vc, *a; double *xi; integer *lo, *hi, *c__, *vhit, *dd, *tdeg, *cdeg, *lq;
+    double *lf; logical *setlf; double *s;
+};
+
+static void *ehg139_thread(void *in){
+    loess_fit_thread *t = in;
+    struct ehg139_args const *a = t->args;
+    ehg139_range(a->v, a->nvmax, a->nv, a->n, a->d__, a->nf, a->f, a->x, a->pi, t->psi, a->y,
+            a->rw, a->trl, a->kernel, &t->k, t->dist, t->dist, t->eta, t->b, a->od, t->w, t->diagl,
+            t->vval2, a->ncmax, a->vc, a->a, a->xi, a->lo, a->hi, a->c__, a->vhit, &t->rcond,
+            &t->sing, a->dd, a->tdeg, a->cdeg, a->lq, a->lf, a->setlf, a->s, t->first, t->last);
+    return NULL;
+}
+
+static void ehg139_(double *v, integer *nvmax, integer *nv, integer *n, integer *d__, 
+        integer *nf, double *f, double *x, integer *pi, integer *psi, double *y, 
+        double *rw, double *trl, integer *kernel, integer *k, double *dist, double *phi,
+        double *eta, double *b, integer *od, double *w, double *diagl, double *vval2, 
+        integer *ncmax, integer *vc, integer *a, double *xi, integer *lo, integer *hi, integer *c__,
+        integer *vhit, double *rcond, integer *sing, integer *dd, integer
+        *tdeg, integer *cdeg, integer *lq, double *lf, logical *setlf, double *s) {
+    if (! (*k <= *nf - 1))
+        loess_error(104);
+    if (! (*k <= 15))
+        loess_error(105);
+    if (*trl != 0.) {
+        memset(diagl, 0, *n * sizeof(double));
+        memset(vval2, 0, (*d__ + 1) * *nvmax * sizeof(double));
+    }
+    struct ehg139_args args = {.v=v, .nvmax=nvmax, .nv=nv, .n=n, .d__=d__, .nf=nf, .f=f, .x=x,
+            .pi=pi, .y=y, .rw=rw, .trl=trl, .kernel=kernel, .od=od, .ncmax=ncmax, .vc=vc, .a=a,
+            .xi=xi, .lo=lo, .hi=hi, .c__=c__, .vhit=vhit, .dd=dd, .tdeg=tdeg, .cdeg=cdeg, .lq=lq,
+            .lf=lf, .setlf=setlf, .s=s};
+    loess_fit_thread base = {.psi=psi, .dist=dist, .eta=eta, .b=b, .w=w, .diagl=diagl,
+            .vval2=vval2, .args=&args};
+    loess_run_fits(&base, *nv, *n, *nf, *trl != 0., (*d__ + 1) * *nvmax, ehg139_thread, k, rcond, sing);
     if (*trl != 0.) {
-        if (*n <= 0)
-            *trl = 0.;
-        else {
-            *trl = diagl[*n];
-            for (int i2 = *n - 1; i2 >= 1; --i2)
-                *trl += diagl[i2];
-        }
+        *trl = 0;
+        for (integer i = *n - 1; i >= 0; --i)
+            *trl += diagl[i];
     }
-}
+} /* ehg139_ */
 
 static void dqrdc_(double *x, integer *ldx, integer *n, integer *p, double *qraux, 
         integer *jpvt, double *work, integer job) {
     integer x_dim1, i__2, i__3;
     double d__2;
 
-    static integer j, l, jj, jp, pl, pu, lp1, lup, maxj;
-    static logical negj, swapj;
-    static double t, tt, nrmxl, maxnrm;
+    integer j, l, jj, jp, pl, pu, lp1, lup, maxj;
+    logical negj, swapj;
+    double t, tt, nrmxl, maxnrm;
 
 /*     dqrdc uses householder transformations to compute the qr 
      factorization of an n by p matrix x.  column pivoting 
@@ -2467,11 +2568,10 @@ L60:
 
 static void lowesb_(double *xx, double *yy, double *ww, double *diagl, double trl,
         integer *iv, integer *liv, integer * lv, double *wv) {
-    static integer execnt = 0, setlf;
+    integer setlf;
     --wv;
     --iv;
 
-    ++execnt;
     if (! (iv[28] != 173))
         loess_error(174);
     if (iv[28] != 172 && !(iv[28] == 171))
@@ -2492,11 +2592,10 @@ static void lowesb_(double *xx, double *yy, double *ww, double *diagl, double tr
 
 static void lowesd_(integer *iv, integer *liv, integer *lv, double *v, 
         integer d__, integer n, double f, integer ideg, integer *nvmax, logical *setlf) {
-    static integer execnt = 0, i__, j, i1, i2, nf, vc, ncmax, bound;
+    integer i__, j, i1 = 0, i2, nf, vc, ncmax, bound;
     --iv;
     --v;
 
-    ++execnt;
     iv[28] = 171;
     iv[2] = d__;
     iv[3] = n;
@@ -2569,8 +2668,6 @@ static void lowesd_(integer *iv, integer *liv, integer *lv, double *v,
 } /* lowesd_ */
 
 static void lowese_(integer *iv, integer *liv, integer *lv, double *wv, integer m, double *z, double *s) {
-    static integer execnt = 0;
-    ++execnt;
     --iv;
     --wv;
 
@@ -2584,9 +2681,8 @@ static void lowese_(integer *iv, integer *liv, integer *lv, double *wv, integer
 
 static void lowesf_(double *xx, double *yy, double *ww, integer *iv, integer *liv, 
         integer *lv, double *wv, integer *m, double *z__, double *l, integer ihat, double *s) {
-    static integer execnt = 0;
     integer l_dim1, l_offset, z_dim1, z_offset;
-    static logical i1;
+    logical i1;
     --xx;
     --yy;
     --ww;
@@ -2597,7 +2693,6 @@ static void lowesf_(double *xx, double *yy, double *ww, integer *iv, integer *li
     z_dim1 = *m;
     z__ -= z_offset = 1 + z_dim1;
 
-    ++execnt;
     i1 = (171 <= iv[28])
           ? iv[28] <= 174
 	      : FALSE_;
@@ -2612,7 +2707,6 @@ static void lowesf_(double *xx, double *yy, double *ww, integer *iv, integer *li
 } /* lowesf_ */
 
 static void lowesl_(integer *iv, integer *liv, integer *lv, double *wv, integer *m, double *z__, double *l) {
-    static integer execnt = 0;
     integer l_dim1, l_offset, z_dim1, z_offset;
 
     --iv;
@@ -2622,7 +2716,6 @@ static void lowesl_(integer *iv, integer *liv, integer *lv, double *wv, integer
     z_dim1 = *m;
     z__ -= z_offset = 1 + z_dim1;
 
-    ++execnt;
     if (! (iv[28] != 172))
         loess_error(172);
     if (! (iv[28] == 173))
@@ -2635,12 +2728,11 @@ static void lowesl_(integer *iv, integer *liv, integer *lv, double *wv, integer
 } /* lowesl_ */
 
 static void lowesw_(double *res, integer *n, double *rw, integer *pi) {
-    static integer i1, nh, execnt = 0, identi;
-    static double cmad, rsmall;
+    integer i1, nh, identi;
+    double cmad, rsmall;
     --pi;
     --rw;
     --res;
-    ++execnt;
 /*     tranliterated from Devlin's ratfor */
 /*     find median of absolute residuals */
     for (i1 = 1; i1 <= *n; ++i1)
@@ -2671,8 +2763,8 @@ static void lowesw_(double *res, integer *n, double *rw, integer *pi) {
 
 static void pseudovals(integer n, double *y, double *yhat, double *pwgts,  //formerly lowesp
                 double *rwgts, integer *pi, double *ytilde) {
-    static integer m, i5, identi, execnt = 0;
-    static double i4, mad;
+    integer m, i5, identi;
+    double i4, mad;
 
     --ytilde;
     --pi;
@@ -2681,7 +2773,6 @@ static void pseudovals(integer n, double *y, double *yhat, double *pwgts,  //for
     --yhat;
     --y;
 
-    ++execnt;
     /*     median absolute deviation */
     for (i5 = 1; i5 <= n; ++i5)
         ytilde[i5] = abs(y[i5] - yhat[i5]) * sqrt(pwgts[i5]);
@@ -2712,55 +2803,57 @@ static void pseudovals(integer n, double *y, double *yhat, double *pwgts,  //for
 }
 
 ////// Back to loessc.c
-static void loess_workspace(long D, long N, double	span, long degree,
+static void loess_workspace(loess_work *ws, long D, long N, double	span, long degree,
 			long *nonparametric, long *drop_square, long *sum_drop_sqr, long setLf){
 	long tau0, nvmax, nf, i;
 	nvmax = max(200, N);
         nf = min(N, floor(N * span));
         tau0 = (degree > 1) ? ((D + 2) * (D + 1) * 0.5) : (D + 1);
-        tau = tau0 - (*sum_drop_sqr);
-        lv = 50 + (3 * D + 3) * nvmax + N + (tau0 + 2) * nf;
-	liv = 50 + ((long)pow((double)2, (double)D) + 4) * nvmax + 2 * N;
+        ws->tau = tau0 - (*sum_drop_sqr);
+        ws->lv = 50 + (3 * D + 3) * nvmax + N + (tau0 + 2) * nf;
+	ws->liv = 50 + ((long)pow((double)2, (double)D) + 4) * nvmax + 2 * N;
 	if(setLf) {
-		lv = lv + (D + 1) * nf * nvmax;
-		liv = liv + nf * nvmax;	
+		ws->lv = ws->lv + (D + 1) * nf * nvmax;
+		ws->liv = ws->liv + nf * nvmax;	
 	}
-    iv = Calloc(liv, long);
-    v = Calloc(lv, double);
+    ws->iv = Calloc(ws->liv, long);
+    ws->v = Calloc(ws->lv, double);
 
-    lowesd_(iv, &liv, &lv, v, D, N, span, degree, &nvmax, &setLf);
-    iv[32] = *nonparametric;
+    lowesd_(ws->iv, &ws->liv, &ws->lv, ws->v, D, N, span, degree, &nvmax, &setLf);
+    ws->iv[32] = *nonparametric;
     for(i = 0; i < D; i++)
-        iv[i + 40] = drop_square[i];
+        ws->iv[i + 40] = drop_square[i];
 }
 
-static void loess_free() {
-    free(v);
-    free(iv);
+static void loess_free(loess_work *ws) {
+    free(ws->v);
+    free(ws->iv);
 }
 
 static void loess_dfit( double	*y, double *x, double *x_evaluate, double *weights,
 			double span, long degree, long *nonparametric, long *drop_square,
 			long *sum_drop_sqr, long d, long n, long *m, double *fit) {
-    loess_workspace(d, n, span, degree, nonparametric, drop_square, sum_drop_sqr, 0);
-	lowesf_(x, y, weights, iv, &liv, &lv, v, m, x_evaluate, &doublepluszero, 0, fit);
-	loess_free();
+    loess_work ws;
+    loess_workspace(&ws, d, n, span, degree, nonparametric, drop_square, sum_drop_sqr, 0);
+	lowesf_(x, y, weights, ws.iv, &ws.liv, &ws.lv, ws.v, m, x_evaluate, &doublepluszero, 0, fit);
+	loess_free(&ws);
 }
 
 static void loess_dfitse( double	*y, double *x, double *x_evaluate, double *weights, double *robust,
         int	family, double span, long degree, long *nonparametric, long *drop_square,
          long *sum_drop_sqr, long d, long n, long *m, double *fit, double *L) {
-    loess_workspace(d, n, span, degree, nonparametric, drop_square, sum_drop_sqr, 0);
+    loess_work ws;
+    loess_workspace(&ws, d, n, span, degree, nonparametric, drop_square, sum_drop_sqr, 0);
 	if(family == GAUSSIAN)
-		lowesf_(x, y, weights, iv, &liv, &lv, v, m, x_evaluate, L, 2, fit);
+		lowesf_(x, y, weights, ws.iv, &ws.liv, &ws.lv, ws.v, m, x_evaluate, L, 2, fit);
 	else if(family == SYMMETRIC) {
-		lowesf_(x, y, weights, iv, &liv, &lv, v, m, x_evaluate, L, 2, fit);
-		lowesf_(x, y, robust, iv, &liv, &lv, v, m, x_evaluate, &doublepluszero, 0, fit);
+		lowesf_(x, y, weights, ws.iv, &ws.liv, &ws.lv, ws.v, m, x_evaluate, L, 2, fit);
+		lowesf_(x, y, robust, ws.iv, &ws.liv, &ws.lv, ws.v, m, x_evaluate, &doublepluszero, 0, fit);
 	}	
-	loess_free();
+	loess_free(&ws);
 }
 
-static void loess_grow(long	const * restrict parameter,long const*restrict a,
+static void loess_grow(loess_work *ws, long	const * restrict parameter,long const*restrict a,
                        double	const *restrict xi, double const *restrict vert, 
                        const double *restrict vval) {
 	long	d, vc, nc, nv, a1, v1, xi1, vv1, i, k;
@@ -2768,92 +2861,160 @@ static void loess_grow(long	const * restrict parameter,long const*restrict a,
 	vc = parameter[2];
 	nc = parameter[3];
 	nv = parameter[4];
-	liv = parameter[5];
-	lv = parameter[6];
-	iv = Calloc(liv, long);
-	v = Calloc(lv, double);
-
-	iv[1] = d;
-	iv[2] = parameter[1];
-	iv[3] = vc;
-	iv[5] = iv[13] = nv;
-	iv[4] = iv[16] = nc;
-	iv[6] = 50;
-	iv[7] = iv[6] + nc;
-	iv[8] = iv[7] + vc * nc;
-	iv[9] = iv[8] + nc;
-	iv[10] = 50;
-	iv[12] = iv[10] + nv * d;
-	iv[11] = iv[12] + (d + 1) * nv;
-	iv[27] = 173;
-
-	v1 = iv[10] - 1;
-	xi1 = iv[11] - 1;
-	a1 = iv[6] - 1;
-	vv1 = iv[12] - 1;
+	ws->liv = parameter[5];
+	ws->lv = parameter[6];
+	ws->iv = Calloc(ws->liv, long);
+	ws->v = Calloc(ws->lv, double);
+
+	ws->iv[1] = d;
+	ws->iv[2] = parameter[1];
+	ws->iv[3] = vc;
+	ws->iv[5] = ws->iv[13] = nv;
+	ws->iv[4] = ws->iv[16] = nc;
+	ws->iv[6] = 50;
+	ws->iv[7] = ws->iv[6] + nc;
+	ws->iv[8] = ws->iv[7] + vc * nc;
+	ws->iv[9] = ws->iv[8] + nc;
+	ws->iv[10] = 50;
+	ws->iv[12] = ws->iv[10] + nv * d;
+	ws->iv[11] = ws->iv[12] + (d + 1) * nv;
+	ws->iv[27] = 173;
+
+	v1 = ws->iv[10] - 1;
+	xi1 = ws->iv[11] - 1;
+	a1 = ws->iv[6] - 1;
+	vv1 = ws->iv[12] - 1;
 	
     for(i = 0; i < d; i++) {
 		k = nv * i;
-		v[v1 + k] = vert[i];
-		v[v1 + vc - 1 + k] = vert[i + d];
+		ws->v[v1 + k] = vert[i];
+		ws->v[v1 + vc - 1 + k] = vert[i + d];
 	}
     for(i = 0; i < nc; i++) {
-            v[xi1 + i] = xi[i];
-            iv[a1 + i] = a[i];
+            ws->v[xi1 + i] = xi[i];
+            ws->iv[a1 + i] = a[i];
     }
 	k = (d + 1) * nv;
 	for(i = 0; i < k; i++)
-		v[vv1 + i] = vval[i];
-	ehg169_(d, &vc, &nc, &nc, &nv, nv, v+v1, iv+a1, v+xi1, iv+iv[7]-1, iv+iv[8]-1, iv+iv[9]-1);
+		ws->v[vv1 + i] = vval[i];
+	ehg169_(d, &vc, &nc, &nc, &nv, nv, ws->v+v1, ws->iv+a1, ws->v+xi1, ws->iv+ws->iv[7]-1, ws->iv+ws->iv[8]-1, ws->iv+ws->iv[9]-1);
 }
 
 static void loess_ifit(long const * restrict parameter, long const *restrict a, 
                 double const *restrict xi, double const *restrict vert,
                  const double *restrict vval, long m, double *x_evaluate, double *fit) {
-	loess_grow(parameter, a, xi, vert, vval);
-	lowese_(iv, &liv, &lv, v, m, x_evaluate, fit);
-	loess_free();
+    loess_work ws;
+	loess_grow(&ws, parameter, a, xi, vert, vval);
+	lowese_(ws.iv, &ws.liv, &ws.lv, ws.v, m, x_evaluate, fit);
+	loess_free(&ws);
 }
 
 static void loess_ise( double	*y, double *x, double *x_evaluate, double *weights, double span, long degree,
              long int *nonparametric, long int *drop_square, long int *sum_drop_sqr, double *cell, long int d,
              long int n, long int *m, double *fit, double *L) {
-    loess_workspace(d, n, span, degree, nonparametric, drop_square, sum_drop_sqr, 1);
-	v[1] = *cell;
-	lowesb_(x, y, weights, &doublepluszero, 0, iv, &liv, &lv, v);
-	lowesl_(iv, &liv, &lv, v, m, x_evaluate, L);
-	loess_free();
+    loess_work ws;
+    loess_workspace(&ws, d, n, span, degree, nonparametric, drop_square, sum_drop_sqr, 1);
+	ws.v[1] = *cell;
+	lowesb_(x, y, weights, &doublepluszero, 0, ws.iv, &ws.liv, &ws.lv, ws.v);
+	lowesl_(ws.iv, &ws.liv, &ws.lv, ws.v, m, x_evaluate, L);
+	loess_free(&ws);
 }
 
-static void loess_prune( long	*parameter, long *a, double	*xi, double *vert, double *vval) {
+static void loess_prune(loess_work *ws, long	*parameter, long *a, double	*xi, double *vert, double *vval) {
 	long	d, vc, a1, v1, xi1, vv1, nc, nv, nvmax, i, k;
-	d = iv[1];
-	vc = iv[3] - 1;
-	nc = iv[4];
-	nv = iv[5];
-	a1 = iv[6] - 1;
-	v1 = iv[10] - 1;
-	xi1 = iv[11] - 1;
-	vv1 = iv[12] - 1;
-	nvmax = iv[13];
+	d = ws->iv[1];
+	vc = ws->iv[3] - 1;
+	nc = ws->iv[4];
+	nv = ws->iv[5];
+	a1 = ws->iv[6] - 1;
+	v1 = ws->iv[10] - 1;
+	xi1 = ws->iv[11] - 1;
+	vv1 = ws->iv[12] - 1;
+	nvmax = ws->iv[13];
 
 	for(i = 0; i < 5; i++)
-		parameter[i] = iv[i + 1];
-	parameter[5] = iv[21] - 1;
-	parameter[6] = iv[14] - 1;
+		parameter[i] = ws->iv[i + 1];
+	parameter[5] = ws->iv[21] - 1;
+	parameter[6] = ws->iv[14] - 1;
 
 	for(i = 0; i < d; i++){
 		k = nvmax * i;
-		vert[i] = v[v1 + k];
-		vert[i + d] = v[v1 + vc + k];
+		vert[i] = ws->v[v1 + k];
+		vert[i + d] = ws->v[v1 + vc + k];
 	}
 	for(i = 0; i < nc; i++) {
-		xi[i] = v[xi1 + i];
-		a[i] = iv[a1 + i];
+		xi[i] = ws->v[xi1 + i];
+		a[i] = ws->iv[a1 + i];
 	}
 	k = (d + 1) * nv;
 	for(i = 0; i < k; i++)
-		vval[i] = v[vv1 + i];
+		vval[i] = ws->v[vv1 + i];
+}
+
+/* Prediction from an interpolated surface needs only the k-d tree and the fits at its
+   vertices. loess() keeps them here, with the cells already rebuilt by loess_grow, so
+   a prediction walks the tree and blends vertex values (ehg128_) for each point, with
+   no copy of the data and no rebuild per call. The points are split across threads. */
+struct loess_kd_eval {
+    loess_work ws;
+    long d, order[8];
+    double divisor[8];
+};
+
+static struct loess_kd_eval *loess_kd_compile(struct loess_struct const *lo){
+    long D = lo->in.p, j = D - 1, nonparametric = 0;
+    struct loess_kd_eval *out = malloc(sizeof(struct loess_kd_eval));
+    out->d = D;
+	for(long i = 0; i < D; i++) {
+		if(lo->model.parametric[i])
+			out->order[j--] = i;
+		else
+			out->order[nonparametric++] = i;
+        out->divisor[i] = lo->out.divisor[i];
+	}
+	loess_grow(&out->ws, lo->kd_tree.parameter, lo->kd_tree.a, lo->kd_tree.xi, 
+                        lo->kd_tree.vert, lo->kd_tree.vval);
+    return out;
+}
+
+static void loess_kd_free(struct loess_kd_eval *e){
+    if (!e) return;
+    loess_free(&e->ws);
+    free(e);
+}
+
+typedef struct {
+    struct loess_kd_eval const *e;
+    long m, first, last;
+    double const *x;
+    double *fit;
+} loess_kd_args;
+
+static void *loess_kd_thread(void *in){
+    loess_kd_args *a = in;
+    long *iv = a->e->ws.iv - 1; //FORTRAN indexing, as in lowese_.
+    double *v = a->e->ws.v - 1, z[8];
+    for (long i = a->first; i < a->last; i++){
+        for (long k = 0; k < a->e->d; k++)
+            z[k] = a->x[i + a->e->order[k] * a->m] / a->e->divisor[a->e->order[k]];
+        a->fit[i] = ehg128_(z, &iv[2], &iv[17], &iv[4], &iv[iv[7]], &v[iv[12]], &iv[iv[10]],
+                            &iv[iv[9]], &iv[iv[8]], &v[iv[11]], &iv[14], &v[iv[13]]);
+    }
+    return NULL;
+}
+
+//x is m x d, column-major and unnormalized, as handed to predict().
+static void loess_kd_predict(struct loess_kd_eval const *e, long m, double const *x, double *fit){
+    int threadct = GSL_MAX(1, GSL_MIN(apop_opts.thread_count, m/5e3));
+    loess_kd_args args[threadct];
+    pthread_t thread_id[threadct];
+    for (int i=0; i< threadct; i++){
+        args[i] = (loess_kd_args){.e=e, .m=m, .x=x, .fit=fit,
+                            .first=m*i/threadct, .last=m*(i+1)/threadct};
+        if (i) pthread_create(&thread_id[i], NULL, loess_kd_thread, args+i);
+    }
+    loess_kd_thread(args);
+    for (int i=1; i< threadct; i++) pthread_join(thread_id[i], NULL);
 }
 
 ////// predict.c
@@ -2872,7 +3033,16 @@ void predict(double  *new_x, long M, struct loess_struct *lo, struct pred_struct
     long N = lo->in.n;
             
 	int     i, j, k, p;
-	double x[N * D], x_tmp[N * D], x_evaluate[M * D];
+	pre->residual_scale = lo->out.s;
+	pre->df = (lo->out.one_delta * lo->out.one_delta) / lo->out.two_delta;
+    pre->fit = malloc(M * sizeof(double));
+    if (lo->kd_tree.eval){
+        loess_kd_predict(lo->kd_tree.eval, M, new_x, pre->fit);
+        if (!want_cov) return;
+    }
+
+	double *x = malloc(N * D * sizeof(double)), *x_tmp = malloc(N * D * sizeof(double)),
+           *x_evaluate = malloc(M * D * sizeof(double)), *robust = malloc(N * sizeof(double));
 
 	for(i = 0; i < D; i++) {
 		k = i * M;
@@ -2912,28 +3082,27 @@ void predict(double  *new_x, long M, struct loess_struct *lo, struct pred_struct
         for(j = 0; j < N; j++)
             x[k + j] = x_tmp[p + j];
     }
-	for(i = 0; i < N; i++)
-		lo->out.robust[i] *= lo->in.weights[i];
+	for(i = 0; i < N; i++) //a local copy, so the model is left as is.
+		robust[i] = lo->out.robust[i] * lo->in.weights[i];
 
-    pre->fit = malloc(M * sizeof(double));
-	pre->residual_scale = lo->out.s;
-	pre->df = (lo->out.one_delta * lo->out.one_delta) / lo->out.two_delta;
-    double L[N * M];
+    double *L = want_cov ? malloc(N * M * sizeof(double)) : NULL;
 	if(!strcmp(lo->control.surface, "direct")) {
         if(want_cov)
-            loess_dfitse(lo->in.y, x, x_evaluate, lo->in.weights, lo->out.robust, !strcmp(lo->model.family, "gaussian"), 
+            loess_dfitse(lo->in.y, x, x_evaluate, lo->in.weights, robust, !strcmp(lo->model.family, "gaussian"), 
                 lo->model.span, lo->model.degree, &nonparametric, order_drop_sqr, &sum_drop_sqr, D, N, &M, pre->fit, L);
         else
-            loess_dfit(lo->in.y, x, x_evaluate, lo->out.robust, lo->model.span, lo->model.degree, &nonparametric,
+            loess_dfit(lo->in.y, x, x_evaluate, robust, lo->model.span, lo->model.degree, &nonparametric,
                 order_drop_sqr, &sum_drop_sqr, D, N, &M, pre->fit);
     } else {
-        loess_ifit(lo->kd_tree.parameter, lo->kd_tree.a, lo->kd_tree.xi, lo->kd_tree.vert, 
-                        lo->kd_tree.vval, M, x_evaluate, pre->fit);
+        if (!lo->kd_tree.eval)
+            loess_ifit(lo->kd_tree.parameter, lo->kd_tree.a, lo->kd_tree.xi, lo->kd_tree.vert, 
+                            lo->kd_tree.vval, M, x_evaluate, pre->fit);
         if(want_cov) {
             double new_cell = lo->model.span * lo->control.cell;
-            double fit_tmp[M];
+            double *fit_tmp = malloc(M * sizeof(double));
             loess_ise(lo->in.y, x, x_evaluate, lo->in.weights, lo->model.span, lo->model.degree, &nonparametric, 
                     order_drop_sqr, &sum_drop_sqr, &new_cell, D, N, &M, fit_tmp, L);
+            free(fit_tmp);
         }
     }
 	if (want_cov) {
@@ -2953,6 +3122,7 @@ void predict(double  *new_x, long M, struct loess_struct *lo, struct pred_struct
 			pre->se_fit[i] = lo->out.s * sqrt(tmp);
 		}
 	}
+    free(x); free(x_tmp); free(x_evaluate); free(robust); free(L);
 }
 
 void pred_free_mem(struct	pred_struct	*pre){
@@ -2961,7 +3131,6 @@ void pred_free_mem(struct	pred_struct	*pre){
 }
 
  ///// loess.c
-static  char    *surf_stat;
 
 int comp(const void *d1_in, const void *d2_in) {
     const double *d1 = d1_in;
@@ -2974,28 +3143,29 @@ int comp(const void *d1_in, const void *d2_in) {
                 return(1);
 }
 
-static void condition(char	**surface, char *new_stat, char **trace_hat_in) {
+static char *condition(char	**surface, char *new_stat, char **trace_hat_in) {
 	if(!strcmp(*surface, "interpolate")) {
 		if(!strcmp(new_stat, "none"))
-			surf_stat = "interpolate/none";
+			return "interpolate/none";
 		else if(!strcmp(new_stat, "exact"))
-			surf_stat = "interpolate/exact";
+			return "interpolate/exact";
 		else if(!strcmp(new_stat, "approximate"))
 		{
 			if(!strcmp(*trace_hat_in, "approximate"))
-				surf_stat = "interpolate/2.approx";
+				return "interpolate/2.approx";
 			else if(!strcmp(*trace_hat_in, "exact"))
-				surf_stat = "interpolate/1.approx";
+				return "interpolate/1.approx";
 		}
 	}
 	else if(!strcmp(*surface, "direct")) {
 		if(!strcmp(new_stat, "none"))
-			surf_stat = "direct/none";
+			return "direct/none";
 		else if(!strcmp(new_stat, "exact"))
-			surf_stat = "direct/exact";
+			return "direct/exact";
 		else if(!strcmp(new_stat, "approximate"))
-			surf_stat = "direct/approximate";
+			return "direct/approximate";
 	}
+    return NULL;
 }
 
 static void loess_raw( double	*y, double *x, double *weights, double *robust, long	*d, 
@@ -3003,56 +3173,57 @@ static void loess_raw( double	*y, double *x, double *weights, double *robust, lo
             long *sum_drop_sqr, double *cell, char	**surf_stat, double *surface, long	*parameter, 
             long *a, double *xi, double *vert, double	*vval,double *diagonal, double*trL, 
             double*one_delta, double*two_delta, long *setLf) {
+    loess_work ws;
 	long nsing, i, k;
 	double	*hat_matrix, *LL;
 	*trL = 0;
-	loess_workspace(*d, *n, *span, *degree, nonparametric, drop_square, sum_drop_sqr, *setLf);
-        v[1] = *cell;
+	loess_workspace(&ws, *d, *n, *span, *degree, nonparametric, drop_square, sum_drop_sqr, *setLf);
+        ws.v[1] = *cell;
 	if(!strcmp(*surf_stat, "interpolate/none")) {
-		lowesb_(x, y, robust, &doublepluszero, 0, iv, &liv, &lv, v);
-		lowese_(iv, &liv, &lv, v, *n, x, surface);
-		loess_prune(parameter, a, xi, vert, vval);
+		lowesb_(x, y, robust, &doublepluszero, 0, ws.iv, &ws.liv, &ws.lv, ws.v);
+		lowese_(ws.iv, &ws.liv, &ws.lv, ws.v, *n, x, surface);
+		loess_prune(&ws, parameter, a, xi, vert, vval);
 	}			
 	else if (!strcmp(*surf_stat, "direct/none"))
-		lowesf_(x, y, robust, iv, &liv, &lv, v, n, x, &doublepluszero, 0, surface);
+		lowesf_(x, y, robust, ws.iv, &ws.liv, &ws.lv, ws.v, n, x, &doublepluszero, 0, surface);
 	else if (!strcmp(*surf_stat, "interpolate/1.approx")) {
-		lowesb_(x, y, weights, diagonal, 1, iv, &liv, &lv, v);
-		lowese_(iv, &liv, &lv, v, *n, x, surface);
-		nsing = iv[29];
+		lowesb_(x, y, weights, diagonal, 1, ws.iv, &ws.liv, &ws.lv, ws.v);
+		lowese_(ws.iv, &ws.liv, &ws.lv, ws.v, *n, x, surface);
+		nsing = ws.iv[29];
 		for(i = 0; i < *n; i++) *trL = *trL + diagonal[i];
-		lowesa_(trL, n, d, &tau, &nsing, one_delta, two_delta);
-		loess_prune(parameter, a, xi, vert, vval);
+		lowesa_(trL, n, d, &ws.tau, &nsing, one_delta, two_delta);
+		loess_prune(&ws, parameter, a, xi, vert, vval);
 	}
     else if (!strcmp(*surf_stat, "interpolate/2.approx")) {
-		lowesb_(x, y, robust, &doublepluszero, 0, iv, &liv, &lv, v);
-		lowese_(iv, &liv, &lv, v, *n, x, surface);
-		nsing = iv[29];
-		ehg196_(tau, *d, *span, trL);
-		lowesa_(trL, n, d, &tau, &nsing, one_delta, two_delta);
-		loess_prune(parameter, a, xi, vert, vval);
+		lowesb_(x, y, robust, &doublepluszero, 0, ws.iv, &ws.liv, &ws.lv, ws.v);
+		lowese_(ws.iv, &ws.liv, &ws.lv, ws.v, *n, x, surface);
+		nsing = ws.iv[29];
+		ehg196_(ws.tau, *d, *span, trL);
+		lowesa_(trL, n, d, &ws.tau, &nsing, one_delta, two_delta);
+		loess_prune(&ws, parameter, a, xi, vert, vval);
 	}
 	else if (!strcmp(*surf_stat, "direct/approximate")) {
-		lowesf_(x, y, weights, iv, &liv, &lv, v, n, x, diagonal, 1, surface);
-		nsing = iv[29];
+		lowesf_(x, y, weights, ws.iv, &ws.liv, &ws.lv, ws.v, n, x, diagonal, 1, surface);
+		nsing = ws.iv[29];
 		for(i = 0; i < (*n); i++) *trL = *trL + diagonal[i];
-		lowesa_(trL, n, d, &tau, &nsing, one_delta, two_delta);
+		lowesa_(trL, n, d, &ws.tau, &nsing, one_delta, two_delta);
 	}
 	else if (!strcmp(*surf_stat, "interpolate/exact")) {
 		hat_matrix = Calloc((*n)*(*n), double);
 		LL = Calloc((*n)*(*n), double);
-		lowesb_(x, y, weights, diagonal, 1, iv, &liv, &lv, v);
-		lowesl_(iv, &liv, &lv, v, n, x, hat_matrix);
+		lowesb_(x, y, weights, diagonal, 1, ws.iv, &ws.liv, &ws.lv, ws.v);
+		lowesl_(ws.iv, &ws.liv, &ws.lv, ws.v, n, x, hat_matrix);
 		lowesc_(n, hat_matrix, LL, trL, one_delta, two_delta);
-		lowese_(iv, &liv, &lv, v, *n, x, surface);
-		loess_prune(parameter, a, xi, vert, vval);
+		lowese_(ws.iv, &ws.liv, &ws.lv, ws.v, *n, x, surface);
+		loess_prune(&ws, parameter, a, xi, vert, vval);
 		free(hat_matrix);
 		free(LL);
 	}
 	else if (!strcmp(*surf_stat, "direct/exact")) {
 		hat_matrix = Calloc((*n)*(*n), double);
 		LL = Calloc((*n)*(*n), double);
-		//lowesf_(x, y, weights, iv, liv, lv, v, n, x, hat_matrix, &two, surface);//seems wrong.
-		lowesf_(x, y, weights, iv, &liv, &lv, v, n, x, hat_matrix, 2, surface);
+		//lowesf_(x, y, weights, ws.iv, ws.liv, ws.lv, ws.v, n, x, hat_matrix, &two, surface);//seems wrong.
+		lowesf_(x, y, weights, ws.iv, &ws.liv, &ws.lv, ws.v, n, x, hat_matrix, 2, surface);
 		lowesc_(n, hat_matrix, LL, trL, one_delta, two_delta);
         k = (*n) + 1;
 		for(i = 0; i < (*n); i++)
@@ -3060,7 +3231,7 @@ static void loess_raw( double	*y, double *x, double *weights, double *robust, lo
 		free(hat_matrix);
 		free(LL);
 	}
-	loess_free();
+	loess_free(&ws);
 }
 
 static void loess_(double *y, double *x_, long *size_info, double *weights,
@@ -3075,17 +3246,36 @@ static void loess_(double *y, double *x_, long *size_info, double *weights,
                 trL_tmp = 0, d1_tmp = 0, d2_tmp = 0, sum, mean;
 	long	i, j, k, p, N, D, sum_drop_sqr = 0, sum_parametric = 0, setLf,	
                 nonparametric = 0, zero = 0, max_kd;
-	char   *new_stat;
+	char   *new_stat, *surf_stat = NULL;
 
 	D = size_info[0];
 	N = size_info[1];
 	max_kd = (N > 200 ? N : 200);
 	*one_delta = *two_delta = *trace_hat_out = 0;
 
-	double x[D * N], x_tmp[D*N], temp[N], xi_tmp[max_kd], vert_tmp[D * 2], 
-                vval_tmp[(D + 1) * max_kd], diag_tmp[N];
-	long a_tmp[max_kd], param_tmp[N], order_parametric[D], order_drop_sqr[D];
-    integer int_temp[N];//original code sent double, but lowesw & lowesp want an int
+	long order_parametric[D], order_drop_sqr[D];
+	j = D - 1;
+	for(i = 0; i < D; i++) {
+		sum_drop_sqr = sum_drop_sqr + drop_square[i];
+		sum_parametric = sum_parametric + parametric[i];
+		if(parametric[i])
+			order_parametric[j--] = i;
+		else
+			order_parametric[nonparametric++] = i;
+	}
+    Apop_assert_n(!((*degree) == 1 && sum_drop_sqr), 
+                "Specified the square of a factor predictor to be dropped when degree = 1");
+	Apop_assert_n(!(D == 1 && sum_drop_sqr), 
+                "Specified the square of a predictor to be dropped with only one numeric predictor");
+	Apop_assert_n(sum_parametric != D, "Specified parametric for all predictors");
+
+    //These grow with N, so they go on the heap, not on what may be a small thread stack.
+	double *x = malloc(D * N * sizeof(double)), *x_tmp = malloc(D * N * sizeof(double)),
+           *temp = malloc(N * sizeof(double)), *xi_tmp = malloc(max_kd * sizeof(double)),
+           *vert_tmp = malloc(D * 2 * sizeof(double)), *vval_tmp = malloc((D + 1) * max_kd * sizeof(double)),
+           *diag_tmp = malloc(N * sizeof(double));
+	long *a_tmp = malloc(max_kd * sizeof(long)), *param_tmp = malloc(N * sizeof(long));
+    integer *int_temp = malloc(N * sizeof(integer));//original code sent double, but lowesw & lowesp want an int
 
     if((*iterations) > 0)
         pseudo_resid =  malloc(N * sizeof(double));
@@ -3120,15 +3310,6 @@ static void loess_(double *y, double *x_, long *size_info, double *weights,
 	}
 	else
 		for(i = 0; i < D; i++) divisor[i] = 1;
-	j = D - 1;
-	for(i = 0; i < D; i++) {
-		sum_drop_sqr = sum_drop_sqr + drop_square[i];
-		sum_parametric = sum_parametric + parametric[i];
-		if(parametric[i])
-			order_parametric[j--] = i;
-		else
-			order_parametric[nonparametric++] = i;
-	}
     for(i = 0; i < D; i++) {
         order_drop_sqr[i] = 2 - drop_square[order_parametric[i]];
         k = i * N;
@@ -3136,16 +3317,11 @@ static void loess_(double *y, double *x_, long *size_info, double *weights,
         for(j = 0; j < N; j++)
             x[k + j] = x_tmp[p + j];
     }
-    Apop_assert_n(!((*degree) == 1 && sum_drop_sqr), 
-                "Specified the square of a factor predictor to be dropped when degree = 1");
-	Apop_assert_n(!(D == 1 && sum_drop_sqr), 
-                "Specified the square of a predictor to be dropped with only one numeric predictor");
-	Apop_assert_n(sum_parametric != D, "Specified parametric for all predictors");
 	for(j = 0; j <= (*iterations); j++) {
 		new_stat = j ? "none" : *statistics;
 		for(i = 0; i < N; i++)
 			robust[i] = weights[i] * robust[i];
-		condition(surface, new_stat, trace_hat_in);
+		surf_stat = condition(surface, new_stat, trace_hat_in);
 		setLf = !strcmp(surf_stat, "interpolate/exact");
 		loess_raw(y, x, weights, robust, &D, &N, span, degree, &nonparametric, order_drop_sqr, 
                 &sum_drop_sqr, &new_cell, &surf_stat, fitted_values, parameter, a,
@@ -3181,6 +3357,8 @@ static void loess_(double *y, double *x_, long *size_info, double *weights,
 
     if((*iterations) > 0)
         free(pseudo_resid);
+    free(x); free(x_tmp); free(temp); free(xi_tmp); free(vert_tmp); free(vval_tmp);
+    free(diag_tmp); free(a_tmp); free(param_tmp); free(int_temp);
 }
 
 void loess( struct	loess_struct	*lo) {
@@ -3194,6 +3372,7 @@ void loess( struct	loess_struct	*lo) {
         else
             lo->control.trace_hat = "exact";
     }
+    memset(lo->kd_tree.parameter, 0, 7 * sizeof(long));
 	loess_(lo->in.y, lo->in.x, size_info, lo->in.weights,
 		&lo->model.span,
 		&lo->model.degree,
@@ -3221,6 +3400,9 @@ void loess( struct	loess_struct	*lo) {
 		lo->kd_tree.xi,
 		lo->kd_tree.vert,
 		lo->kd_tree.vval);
+    loess_kd_free(lo->kd_tree.eval);
+    lo->kd_tree.eval = lo->kd_tree.parameter[0] //zero if no tree was built
+                        ? loess_kd_compile(lo) : NULL;
 }	
 
 void loess_free_mem(struct loess_struct *lo) {
@@ -3238,6 +3420,7 @@ void loess_free_mem(struct loess_struct *lo) {
     free(lo->kd_tree.xi);
     free(lo->kd_tree.vert);
     free(lo->kd_tree.vval);
+    loess_kd_free(lo->kd_tree.eval);
 }
 
 void loess_summary(struct loess_struct lo) {
@@ -3493,7 +3676,33 @@ void loess(struct loess_struct *lo) ;
 void loess_setup( double  *x, double *y, long n, long p, struct  loess_struct *lo) ;
 
 
-Apop_settings_copy(apop_loess, )
+static void *loess_dup(void const *in, size_t size){
+    if (!in) return NULL;
+    void *out = malloc(size);
+    memcpy(out, in, size);
+    return out;
+}
+
+//Every array in the loess_struct is freed with the settings group, so copies get their own.
+Apop_settings_copy(apop_loess,
+    struct loess_struct *lo = &out->lo_s;
+    long n = lo->in.n, p = lo->in.p, max_kd = n > 200 ? n : 200;
+    lo->in.y = loess_dup(lo->in.y, n * sizeof(double));
+    lo->in.x = loess_dup(lo->in.x, n * p * sizeof(double));
+    lo->in.weights = loess_dup(lo->in.weights, n * sizeof(double));
+    lo->out.fitted_values = loess_dup(lo->out.fitted_values, n * sizeof(double));
+    lo->out.fitted_residuals = loess_dup(lo->out.fitted_residuals, n * sizeof(double));
+    lo->out.pseudovalues = loess_dup(lo->out.pseudovalues, n * sizeof(double));
+    lo->out.diagonal = loess_dup(lo->out.diagonal, n * sizeof(double));
+    lo->out.robust = loess_dup(lo->out.robust, n * sizeof(double));
+    lo->out.divisor = loess_dup(lo->out.divisor, p * sizeof(double));
+    lo->kd_tree.parameter = loess_dup(lo->kd_tree.parameter, 7 * sizeof(long));
+    lo->kd_tree.a = loess_dup(lo->kd_tree.a, max_kd * sizeof(long));
+    lo->kd_tree.xi = loess_dup(lo->kd_tree.xi, max_kd * sizeof(double));
+    lo->kd_tree.vert = loess_dup(lo->kd_tree.vert, p * 2 * sizeof(double));
+    lo->kd_tree.vval = loess_dup(lo->kd_tree.vval, (p + 1) * max_kd * sizeof(double));
+    lo->kd_tree.eval = lo->kd_tree.eval ? loess_kd_compile(lo) : NULL;
+)
 Apop_settings_free(apop_loess, loess_free_mem(&(in->lo_s));)
 
 void matrix_to_FORTRAN(gsl_matrix *inmatrix, double *outFORTRAN, int start_col){
@@ -3551,13 +3760,9 @@ Apop_settings_init(apop_loess,
     };
     Apop_varad_set(ci_level, 0.95);
     struct loess_struct *lo = &(out->lo_s);
-    if (in.data->weights)
-        lo->in.weights = in.data->weights->data;
-    else {
-        lo->in.weights = malloc(n * sizeof(double));
-        for (int i = 0; i < n; i++) 
-            lo->in.weights[i] = 1;
-    }
+    lo->in.weights = malloc(n * sizeof(double));
+    for (int i = 0; i < n; i++) 
+        lo->in.weights[i] = in.data->weights ? gsl_vector_get(in.data->weights, i) : 1;
     int startat = 0;
     if (in.data->vector) //OK, then that's the dependent var.
         memcpy(lo->in.y, in.data->vector->data, n*sizeof(double));
@@ -3619,8 +3824,7 @@ static double loess_ll(apop_data *d, apop_model *m){
     return apop_map_sum(exp, .param=&sd, .part='r', .fn_vp= onerow);
 }
 
-static apop_model *apop_loess_est(apop_data *d, apop_model *m){
-  apop_model *out = apop_model_copy(apop_loess);
+static apop_model *apop_loess_est(apop_data *d, apop_model *out){
     if (!Apop_settings_get_group(out, apop_loess))
         Apop_model_add_group(out, apop_loess, .data=d);
     out->data = d;
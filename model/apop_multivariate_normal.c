@@ -48,6 +48,57 @@ static double apop_multinormal_ll(apop_data *data, apop_model * m){
     return ll;
 }
 
+/* With Y the data less the mean and Z = Y Sigma^{-1}, the log likelihood needs the sum of
+ the elementwise products of Y and Z; the score for the mean is the column sums of Z, and
+ for the covariance it is (Z'Z - n Sigma^{-1})/2, found via one symmetric rank-k update. */
+static double mvn_ll_and_score(apop_data *data, gsl_vector *gradient, apop_model *m){
+    Nullcheck_mpd(data, m, GSL_NAN);
+    size_t n = data->matrix->size1, k = data->matrix->size2;
+    gsl_matrix *inverse = NULL;
+    double determinant = apop_det_and_inv(m->parameters->matrix, &inverse, 1,1);
+    if (determinant == 0) { //tell maximizers to look elsewhere.
+        gsl_vector_set_zero(gradient);
+        gsl_matrix_free(inverse);
+        Apop_assert_c(0, GSL_NEGINF, 1, "the determinant of the given covariance is zero. Returning GSL_NEGINF."); 
+    }
+    apop_assert(determinant > 0, "The determinant of the covariance matrix you gave me "
+            "is negative, but a covariance matrix must always be positive semidefinite "
+            "(and so have nonnegative determinant). Maybe run apop_matrix_to_positive_semidefinite?");
+    gsl_matrix *y = apop_matrix_copy(data->matrix);
+    for (size_t i=0; i< n; i++){
+        Apop_matrix_row(y, i, yrow);
+        gsl_vector_sub(yrow, m->parameters->vector);
+    }
+    gsl_matrix *z = gsl_matrix_alloc(n, k);
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, y, inverse, 0, z);
+
+    long double quad = 0;
+    gsl_vector_view mu_score = gsl_vector_subvector(gradient, 0, k);
+    gsl_vector_set_zero(&mu_score.vector);
+    for (size_t i=0; i< n; i++){
+        double const *yrow = y->data + i*y->tda, *zrow = z->data + i*z->tda;
+        for (size_t j=0; j< k; j++){
+            quad += yrow[j]*zrow[j];
+            mu_score.vector.data[j*mu_score.vector.stride] += zrow[j];
+        }
+    }
+    gsl_vector_view sigma_part = gsl_vector_subvector(gradient, k, k*k);
+    gsl_matrix_view sigma_score = gsl_matrix_view_vector(&sigma_part.vector, k, k);
+    gsl_matrix_memcpy(&sigma_score.matrix, inverse);
+    gsl_blas_dsyrk(CblasUpper, CblasTrans, .5, z, -.5*n, &sigma_score.matrix);
+    for (size_t i=0; i< k; i++)
+        for (size_t j=i+1; j< k; j++)
+            gsl_matrix_set(&sigma_score.matrix, j, i, gsl_matrix_get(&sigma_score.matrix, i, j));
+    gsl_matrix_free(inverse);
+    gsl_matrix_free(y);
+    gsl_matrix_free(z);
+    return -quad/2 - n * (log(2 * M_PI)* k/2. + .5 * log(determinant));
+}
+
+static void mvn_dlog_likelihood(apop_data *data, gsl_vector *gradient, apop_model *m){
+    mvn_ll_and_score(data, gradient, m);
+}
+
 static double a_mean(gsl_vector * in){ return apop_vector_mean(in); }
 
 /*\adoc  estimated_parameters  Format as above. The <tt>\<Covariance\></tt> page gives
@@ -98,4 +149,5 @@ double mvn_constraint(apop_data *d, apop_model *m){
 
 apop_model apop_multivariate_normal= {"Multivariate normal distribution", -1,-1,-1, .dsize=-2,
      .estimate = multivariate_normal_estimate, .log_likelihood = apop_multinormal_ll, 
+     .score = mvn_dlog_likelihood, .log_likelihood_score = mvn_ll_and_score,
      .draw = mvnrng, .prep=mvn_prep, .constraint = mvn_constraint};
@@ -36,8 +36,6 @@ static double positive_sigma_constraint(apop_data *data, apop_model *v){
 
 //This just takes the sum of (x-mu)^2. Using gsl_ran_gaussian_pdf
 //would be to calculate log(exp((x-mu)^2)) == slow.
-static double apply_me(double x, void *mu){ return x - *(double *)mu; }
-
 static double apply_me2(double x, void *mu){ return gsl_pow_2(x - *(double *)mu); }
 
 static double normal_log_likelihood(apop_data *d, apop_model *params){
@@ -91,16 +89,26 @@ static double normal_cdf(apop_data *d, apop_model *params){
     return gsl_cdf_gaussian_P(val-mu, sd);
 }
 
-static void normal_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *params){    
-    Nullcheck_mpd(d, params, )
-    Get_vmsizes(d)
+/* The log likelihood and score both need only the sums of (x-mu) and of (x-mu)^2,
+ which one pass through the data provides. */
+static double normal_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *params){
+    Nullcheck_mpd(d, params, GSL_NAN)
+    Get_vmsizes(d) //tsize
     double mu = gsl_vector_get(params->parameters->vector,0),
-           sd = gsl_vector_get(params->parameters->vector,1),
-           dll, sll;
-    dll = apop_map_sum(d, .fn_dp = apply_me, .param=&mu);
-    sll = apop_map_sum(d, .fn_dp = apply_me2, .param=&mu);
+           sd = gsl_vector_get(params->parameters->vector,1);
+    long double dll = 0, sll = 0;
+    Apop_data_elements(d, x,
+        double dev = x - mu;
+        dll += dev;
+        sll += dev*dev;
+    )
     gsl_vector_set(gradient, 0, dll/gsl_pow_2(sd));
     gsl_vector_set(gradient, 1, sll/gsl_pow_3(sd)- tsize /sd);
+    return -sll/(2*gsl_pow_2(sd)) - tsize*(M_LNPI+M_LN2+log(sd));
+}
+
+static void normal_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *params){    
+    normal_ll_and_score(d, gradient, params);
 }
 
 /* \adoc predict Returns the mean, regardless of the input data you give (including
@@ -127,8 +135,8 @@ static void normal_rng(double *out, gsl_rng *r, apop_model *p){
 
 apop_model apop_normal = {"Normal distribution", 2, 0, 0, .dsize=1,
  .estimate = normal_estimate, .log_likelihood = normal_log_likelihood, 
- .score = normal_dlog_likelihood, .constraint = positive_sigma_constraint, 
- .draw = normal_rng, .cdf = normal_cdf, .predict = normal_predict};
+ .score = normal_dlog_likelihood, .log_likelihood_score = normal_ll_and_score,
+ .constraint = positive_sigma_constraint, .draw = normal_rng, .cdf = normal_cdf, .predict = normal_predict};
 
 
 /*\amodel apop_lognormal The Lognormal distribution
@@ -155,7 +163,7 @@ static double lognormal_log_likelihood(apop_data *d, apop_model *params){
     double sd = gsl_vector_get(params->parameters->vector, 1);
     long double ll = -apop_map_sum(d, .fn_dp=lnx_minus_mu_squared, .param=&mu);
       ll /= (2*gsl_pow_2(sd));
-      ll -= apop_map_sum(d, log, .part='m');
+      ll -= apop_map_sum(d, log);
       ll -= tsize*(M_LNPI+M_LN2+log(sd));
 	return ll;
 }
@@ -211,16 +219,25 @@ apop_data * lognormal_predict(apop_data *dummy, apop_model *m){
     return out;
 }
 
-double diff_sq(double x, void *mu){ return gsl_pow_2(log(x) - *(double*)mu); }
-
-static void lognormal_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *params){    
+//One log per element, shared by the log likelihood and both elements of the score.
+static double lognormal_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *params){
+    Nullcheck_mpd(d, params, GSL_NAN)
+    Get_vmsizes(d); //tsize
     double mu = gsl_vector_get(params->parameters->vector,0),
            sd = gsl_vector_get(params->parameters->vector,1);
-    Get_vmsizes(d); //tsize
-    double dll = apop_map_sum(d, log) - mu*tsize;
-    double sll = apop_map_sum(d, .fn_dp=diff_sq, .param=&mu);
-    gsl_vector_set(gradient, 0, dll/gsl_pow_2(sd));
+    long double lnsum = 0, sll = 0;
+    Apop_data_elements(d, x,
+        double lnx = log(x);
+        lnsum += lnx;
+        sll += gsl_pow_2(lnx - mu);
+    )
+    gsl_vector_set(gradient, 0, (lnsum - mu*tsize)/gsl_pow_2(sd));
     gsl_vector_set(gradient, 1, sll/gsl_pow_3(sd)- tsize/sd);
+    return -sll/(2*gsl_pow_2(sd)) - lnsum - tsize*(M_LNPI+M_LN2+log(sd));
+}
+
+static void lognormal_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *params){    
+    lognormal_ll_and_score(d, gradient, params);
 }
 
 /* \adoc RNG An Apophenia wrapper for the GSL's Normal RNG, exp'ed.  */
@@ -230,5 +247,6 @@ static void lognormal_rng(double *out, gsl_rng *r, apop_model *p){
 
 apop_model apop_lognormal = {"Lognormal distribution", 2, 0, 0, .dsize=1,
  .estimate = lognormal_estimate, .log_likelihood = lognormal_log_likelihood,
- .score = lognormal_dlog_likelihood, .constraint = positive_sigma_constraint, 
+ .score = lognormal_dlog_likelihood, .log_likelihood_score = lognormal_ll_and_score,
+ .constraint = positive_sigma_constraint,
  .draw = lognormal_rng, .cdf= lognormal_cdf};
@@ -11,6 +11,10 @@ Ordinary Least Squares.
 \amodel apop_ols Ordinary least squares. Weighted least squares is also handled by this model.
 You can also use it for a lot of not-entirely linear models based on the form \f$Y = f(x_1) + f(x_2) + ... + \epsilon\f$.
 
+For data too large to hold in memory, see \ref apop_ols_query, or accumulate blocks of rows yourself via \ref apop_ols_accumulate and \ref apop_ols_from_moments.
+
+With weights, I form \f$X'WX\f$ and \f$X'Wy\f$ straight from the data and the weights, scaling one small block of rows at a time, so weighted regression costs the same as unweighted, and neither the data nor the weights are copied or rescaled. (Data with a \c sparse block is still scaled in a copy.)
+
 \adoc    Input_format  See \ref dataprep.
 \adoc    Parameter_format  A vector of OLS coefficients. coeff. zero
                          refers to the constant column, if any. 
@@ -100,7 +104,8 @@ static void ols_shuffle(apop_data *d){
         gsl_vector_set_all(independent, 1);     //affine; first column is ones.
         if (d->names->colct > 0) {		
             apop_name_add(d->names, d->names->column[0], 'v');
-            sprintf(d->names->column[0], "1");
+            apop_arena_free(d->names->column[0]); //may be too short to hold "1".
+            d->names->column[0] = apop_arena_strdup(d->names, "1");
         }
     }
 }
@@ -113,116 +118,358 @@ static void ols_prep(apop_data *d, apop_model *m){
     m->prep = mpt;
 }
 
-/* The assumption that makes a log likelihood possible is that the
-errors are normally distributed.
+/* The assumption that makes a log likelihood possible is that the errors are normally
+distributed, with variance estimated from the errors themselves.
+
+One gemv (and one pass through the sparse block, if any) gives the errors e = X\beta - y.
+With their variance s^2 = sum (e-ebar)^2/(n-1),
+    LL = -n ln(2 pi s^2)/2 - sum e^2/(2 s^2)  [+ sum ln w]  [+ sum ln P(x)],
+and because s^2 is also a function of \beta, the score is
+    dLL/d\beta = -X'e/s^2 + (sum e^2/(2 s^4) - n/(2 s^2)) ds^2/d\beta,
+where ds^2/d\beta = 2 X'(e - ebar)/(n-1). So the score is one more gemv, X'c.
 
-This function is a bit inefficient, in that it calculates the error terms,
-which you may have already done in the OLS estimation.  */
-static double ols_log_likelihood (apop_data *d, apop_model *p){ 
+Neither the weights nor the input distribution depend on \beta. The input distribution
+is evaluated row by row, unless it's the default improper uniform, where P(x)=1. */
+static double ols_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *p){
     Nullcheck_mpd(d, p, GSL_NAN); Nullcheck(d->matrix, GSL_NAN);
-  long double ll  = 0; 
-  long double sigma, actual, weight;
-  double expected, x_prob;
-  apop_lm_settings *lms = Apop_settings_get_group(p, apop_lm);
-  apop_model *input_distribution = lms ? lms->input_distribution : NULL;
-  gsl_matrix *data	 = d->matrix;
-  gsl_vector *errors = gsl_vector_alloc(data->size1);
-	for (size_t i=0;i< data->size1; i++){
-        Apop_row(d, i, datarow);
-        gsl_blas_ddot(p->parameters->vector, datarow, &expected);
-        if (d->vector){ //then this has been prepped
-            actual    = apop_data_get(d,i, -1);
-        } else {
-            actual    = gsl_matrix_get(data,i, 0);
-            expected += gsl_vector_get(p->parameters->vector,0) * (1 - actual); //data isn't affine.
+    apop_lm_settings *lms = Apop_settings_get_group(p, apop_lm);
+    apop_model *input_distribution = lms ? lms->input_distribution : NULL;
+    gsl_matrix *data = d->matrix;
+    gsl_vector *beta = p->parameters->vector;
+    size_t n = data->size1;
+    gsl_vector *errors = gsl_vector_alloc(n);
+    gsl_vector_view bm = gsl_vector_subvector(beta, 0, data->size2);
+    gsl_blas_dgemv(CblasNoTrans, 1, data, &bm.vector, 0, errors);      // X\beta
+    if (d->sparse){
+        gsl_vector_view bs = gsl_vector_subvector(beta, data->size2, d->sparse->size2);
+        apop_sparse_mv(d->sparse, &bs.vector, errors);
+    }
+    Apop_matrix_col(data, 0, firstcol);
+    if (d->vector) gsl_vector_sub(errors, d->vector);                    // X\beta - y
+    else { //not prepped: column zero is y, standing in for the constant column.
+        double b0 = gsl_vector_get(beta, 0);
+        for (size_t i=0; i< n; i++){
+            double y = gsl_vector_get(firstcol, i);
+            *gsl_vector_ptr(errors, i) += b0*(1 - y) - y;
+        }
+    }
+    long double sum = 0, sumsq = 0, ssdev = 0;
+    for (size_t i=0; i< n; i++){
+        double e = gsl_vector_get(errors, i);
+        sum += e;
+        sumsq += e*e;
+    }
+    double ebar = sum/n;
+    for (size_t i=0; i< n; i++) ssdev += gsl_pow_2(gsl_vector_get(errors, i) - ebar);
+    double s_sq = ssdev/(n-1);
+    long double ll = -(n/2.)*log(2*M_PI*s_sq) - sumsq/(2*s_sq);
+
+    if (d->weights)
+        for (size_t i=0; i< n; i++) ll += log(gsl_vector_get(d->weights, i));
+    if (input_distribution && input_distribution->p != apop_improper_uniform.p)
+        for (size_t i=0; i< n; i++){
+            Apop_row(d, i, datarow);
+            gsl_matrix_view m = gsl_matrix_view_vector(datarow, 1, datarow->size);
+            ll += log(apop_p(&(apop_data){.matrix=&(m.matrix)}, input_distribution));
+        }
+
+    if (gradient){
+        double coef = sumsq/(2*gsl_pow_2(s_sq)) - n/(2*s_sq);
+        for (size_t i=0; i< n; i++){
+            double e = gsl_vector_get(errors, i);
+            gsl_vector_set(errors, i, -e/s_sq + coef*2*(e - ebar)/(n-1));
+        }
+        gsl_vector_view gm = gsl_vector_subvector(gradient, 0, data->size2);
+        gsl_blas_dgemv(CblasTrans, 1, data, errors, 0, &gm.vector);     // X'c
+        if (d->sparse){
+            gsl_vector_view gs = gsl_vector_subvector(gradient, data->size2, d->sparse->size2);
+            gsl_vector_set_zero(&gs.vector);
+            apop_sparse_tv(d->sparse, errors, &gs.vector);
+        }
+        if (!d->vector){ //the first column of X is really all ones.
+            double c0 = 0;
+            for (size_t i=0; i< n; i++) c0 += gsl_vector_get(errors, i) * (1 - gsl_vector_get(firstcol, i));
+            *gsl_vector_ptr(gradient, 0) += c0;
         }
-        gsl_vector_set(errors, i, expected-actual);
     }
-    sigma   = sqrt(apop_vector_var(errors));
-	for(size_t i=0;i< data->size1; i++){
-        Apop_row(d, i, datarow);
-        gsl_matrix_view m = gsl_matrix_view_vector(datarow, 1, datarow->size);
-        apop_data justarow = {.matrix=&(m.matrix)};
-        if (input_distribution)
-            x_prob = apop_p(&justarow, input_distribution); //probably improper uniform, and so just 1 anyway.
-        else
-            x_prob = 1;
-        weight       = d->weights ? gsl_vector_get(d->weights, i) : 1; 
-        ll  += log(gsl_ran_gaussian_pdf(gsl_vector_get(errors, i), sigma)* weight * x_prob);
-	} 
     gsl_vector_free(errors);
     return ll;
 }
 
-/* $\partial {\cal N}(x\beta - y)/\partial \beta_i = \sum{x_i} \partial {\cal N}(K)/\partial K$ (at $K=x\beta -y$) */
-static void ols_score(apop_data *d, gsl_vector *gradient, apop_model *p){ 
-    Nullcheck_mpd(d, p, ); Nullcheck(d->matrix, );
-  long double sigma, actual, weight;
-  double expected;
-  gsl_matrix *data	= d->matrix;
-  gsl_vector *errors = gsl_vector_alloc(data->size1);
-  gsl_vector *normscore = gsl_vector_alloc(2);
-  apop_data  *subdata  = apop_data_alloc(1,1);
-	for(size_t i=0;i< data->size1; i++){
-        APOP_ROW(d, i, datarow);
-        gsl_blas_ddot(p->parameters->vector, datarow, &expected);
-        if (d->vector){ //then this has been prepped
-            actual       = apop_data_get(d,i, -1);
+static double ols_log_likelihood(apop_data *d, apop_model *p){
+    return ols_ll_and_score(d, NULL, p);
+}
+
+static void ols_score(apop_data *d, gsl_vector *gradient, apop_model *p){
+    ols_ll_and_score(d, gradient, p);
+}
+
+//Copy the upper triangle of a symmetric matrix to the lower, after dsyrk fills only the one.
+static void mirror_upper(gsl_matrix *m){
+    for (size_t i=0; i< m->size1; i++)
+        for (size_t j=i+1; j< m->size2; j++)
+            gsl_matrix_set(m, j, i, gsl_matrix_get(m, i, j));
+}
+
+/* Given (X'X)^{-1} in cov->matrix and \beta in out->parameters, find the residuals,
+   scale (X'X)^{-1} up to the covariance, and fill the <Predicted> page. If cov is NULL,
+   just do the <Predicted> page. */
+static void ols_finish(apop_data const*data, apop_data *cov, apop_model *out){
+    apop_lm_settings   *p =  apop_settings_get_group(out, apop_lm);
+    apop_parts_wanted_settings *pwant = apop_settings_get_group(out, apop_parts_wanted);
+    double s_sq;
+    gsl_vector const *y_data = data->vector; //just an alias
+    size_t k = data->matrix->size2 + (data->sparse ? data->sparse->size2 : 0);
+    if (cov) for (size_t i=0; i< cov->matrix->size1; i++) //Columns ols_solve dropped as collinear don't count.
+        k -= gsl_isnan(gsl_matrix_get(cov->matrix, i, i));
+    apop_data *error = apop_dot(data, out->parameters, .form2='v'); // X\beta ==predicted (not yet error)
+	gsl_vector_sub(error->vector, y_data);              // X'\beta - Y == error
+    if (!data->weights) gsl_blas_ddot(error->vector, error->vector, &s_sq); // e'e
+    else {                                                                   // e'We
+        s_sq = 0;
+        for (size_t i=0; i< error->vector->size; i++)
+            s_sq += gsl_vector_get(data->weights, i) * gsl_pow_2(gsl_vector_get(error->vector, i));
+    }
+    s_sq /= data->matrix->size1 - k;                    // \sigma^2 = e'e / df
+    if (cov) gsl_matrix_scale(cov->matrix, s_sq);       // cov = \sigma^2 (X'X)^{-1}
+	if ((pwant && pwant->predicted) || (!pwant && p && p->want_expected_value)){
+        gsl_matrix *predicted_page = apop_data_get_page(out->info, "<Predicted>")->matrix;
+        gsl_matrix_set_col(predicted_page, 0, y_data);
+        gsl_matrix_set_col(predicted_page, 2, error->vector);
+        Apop_matrix_col(predicted_page, 1, predicted);
+        gsl_vector_memcpy(predicted, y_data);
+        gsl_vector_add(predicted, error->vector); //pred = y_data + error
+    }
+    apop_data_free(error);
+    if (!cov) return;
+    if (apop_data_get_page(out->parameters, "<Covariance>"))
+        apop_data_rm_page(out->parameters, "<Covariance>");
+    apop_data_add_page(out->parameters, cov, "<Covariance>");
+}
+
+/* Given a column-pivoted QR decomposition of A (AP = QR) and its numerical rank, solve the
+   least-squares problem Ax=b. Columns past the rank get a coefficient of zero. */
+static void qrpt_solve(gsl_matrix const *qr, gsl_vector const *tau, gsl_permutation const *perm,
+                                        size_t rank, gsl_vector const *b, gsl_vector *x){
+    gsl_vector *qtb = apop_vector_copy(b);
+    gsl_linalg_QR_QTvec(qr, tau, qtb);
+    gsl_matrix_const_view r = gsl_matrix_const_submatrix(qr, 0, 0, rank, rank);
+    gsl_vector_view z = gsl_vector_subvector(qtb, 0, rank);
+    gsl_blas_dtrsv(CblasUpper, CblasNoTrans, CblasNonUnit, &r.matrix, &z.vector);
+    gsl_vector_set_zero(x);
+    gsl_vector_view xr = gsl_vector_subvector(x, 0, rank);
+    gsl_vector_memcpy(&xr.vector, &z.vector);
+    gsl_permute_vector_inverse(perm, x);
+    gsl_vector_free(qtb);
+}
+
+/* Is the Cholesky factor L of X'X fit to use? Not if some column is nearly a linear
+   combination of the others: L_ii^2/(X'X)_ii is 1-R^2 from regressing column i on the
+   earlier columns, so we want it above 1e-4. If det is not NULL, it gets |X'X|. */
+static int ols_chol_ok(gsl_matrix const *chol, gsl_matrix const *xpx, double *det){
+    double min_ratio = 1;
+    if (det) *det = 1;
+    for (size_t i=0; i< xpx->size1; i++){
+        double lsq = gsl_pow_2(gsl_matrix_get(chol, i, i));
+        if (det) *det *= lsq;
+        if (gsl_matrix_get(xpx, i, i) > 0) min_ratio = GSL_MIN(min_ratio, lsq/gsl_matrix_get(xpx, i, i));
+    }
+    return min_ratio > 1e-4;
+}
+
+static void ols_chol_solve(gsl_matrix const *chol, gsl_vector const *xpy, gsl_vector *beta, gsl_matrix *xpxinv){
+    gsl_linalg_cholesky_solve(chol, xpy, beta);
+    if (xpxinv){
+        gsl_matrix_memcpy(xpxinv, chol);
+        gsl_linalg_cholesky_invert(xpxinv);
+    }
+}
+
+/* Solve X'X \beta = X'y. One Cholesky factorization of X'X gives \beta, the determinant
+   of X'X (the return value), and (X'X)^{-1} if xpxinv is not NULL.
+
+   If the factorization fails or fails the ols_chol_ok test, then use a column-pivoted QR
+   decomposition instead. That is of X itself if we have the data, so the solution depends
+   on the condition number of X rather than its square; else it is of X'X. If X is
+   rank-deficient, the columns that the pivoting puts last get a coefficient of zero and
+   a variance of NaN. */
+static double ols_solve(gsl_matrix const *xpx, gsl_vector const *xpy, apop_data const *data,
+                                                      gsl_vector *beta, gsl_matrix *xpxinv){
+    size_t k = xpx->size1;
+    double det = 1;
+    gsl_matrix *chol = apop_matrix_copy(xpx);
+    gsl_error_handler_t *prior_handler = gsl_set_error_handler_off();
+    int err = gsl_linalg_cholesky_decomp(chol);
+    gsl_set_error_handler(prior_handler);
+    if (!err && ols_chol_ok(chol, xpx, &det)){
+        ols_chol_solve(chol, xpy, beta, xpxinv);
+        gsl_matrix_free(chol);
+        return det;
+    }
+    gsl_matrix_free(chol);
+
+    //else, pivoted QR.
+    char use_x = data && !data->sparse && data->vector && data->matrix->size1 >= k;
+    gsl_matrix *qr = apop_matrix_copy(use_x ? data->matrix : xpx);
+    gsl_vector *wy = NULL;
+    if (use_x && data->weights){ //then it's W^{1/2}X and W^{1/2}y, scaled here in the copy.
+        wy = apop_vector_copy(data->vector);
+        for (size_t i=0; i< wy->size; i++){
+            double sw = sqrt(gsl_vector_get(data->weights, i));
+            Apop_matrix_row(qr, i, row);
+            gsl_vector_scale(row, sw);
+            *gsl_vector_ptr(wy, i) *= sw;
+        }
+    }
+    gsl_vector *tau = gsl_vector_alloc(k), *norm = gsl_vector_alloc(k);
+    gsl_permutation *perm = gsl_permutation_alloc(k);
+    int sign;
+    gsl_linalg_QRPT_decomp(qr, tau, perm, &sign, norm);
+    size_t rank = 0;
+    double tol = GSL_MAX(qr->size1, k) * GSL_DBL_EPSILON * fabs(gsl_matrix_get(qr, 0, 0));
+    det = 1;
+    for (size_t i=0; i< k; i++){
+        det *= gsl_matrix_get(qr, i, i);
+        if (fabs(gsl_matrix_get(qr, i, i)) > tol) rank++;
+    }
+    det = use_x ? gsl_pow_2(det) : fabs(det);
+    int level = (rank < k || !use_x) ? 1 : 2;
+    Apop_notify(level, "X'X is %s, so I'm using a pivoted QR decomposition of %s.%s",
+                        err ? "not positive definite" : "ill-conditioned", use_x ? "X" : "X'X",
+                        rank < k ? " The data is rank-deficient, so some coefficients will be zero and their variances NaN."
+                                 : use_x ? "" : " Expect the covariance matrix [based on (X'X)^-1] to be garbage.");
+    qrpt_solve(qr, tau, perm, rank, wy ? wy : use_x ? data->vector : xpy, beta);
+    if (wy) gsl_vector_free(wy);
+    if (xpxinv){
+        gsl_matrix_set_all(xpxinv, GSL_NAN);
+        if (use_x){ // X P = QR, so (X'X)^{-1} = P R^{-1}R^{-1}' P', using the full-rank block of R.
+            gsl_matrix_view r = gsl_matrix_submatrix(qr, 0, 0, rank, rank);
+            gsl_matrix *rinv = gsl_matrix_alloc(rank, rank), *rr = gsl_matrix_alloc(rank, rank);
+            gsl_matrix_set_identity(rinv);
+            gsl_blas_dtrsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, 1, &r.matrix, rinv);
+            gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1, rinv, rinv, 0, rr);
+            for (size_t i=0; i< rank; i++)
+                for (size_t j=0; j< rank; j++)
+                    gsl_matrix_set(xpxinv, gsl_permutation_get(perm, i), gsl_permutation_get(perm, j), gsl_matrix_get(rr, i, j));
+            gsl_matrix_free(rinv); gsl_matrix_free(rr);
         } else {
-            actual       = gsl_matrix_get(data,i, 0);
-            expected    +=  gsl_vector_get(p->parameters->vector,0) * (1 - actual); //data isn't affine.
+            gsl_vector *e = gsl_vector_alloc(k), *col = gsl_vector_alloc(k);
+            for (size_t j=0; j< rank; j++){
+                size_t pj = gsl_permutation_get(perm, j);
+                gsl_vector_set_basis(e, pj);
+                qrpt_solve(qr, tau, perm, rank, e, col);
+                for (size_t i=0; i< rank; i++)
+                    gsl_matrix_set(xpxinv, gsl_permutation_get(perm, i), pj, gsl_vector_get(col, gsl_permutation_get(perm, i)));
+            }
+            gsl_vector_free(e); gsl_vector_free(col);
         }
-        gsl_vector_set(errors, i, expected-actual);
     }
-    sigma   = sqrt(apop_vector_var(errors));
-    apop_model *norm = apop_model_set_parameters(apop_normal, 0.0, sigma);
-    gsl_vector_set_all(gradient, 0);
-	for(size_t i=0;i< data->size1; i++){
-        apop_data_set(subdata, 0, 0, gsl_vector_get(errors, i));
-        apop_score(subdata, normscore, norm);
-        weight = d->weights ? gsl_vector_get(d->weights, i) : 1; 
-        for(size_t j=0; j< data->size2; j++)
-            apop_vector_increment(gradient, j, weight * apop_data_get(d, i, j) * gsl_vector_get(normscore, 0));
-	} 
-    gsl_vector_free(errors);
-    apop_model_free(norm);
+    gsl_matrix_free(qr); gsl_vector_free(tau); gsl_vector_free(norm); gsl_permutation_free(perm);
+    return det;
 }
 
-//xpx may be destroyed by the HH transformation.
+/* \beta = (X'X)^{-1}X'y, and then the covariance and <Predicted> page if they're wanted. */
+static void ols_xpxinvxpy(apop_data const*data, gsl_matrix const *xpx, gsl_vector const *xpy, apop_model *out){
+    apop_lm_settings   *p =  apop_settings_get_group(out, apop_lm);
+    apop_parts_wanted_settings *pwant = apop_settings_get_group(out, apop_parts_wanted);
+    size_t k = xpx->size1;
+    apop_data *cov = ((pwant && pwant->covariance=='y') || (!pwant && p && p->want_cov=='y'))
+                        ? apop_data_alloc(0, k, k) : NULL; // not yet cov, just (X'X)^-1.
+    apop_data_free(out->parameters);
+    out->parameters = apop_data_alloc(k);
+    ols_solve(xpx, xpy, data, out->parameters->vector, cov ? cov->matrix : NULL);
+    if (cov || (pwant && pwant->predicted == 'y') || (!pwant && p && p->want_expected_value == 'y'))
+        ols_finish(data, cov, out);
+}
+
+/* For IV, where the matrix to invert is Z'X, which isn't symmetric.
+   xpx may be destroyed by the HH transformation. */
 static void xpxinvxpy(apop_data const*data, gsl_matrix *xpx, apop_data const* xpy, apop_model *out){
     apop_lm_settings   *p =  apop_settings_get_group(out, apop_lm);
     apop_parts_wanted_settings *pwant = apop_settings_get_group(out, apop_parts_wanted);
-	if ( (pwant && pwant->covariance!='y' && pwant->predicted != 'y') 
+    if ( (pwant && pwant->covariance!='y' && pwant->predicted != 'y') 
        ||(!pwant && p && p->want_cov!='y' && p->want_expected_value != 'y')){	
 		//then don't calculate (X'X)^{-1}
 		gsl_linalg_HH_solve (xpx, xpy->vector, out->parameters->vector);
 		return;
 	} //else:
-    double s_sq;
-    gsl_vector const *y_data = data->vector; //just an alias
     apop_data *cov = apop_data_alloc();
     double det = apop_det_and_inv(xpx, &cov->matrix, 1, 1);// not yet cov, just (X'X)^-1.
     if (det < 1e-4) Apop_notify(1, "Determinant of X'X is small (%g), so matrix is near singular. "
                         "Expect the covariance matrix [based on (X'X)^-1] to be garbage.", det);
     apop_data_free(out->parameters);
     out->parameters = apop_dot(cov, xpy);               // \beta=(X'X)^{-1}X'Y
-    apop_data *error = apop_dot(data, out->parameters); // X\beta ==predicted (not yet error)
-	gsl_vector_sub(error->vector, y_data);              // X'\beta - Y == error
-    gsl_blas_ddot(error->vector, error->vector, &s_sq); // e'e
-    s_sq /= data->matrix->size1 - data->matrix->size2;  // \sigma^2 = e'e / df
-	gsl_matrix_scale(cov->matrix, s_sq);                // cov = \sigma^2 (X'X)^{-1}
-	if ((pwant && pwant->predicted) || (!pwant && p && p->want_expected_value)){
-        gsl_matrix *predicted_page = apop_data_get_page(out->info, "<Predicted>")->matrix;
-        gsl_matrix_set_col(predicted_page, 0, y_data);
-        gsl_matrix_set_col(predicted_page, 2, error->vector);
-        Apop_matrix_col(predicted_page, 1, predicted);
-        gsl_vector_memcpy(predicted, y_data);
-        gsl_vector_add(predicted, error->vector); //pred = y_data + error
+    ols_finish(data, cov, out);
+}
+
+/* X = [M | S], where S is a block of indicators with at most one entry per row, so
+   X'X = [A B; B' C] with C=S'S diagonal (the category counts). Solve via the Schur
+   complement Z = A - B C^{-1} B', which is only as big as the dense part:
+     \beta_M = Z^{-1}(M'y - B C^{-1} S'y),  \beta_S = C^{-1}(S'y - B'\beta_M).
+   If the covariance is wanted, the blocks of (X'X)^{-1} are
+     [Z^{-1}, -Z^{-1}BC^{-1}; (.)', C^{-1} + C^{-1}B'Z^{-1}BC^{-1}].
+   Returns 0 if S isn't that sort of block, and the caller should do it densely. */
+static int sparse_xpxinvxpy(apop_data const*data, apop_data const* xpy, apop_model *out){
+    apop_lm_settings   *p =  apop_settings_get_group(out, apop_lm);
+    apop_parts_wanted_settings *pwant = apop_settings_get_group(out, apop_parts_wanted);
+    apop_sparse const *S = data->sparse;
+    if (!data->matrix || !S->size2 || !apop_sparse_is_indicator(S)) return 0;
+    size_t pm = data->matrix->size2, q = S->size2;
+    gsl_vector *cinv = gsl_vector_alloc(q);
+    apop_sparse_col_ss(S, cinv);
+    for (size_t j=0; j< q; j++)
+        if (!gsl_vector_get(cinv, j)){ //an empty category; X'X is singular. Let the dense version complain.
+            gsl_vector_free(cinv);
+            return 0;
+        }
+    for (size_t j=0; j< q; j++) gsl_vector_set(cinv, j, 1./gsl_vector_get(cinv, j));
+
+    gsl_matrix *z = gsl_matrix_alloc(pm, pm);   // A = M'M, becoming Z
+    gsl_blas_dsyrk(CblasUpper, CblasTrans, 1, data->matrix, 0, z);
+    mirror_upper(z);
+    gsl_matrix *b = gsl_matrix_calloc(pm, q);   // B = M'S
+    apop_sparse_tm(S, data->matrix, b, 1);
+    gsl_matrix *bc = apop_matrix_copy(b);       // B C^{-1}
+    for (size_t j=0; j< q; j++){
+        Apop_matrix_col(bc, j, bcj);
+        gsl_vector_scale(bcj, gsl_vector_get(cinv, j));
     }
-    apop_data_free(error);
-    if (apop_data_get_page(out->parameters, "<Covariance>"))
-        apop_data_rm_page(out->parameters, "<Covariance>");
-    apop_data_add_page(out->parameters, cov, "<Covariance>");
+    gsl_blas_dgemm(CblasNoTrans, CblasTrans, -1, bc, b, 1, z);
+
+    gsl_vector_const_view ym = gsl_vector_const_subvector(xpy->vector, 0, pm);
+    gsl_vector_const_view ys = gsl_vector_const_subvector(xpy->vector, pm, q);
+    gsl_vector *rhs = apop_vector_copy(&ym.vector);
+    gsl_blas_dgemv(CblasNoTrans, -1, bc, &ys.vector, 1, rhs);
+    char want_cov = (pwant && pwant->covariance=='y') || (!pwant && p && p->want_cov=='y');
+    gsl_matrix *zinv = want_cov ? gsl_matrix_alloc(pm, pm) : NULL;
+    apop_data_free(out->parameters);
+    out->parameters = apop_data_alloc(pm+q);
+    gsl_vector_view bm = gsl_vector_subvector(out->parameters->vector, 0, pm);
+    gsl_vector_view bs = gsl_vector_subvector(out->parameters->vector, pm, q);
+    ols_solve(z, rhs, NULL, &bm.vector, zinv);
+    gsl_vector_memcpy(&bs.vector, &ys.vector);
+    gsl_blas_dgemv(CblasTrans, -1, b, &bm.vector, 1, &bs.vector);
+    gsl_vector_mul(&bs.vector, cinv);
+
+    apop_data *cov = NULL;
+    if (want_cov){
+        cov = apop_data_alloc(0, pm+q, pm+q);
+        gsl_matrix_view tl = gsl_matrix_submatrix(cov->matrix, 0, 0, pm, pm);
+        gsl_matrix_view tr = gsl_matrix_submatrix(cov->matrix, 0, pm, pm, q);
+        gsl_matrix_view bl = gsl_matrix_submatrix(cov->matrix, pm, 0, q, pm);
+        gsl_matrix_view br = gsl_matrix_submatrix(cov->matrix, pm, pm, q, q);
+        gsl_matrix_memcpy(&tl.matrix, zinv);
+        gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, -1, zinv, bc, 0, &tr.matrix);
+        gsl_matrix_transpose_memcpy(&bl.matrix, &tr.matrix);
+        gsl_blas_dgemm(CblasTrans, CblasNoTrans, -1, bc, &tr.matrix, 0, &br.matrix);
+        for (size_t j=0; j< q; j++) *gsl_matrix_ptr(&br.matrix, j, j) += gsl_vector_get(cinv, j);
+    }
+    if (cov || (pwant && pwant->predicted == 'y') || (!pwant && p && p->want_expected_value == 'y'))
+        ols_finish(data, cov, out);
+    if (zinv) gsl_matrix_free(zinv);
+    gsl_matrix_free(z); gsl_matrix_free(b); gsl_matrix_free(bc);
+    gsl_vector_free(rhs); gsl_vector_free(cinv);
+    return 1;
 }
 
 /* \adoc    RNG  Linear models are typically only partially defined probability models. For
@@ -268,16 +515,416 @@ static void ols_rng(double *out, gsl_rng *r, apop_model *m){
     gsl_vector_free(tempdata);
 }
 
+/* Streaming OLS. Everything OLS needs from the data---X'X, X'y, y'y, the sum of y, and
+   the counts---adds up across blocks of rows, so we can accumulate those moments one block
+   at a time and never hold (or copy) the full data set.
+
+   A block is in the form the OLS prep routine produces (y in the vector, X in the matrix)
+   or, if there is no vector, in the raw form: y in column zero, which stands in for the
+   constant column. */
+
+#define Ols_block 256
+
+typedef struct {
+    apop_data const *d;
+    size_t start, end;
+    gsl_matrix *xpx;    //upper triangle only
+    gsl_vector *xpy;
+    long double n, sw, swy, swyy;
+} ols_chunk;
+
+static void *ols_chunk_accumulate(void *in){
+    ols_chunk *c = in;
+    apop_data const *d = c->d;
+    size_t k = d->matrix->size2;
+    char shuffle = !d->vector;
+    gsl_matrix *buf = (shuffle || d->weights) ? gsl_matrix_alloc(Ols_block, k) : NULL;
+    gsl_vector *ybuf = gsl_vector_alloc(Ols_block);
+    for (size_t r=c->start; r< c->end; r+= Ols_block){
+        size_t rows = GSL_MIN(Ols_block, c->end - r);
+        gsl_matrix_const_view xv = gsl_matrix_const_submatrix(d->matrix, r, 0, rows, k);
+        gsl_vector_view yv = gsl_vector_subvector(ybuf, 0, rows);
+        gsl_matrix const *x = &xv.matrix;
+        if (buf){
+            gsl_matrix_view bv = gsl_matrix_submatrix(buf, 0, 0, rows, k);
+            gsl_matrix_memcpy(&bv.matrix, x);
+            x = &bv.matrix;
+        }
+        for (size_t i=0; i< rows; i++){
+            double y = shuffle ? gsl_matrix_get(d->matrix, r+i, 0) : gsl_vector_get(d->vector, r+i);
+            double w = d->weights ? gsl_vector_get(d->weights, r+i) : 1;
+            c->sw += w;
+            c->swy += w*y;
+            c->swyy += w*y*y;
+            if (shuffle) gsl_matrix_set(buf, i, 0, 1);
+            if (d->weights){  //X'WX = (W^{1/2}X)'(W^{1/2}X)
+                Apop_matrix_row(buf, i, xrow);
+                gsl_vector_scale(xrow, sqrt(w));
+                y *= sqrt(w);
+            }
+            gsl_vector_set(ybuf, i, y);
+        }
+        gsl_blas_dsyrk(CblasUpper, CblasTrans, 1, x, 1, c->xpx);
+        gsl_blas_dgemv(CblasTrans, 1, x, &yv.vector, 1, c->xpy);
+    }
+    c->n += c->end - c->start;
+    if (buf) gsl_matrix_free(buf);
+    gsl_vector_free(ybuf);
+    return NULL;
+}
+
+enum {ols_n, ols_sw, ols_swy, ols_swyy};
+
+/* Online OLS. A tally can also carry a <Cholesky> page holding the factor L of X'X, in
+   GSL's layout (L in the lower triangle, L' in the upper). A new row x changes it by the
+   rank-one update LL' + xx', and a row leaving the window by the downdate LL' - xx', each
+   of which is one sweep of rotations down the rows of L', for O(k^2) per row instead of
+   the O(k^3) to refactor. We keep X'X as well, so if a downdate fails---rounding error
+   would push the factor off of positive definite---we just refactor from X'X. */
+
+static void ols_refactor(apop_data *moments){
+    apop_data *page = apop_data_get_page(moments, "<Cholesky>");
+    if (!page){
+        size_t k = moments->matrix->size1;
+        page = apop_data_add_page(moments, apop_data_alloc(k, k), "<Cholesky>");
+    }
+    gsl_matrix_memcpy(page->matrix, moments->matrix);
+    gsl_error_handler_t *prior_handler = gsl_set_error_handler_off();
+    int err = gsl_linalg_cholesky_decomp(page->matrix);
+    gsl_set_error_handler(prior_handler);
+    if (err || !ols_chol_ok(page->matrix, moments->matrix, NULL)) //e.g., fewer rows than columns
+        apop_data_rm_page(moments, "<Cholesky>");
+}
+
+/* Replace R'R (R upper triangular) with R'R + sign xx'. x is overwritten. Returns 1 if
+   a downdate would leave a diagonal element at or near zero. */
+static int ols_chol_rank1(gsl_matrix *r, gsl_vector *x, double sign){
+    size_t k = r->size1;
+    double *xd = x->data;
+    for (size_t i=0; i< k; i++){
+        double *ri = gsl_matrix_ptr(r, i, 0);
+        if (!xd[i]) continue;
+        double rsq = ri[i]*ri[i] + sign*xd[i]*xd[i];
+        if (!(rsq > 1e-8*ri[i]*ri[i])) return 1;
+        double rii = sqrt(rsq), c = rii/ri[i], s = xd[i]/ri[i];
+        ri[i] = rii;
+        for (size_t j=i+1; j< k; j++){
+            ri[j] = (ri[j] + sign*s*xd[j])/c;
+            xd[j] = c*xd[j] - s*ri[j];
+        }
+    }
+    return 0;
+}
+
+/* Add (sign=1) or remove (sign=-1) the rows of the block one at a time, updating X'X,
+   X'y, the sums, and the factor. */
+static void ols_online_rows(apop_data *moments, apop_data const *block, double sign){
+    size_t k = block->matrix->size2;
+    char shuffle = !block->vector;
+    apop_data *page = apop_data_get_page(moments, "<Cholesky>");
+    char stale = !page;
+    double *sums = apop_data_get_page(moments, "<Sums>")->vector->data;
+    gsl_vector *x = gsl_vector_alloc(k);
+    for (size_t i=0; i< block->matrix->size1; i++){
+        gsl_vector_const_view row = gsl_matrix_const_row(block->matrix, i);
+        gsl_vector_memcpy(x, &row.vector);
+        double y = shuffle ? gsl_vector_get(x, 0) : gsl_vector_get(block->vector, i);
+        double w = block->weights ? gsl_vector_get(block->weights, i) : 1;
+        if (shuffle) gsl_vector_set(x, 0, 1);
+        sums[ols_n] += sign;
+        sums[ols_sw] += sign*w;
+        sums[ols_swy] += sign*w*y;
+        sums[ols_swyy] += sign*w*y*y;
+        if (block->weights) gsl_vector_scale(x, sqrt(w));
+        gsl_blas_dsyr(CblasUpper, sign, x, moments->matrix);
+        gsl_blas_daxpy(sign*y*sqrt(w), x, moments->vector);
+        if (!stale) stale = ols_chol_rank1(page->matrix, x, sign);
+    }
+    gsl_vector_free(x);
+    mirror_upper(moments->matrix);
+    if (stale) ols_refactor(moments);
+    else       mirror_upper(page->matrix);
+}
+
+/** Add a block of rows to a running tally of the sufficient statistics for OLS. Call
+this once per block, then hand the result to \ref apop_ols_from_moments to get the
+estimate. Because the blocks can be any size and come from anywhere, this is how to run
+a regression on data that doesn't fit in memory; \ref apop_ols_query does it for the
+rows of a database query.
+
+\li The block is in the form that \ref apop_ols takes: if it has a vector, that is the
+dependent variable and the matrix is the independent variables; if it has no vector, then
+the first column of the matrix is the dependent variable, and I treat that column as a
+constant column of ones. Either way, the block is not modified.
+\li If the block has \c weights, I accumulate \f$X'WX\f$ and \f$X'Wy\f$.
+\li Each block is split across \c apop_opts.thread_count threads, whose tallies are then merged.
+\li Blocks with a \c sparse element aren't supported; use \ref apop_ols directly for those.
+
+\param block The new rows (No default, must not be \c NULL.)
+\param moments The tally so far, or \c NULL to start a new one.
+\return The updated tally, which is \c moments if that was not \c NULL. The matrix is
+\f$X'X\f$, the vector is \f$X'y\f$, and a page named <tt>\<Sums\></tt> holds the count of
+rows, the sum of the weights, \f$\sum wy\f$, and \f$\sum wy^2\f$.
+\exception moments->error=='d' The block's width doesn't match the earlier blocks.
+\ingroup regression
+*/
+apop_data *apop_ols_accumulate(apop_data const *block, apop_data *moments){
+    Nullcheck_d(block, moments); Nullcheck(block->matrix, moments);
+    Apop_stopif(block->sparse, return moments, 0, "Blocks with a sparse element aren't supported "
+                        "by the streaming accumulator; estimate them with apop_ols directly.");
+    size_t k = block->matrix->size2, n = block->matrix->size1;
+    if (!moments){
+        moments = apop_data_calloc(k, k, k);
+        apop_data *sums = apop_data_add_page(moments, apop_data_calloc(4), "<Sums>");
+        char *sumnames[] = {"n", "sum w", "sum y", "sum y^2"};
+        for (int i=0; i< 4; i++) apop_name_add(sums->names, sumnames[i], 'r');
+        apop_name *names = block->names;
+        if (block->vector){
+            if (names->vector) apop_name_add(moments->names, names->vector, 'v');
+            for (int i=0; i< names->colct; i++) apop_name_add(moments->names, names->column[i], 'c');
+        } else if (names->colct){
+            apop_name_add(moments->names, names->column[0], 'v');
+            apop_name_add(moments->names, "1", 'c');
+            for (int i=1; i< names->colct; i++) apop_name_add(moments->names, names->column[i], 'c');
+        }
+        apop_name_stack(moments->names, moments->names, 'r', 'c');
+    }
+    Apop_stopif(moments->matrix->size1 != k, moments->error='d'; return moments, 0, "This block has %zu "
+                        "columns but earlier blocks had %zu.", k, moments->matrix->size1);
+    if (!n) return moments;
+
+    int threadct = GSL_MAX(1, GSL_MIN(apop_opts.thread_count, n/1000));
+    ols_chunk c[threadct];
+    pthread_t thread_id[threadct];
+    for (int t=0; t< threadct; t++){
+        c[t] = (ols_chunk){.d=block, .start=n*t/threadct, .end=n*(t+1)/threadct,
+                    .xpx = t ? gsl_matrix_calloc(k, k) : moments->matrix,
+                    .xpy = t ? gsl_vector_calloc(k) : moments->vector};
+        if (t) pthread_create(&thread_id[t], NULL, ols_chunk_accumulate, c+t);
+    }
+    ols_chunk_accumulate(c);
+    for (int t=1; t< threadct; t++){
+        pthread_join(thread_id[t], NULL);
+        gsl_matrix_add(moments->matrix, c[t].xpx);
+        gsl_vector_add(moments->vector, c[t].xpy);
+        c[0].n += c[t].n; c[0].sw += c[t].sw; c[0].swy += c[t].swy; c[0].swyy += c[t].swyy;
+        gsl_matrix_free(c[t].xpx);
+        gsl_vector_free(c[t].xpy);
+    }
+    mirror_upper(moments->matrix);
+    gsl_vector *sums = apop_data_get_page(moments, "<Sums>")->vector;
+    sums->data[ols_n] += c[0].n;
+    sums->data[ols_sw] += c[0].sw;
+    sums->data[ols_swy] += c[0].swy;
+    sums->data[ols_swyy] += c[0].swyy;
+    if (apop_data_get_page(moments, "<Cholesky>")) ols_refactor(moments);
+    return moments;
+}
+
+/** Estimate an OLS model from the moments tallied by \ref apop_ols_accumulate.
+
+The output is an \ref apop_ols model with the parameters, their
+<tt>\<Covariance\></tt> page, and the info page's <tt>\<test info\></tt> page, as
+from \ref apop_estimate. Because the data itself is gone by this point, the model's \c
+data element is \c NULL and there is no <tt>\<Predicted\></tt> page, but the info
+page still reports the log likelihood (assuming Normal errors), \f$R^2\f$, adjusted
+\f$R^2\f$, SSE, SST, SSR, and the degrees of freedom, all from the moments.
+
+If the tally has a <tt>\<Cholesky\></tt> page, as kept by \ref apop_ols_add_rows and
+\ref apop_ols_rm_rows, I solve using that factor rather than factoring \f$X'X\f$ again.
+
+\param moments The output from \ref apop_ols_accumulate.
+\return An estimated \ref apop_ols model.
+\exception out->error=='d' The moments were \c NULL or empty.
+\ingroup regression
+*/
+apop_model *apop_ols_from_moments(apop_data const *moments){
+    apop_model *out = apop_model_copy(apop_ols);
+    apop_data *sumpage = moments ? apop_data_get_page(moments, "<Sums>") : NULL;
+    Apop_stopif(!sumpage || !sumpage->vector->data[ols_n], out->error='d'; return out, 0,
+                    "I need a nonempty tally from apop_ols_accumulate.");
+    double *sums = sumpage->vector->data;
+    size_t k = moments->matrix->size1;
+    double n = sums[ols_n], df = GSL_MAX(n - k, 1);
+
+    apop_data *cov = apop_data_alloc(k, k); // not yet cov, just (X'X)^-1.
+    apop_data_free(out->parameters);
+    out->parameters = apop_data_alloc(k);
+    apop_data *chol = apop_data_get_page(moments, "<Cholesky>");
+    if (chol && ols_chol_ok(chol->matrix, moments->matrix, NULL))
+        ols_chol_solve(chol->matrix, moments->vector, out->parameters->vector, cov->matrix);
+    else ols_solve(moments->matrix, moments->vector, NULL, out->parameters->vector, cov->matrix);
+
+    double bxy;
+    gsl_blas_ddot(out->parameters->vector, moments->vector, &bxy);
+    double sse = GSL_MAX(sums[ols_swyy] - bxy, 0);  // y'y - 2b'X'y + b'X'Xb, with X'Xb = X'y
+    double sst = sums[ols_swyy] - gsl_pow_2(sums[ols_swy])/sums[ols_sw]; //sum w (y - ybar)^2
+    gsl_matrix_scale(cov->matrix, sse/df);
+
+    apop_name_add(out->parameters->names, "parameters", 'v');
+    apop_name_stack(out->parameters->names, moments->names, 'r', 'c');
+    if (moments->names->vector)
+        snprintf(out->parameters->names->title, 100, "Regression of %s", moments->names->vector);
+    apop_name_stack(cov->names, moments->names, 'c');
+    apop_name_stack(cov->names, moments->names, 'r', 'c');
+    apop_data_add_page(out->parameters, cov, "<Covariance>");
+
+    if (!out->info) out->info = apop_data_alloc();
+    apop_data *tests = apop_data_add_page(out->info, apop_data_alloc(k, 2), "<test info>");
+    apop_name_add(tests->names, "p value", 'c');
+    apop_name_add(tests->names, "confidence", 'c');
+    apop_name_stack(tests->names, out->parameters->names, 'r', 'r');
+    for (size_t i=0; i< k; i++){
+        double t = fabs(gsl_vector_get(out->parameters->vector, i))/sqrt(gsl_matrix_get(cov->matrix, i, i));
+        double conf = 1 - 2*gsl_cdf_tdist_Q(t, df);
+        apop_data_set(tests, i, .colname="confidence", .val=conf);
+        apop_data_set(tests, i, .colname="p value",    .val=1-conf);
+    }
+    apop_data_add_named_elmt(out->info, "df", df);
+
+    double sigma_sq = sse/(n-1);  //as per ols_log_likelihood: the variance of errors that sum to zero.
+    apop_data_add_named_elmt(out->info, "log likelihood", -n/2.*log(2*M_PI*sigma_sq) - sse/(2*sigma_sq));
+    apop_data_add_named_elmt(out->info, "R_squared", 1 - sse/sst);
+    apop_data_add_named_elmt(out->info, "R_squared_adj", 1 - ((n-1.)/(n-k+1.))*(sse/sst)); //as in apop_estimate_coefficient_of_determination
+    apop_data_add_named_elmt(out->info, "SSE", sse);
+    apop_data_add_named_elmt(out->info, "SST", sst);
+    apop_data_add_named_elmt(out->info, "SSR", sst - sse);
+    return out;
+}
+
+/** Add rows to a running OLS tally, keeping a Cholesky factor of \f$X'X\f$ current, so
+that \ref apop_ols_from_moments can report \f$\beta\f$, its covariance, and the \f$R^2\f$
+family of statistics at any point without refactoring. Pair with \ref apop_ols_rm_rows
+to run a regression over a sliding window:
+
+\code
+apop_data *window = NULL;
+for (...){
+    window = apop_ols_add_rows(window, new_rows);
+    apop_ols_rm_rows(window, expired_rows);
+    apop_model *est = apop_ols_from_moments(window);
+    ...
+}
+\endcode
+
+\li The rows are in the form that \ref apop_ols_accumulate takes, and the tally is
+also the same, plus a <tt>\<Cholesky\></tt> page with the factor.
+\li The first rows are tallied in a block by \ref apop_ols_accumulate and then factored.
+Once there is a factor, each row is a rank-one update, for \f$O(k^2)\f$ work per row.
+\li Until there are enough rows for \f$X'X\f$ to be positive definite, there is no factor,
+and \ref apop_ols_from_moments falls back to its usual solver.
+
+\param moments The tally so far, or \c NULL to start a new one.
+\param rows The new rows (No default, must not be \c NULL.)
+\return The updated tally, which is \c moments if that was not \c NULL.
+\exception moments->error=='d' The rows' width doesn't match the tally.
+\ingroup regression
+*/
+apop_data *apop_ols_add_rows(apop_data *moments, apop_data const *rows){
+    Nullcheck_d(rows, moments); Nullcheck(rows->matrix, moments);
+    if (!moments || !apop_data_get_page(moments, "<Cholesky>")){
+        moments = apop_ols_accumulate(rows, moments);
+        if (moments && !moments->error) ols_refactor(moments);
+        return moments;
+    }
+    Apop_stopif(rows->sparse, return moments, 0, "Rows with a sparse element aren't supported.");
+    Apop_stopif(moments->matrix->size1 != rows->matrix->size2, moments->error='d'; return moments, 0,
+                    "These rows have %zu columns but the tally has %zu.", rows->matrix->size2, moments->matrix->size1);
+    ols_online_rows(moments, rows, 1);
+    return moments;
+}
+
+/** Remove rows from a running OLS tally, by a rank-one downdate of the Cholesky factor
+of \f$X'X\f$ per row. See \ref apop_ols_add_rows.
+
+\li The rows should be rows that were added earlier, with the same weights; I have no way
+to check this.
+\li If rounding error or a short window makes a downdate unstable, I refactor \f$X'X\f$
+from scratch, and if there are now too few rows for a factor, I drop the factor until
+\ref apop_ols_add_rows can make a new one.
+
+\param moments The tally so far. (No default, must not be \c NULL.)
+\param rows The rows to remove. (No default, must not be \c NULL.)
+\return The updated tally, \c moments.
+\exception moments->error=='d' The rows' width doesn't match the tally.
+\ingroup regression
+*/
+apop_data *apop_ols_rm_rows(apop_data *moments, apop_data const *rows){
+    Nullcheck_d(moments, NULL); Nullcheck_d(rows, moments); Nullcheck(rows->matrix, moments);
+    Apop_stopif(!apop_data_get_page(moments, "<Sums>"), moments->error='d'; return moments, 0,
+                    "I need a tally from apop_ols_add_rows or apop_ols_accumulate.");
+    Apop_stopif(rows->sparse, return moments, 0, "Rows with a sparse element aren't supported.");
+    Apop_stopif(moments->matrix->size1 != rows->matrix->size2, moments->error='d'; return moments, 0,
+                    "These rows have %zu columns but the tally has %zu.", rows->matrix->size2, moments->matrix->size1);
+    ols_online_rows(moments, rows, -1);
+    return moments;
+}
+
+static int ols_query_block(apop_data *block, void *moments){
+    *(apop_data**)moments = apop_ols_accumulate(block, *(apop_data**)moments);
+    return !!(*(apop_data**)moments)->error;
+}
+
+/** Run OLS on the output of a database query, reading the rows in blocks, so the full
+data set never has to be in memory. As with
+<tt>apop_estimate(apop_query_to_data(query), apop_ols)</tt>, the first column of the
+query's output is the dependent variable, and the remaining columns are the independent
+variables; I add the constant term.
+
+\code
+apop_model *est = apop_ols_query("select income, age, age*age, years_ed from survey");
+\endcode
+
+For text files too large to read in, read them into the database with \ref
+apop_text_to_db first.
+
+\param query The query. Unlike \ref apop_query_to_data, this is not a
+<tt>printf</tt>-style format; use \c asprintf to build the query if need be. (No default;
+must not be \c NULL.)
+\param block_size The number of rows to read at a time. (Default: 10,000)
+\return An estimated \ref apop_ols model, as from \ref apop_ols_from_moments.
+\exception out->error=='q' The query failed or returned no rows.
+
+\li This function uses the \ref designated syntax for inputs.
+\ingroup regression
+*/
+APOP_VAR_HEAD apop_model * apop_ols_query(char const *query, int block_size){
+    char const * apop_varad_var(query, NULL);
+    Apop_stopif(!query, return NULL, 0, "You gave me a NULL query.");
+    int apop_varad_var(block_size, 10000);
+APOP_VAR_END_HEAD
+    apop_data *moments = NULL;
+    int err = apop_query_blocks(query, block_size, ols_query_block, &moments);
+    apop_model *out = (!err && moments && !moments->error) ? apop_ols_from_moments(moments) : NULL;
+    if (!out){
+        out = apop_model_copy(apop_ols);
+        out->error = 'q';
+    }
+    apop_data_free(moments);
+    return out;
+}
+
 /* \adoc estimated_data You can specify whether the data is modified with an \ref apop_lm_settings group. If so, see \ref dataprep for details. Else, left unchanged.
 
 \adoc estimated_parameters
 The \c parameters set will hold the coefficients; the first coefficient will be the
 coefficient on the constant term, and the remaining will correspond to the independent
-variables. It will therefore be of size <tt>(data->size2)</tt>.
+variables. It will therefore be of size <tt>(data->size2)</tt>, plus the width of the
+data's \c sparse block if it has one (see \ref apop_data_to_dummies). If that block is
+a set of dummies with at most one entry per row, the estimation never forms the
+indicators' part of \f$X'X\f$ densely: it is a diagonal of category counts, and I solve
+via its Schur complement. The covariance matrix is still dense, so for a variable with
+very many categories, you may want to set <tt>want_cov='n'</tt> in the \ref apop_lm_settings group;
+the residuals are still calculated unless you also set <tt>want_expected_value='n'</tt>.
 
 I add a page named <tt>\<Covariance\></tt>, which gives the covariance matrix for the
 estimated parameters (not the data itself).
 
+I solve via a Cholesky decomposition of \f$X'X\f$. If a column of the data is nearly
+collinear with the others, I instead use a pivoted QR decomposition of \f$X\f$, which
+is slower but loses half as many digits. If the data is rank-deficient, the columns that
+the pivoting puts last get a coefficient of zero and a variance of NaN.
+
 \adoc estimated_info Reports log likelihood, and runs \ref apop_estimate_coefficient_of_determination 
 to add \f$R^2\f$-type information (SSE, SSR, \&c) to the info page.
 
@@ -295,37 +942,58 @@ Given your estimate \c est, the zeroth element is one of <br>
 */
 static apop_model * apop_estimate_OLS(apop_data *inset, apop_model *ep){
     Nullcheck_mpd(inset, ep, NULL);
-    apop_data *set;
     apop_lm_settings *olp =  apop_settings_get_group(ep, apop_lm);
     apop_parts_wanted_settings *pwant = apop_settings_get_group(ep, apop_parts_wanted);
     if (!olp) 
         olp = Apop_model_add_group(ep, apop_lm);
     ep->data = inset;
-    set = olp->destroy_data ? inset : apop_data_copy(inset); 
-    
-    gsl_vector *weights = olp->destroy_data      //this may be NULL.
-                           ? ep->data->weights 
-                           : apop_vector_copy(ep->data->weights);
-    if (weights)
-        for (size_t i =0; i< weights->size; i++)
-            gsl_vector_set(weights, i, sqrt(gsl_vector_get(weights, i)));
-
     if ((pwant &&pwant->predicted) || (!pwant && olp && olp->want_expected_value=='y'))
-        apop_data_add_page(ep->info, apop_data_alloc(0, set->matrix->size1, 3), "<Predicted>");
+        apop_data_add_page(ep->info, apop_data_alloc(0, inset->matrix->size1, 3), "<Predicted>");
+    size_t k = inset->matrix->size2 + (inset->sparse ? inset->sparse->size2 : 0);
     if ((pwant &&pwant->covariance) || (!pwant && olp && olp->want_cov=='y'))
-        apop_data_add_page(ep->parameters, apop_data_alloc(0, set->matrix->size2, set->matrix->size2), "<Covariance>");
-    if (weights)
-        for (int i = -1; i < set->matrix->size2; i++){
-            APOP_COL(set, i, v);
-            gsl_vector_mul(v, weights);
-        }
+        apop_data_add_page(ep->parameters, apop_data_alloc(0, k, k), "<Covariance>");
 
-    apop_data *xpx_d = apop_dot(set, set, .form1='t'); //(X'X)
-    apop_data *xpy_d = apop_dot(set, set, .form1='t', .form2='v'); //(X'y)
-    xpxinvxpy(set, xpx_d->matrix, xpy_d, ep);
+    if (!inset->sparse){ //Read X'WX and X'Wy straight from the data, weighting a block at a time; no copy.
+        apop_data *moments = apop_ols_accumulate(inset, NULL);
+        ols_xpxinvxpy(inset, moments->matrix, moments->vector, ep);
+        apop_data_free(moments);
+    } else {
+        apop_data *set = (olp->destroy_data || !inset->weights) ? inset : apop_data_copy(inset);
+        gsl_vector *weights = olp->destroy_data      //this may be NULL.
+                               ? ep->data->weights 
+                               : apop_vector_copy(ep->data->weights);
+        if (weights){ //scale the data by W^{1/2}, and then treat it as unweighted.
+            for (size_t i =0; i< weights->size; i++)
+                gsl_vector_set(weights, i, sqrt(gsl_vector_get(weights, i)));
+            for (int i = -1; i < (int)set->matrix->size2; i++){
+                APOP_COL(set, i, v);
+                gsl_vector_mul(v, weights);
+            }
+            apop_sparse *s = set->sparse;
+            if (!s->value){
+                s->value = malloc(sizeof(double)*(s->rowstart[s->size1] ? s->rowstart[s->size1] : 1));
+                for (size_t j=0; j< s->rowstart[s->size1]; j++) s->value[j] = 1;
+            }
+            for (size_t i=0; i< s->size1; i++)
+                for (size_t j = s->rowstart[i]; j < s->rowstart[i+1]; j++)
+                    s->value[j] *= gsl_vector_get(weights, i);
+        }
+        gsl_vector *set_weights = set->weights;
+        set->weights = NULL;
+        apop_data *xpy_d = apop_dot(set, set, .form1='t', .form2='v'); //(X'y)
+        if (!sparse_xpxinvxpy(set, xpy_d, ep)){
+            apop_data *xpx_d = apop_dot(set, set, .form1='t'); //(X'X)
+            ols_xpxinvxpy(set, xpx_d->matrix, xpy_d->vector, ep);
+            apop_data_free(xpx_d);
+        }
+        apop_data_free(xpy_d);
+        set->weights = set_weights;
+        if (!olp->destroy_data){
+            if (weights) gsl_vector_free(weights);
+            if (set != inset) apop_data_free(set);
+        }
+    }
     prep_names(ep);
-    apop_data_free(xpx_d);
-    apop_data_free(xpy_d);
 
     if ((pwant &&pwant->covariance) || (!pwant && olp && olp->want_cov=='y'))
         apop_estimate_parameter_tests(ep);
@@ -333,10 +1001,6 @@ static apop_model * apop_estimate_OLS(apop_data *inset, apop_model *ep){
     apop_data *r_sq = apop_estimate_coefficient_of_determination(ep); //Add R^2-type info to info page.
     apop_data_stack(ep->info, r_sq, .inplace='y');
     apop_data_free(r_sq);
-    if (!olp->destroy_data){
-        if (weights) gsl_vector_free(weights);
-        apop_data_free(set);
-    }
     return ep;
 }
 
@@ -349,7 +1013,13 @@ apop_data *ols_predict (apop_data *in, apop_model *m){
     if (!in->vector)  ols_shuffle(in);  
 
     //find x dot y
-    gsl_blas_dgemv (CblasNoTrans, 1, in->matrix, m->parameters->vector, 0, in->vector);
+    if (in->sparse){ //X\beta = M\beta_M + S\beta_S
+        gsl_vector_view bm = gsl_vector_subvector(m->parameters->vector, 0, in->matrix->size2);
+        gsl_vector_view bs = gsl_vector_subvector(m->parameters->vector, in->matrix->size2, in->sparse->size2);
+        gsl_blas_dgemv (CblasNoTrans, 1, in->matrix, &bm.vector, 0, in->vector);
+        apop_sparse_mv(in->sparse, &bs.vector, in->vector);
+    } else
+        gsl_blas_dgemv (CblasNoTrans, 1, in->matrix, m->parameters->vector, 0, in->vector);
     return in;
 }
 
@@ -381,8 +1051,8 @@ void ols_print(apop_model *m){
 }
 
 apop_model apop_ols = {.name="Ordinary Least Squares", .vbase = -1, .dsize=-1, .estimate =apop_estimate_OLS, 
-            .log_likelihood = ols_log_likelihood, .score=ols_score, .prep = ols_prep, .predict=ols_predict, 
-            .draw=ols_rng, .parameter_model = ols_param_models, .print=ols_print};
+            .log_likelihood = ols_log_likelihood, .score=ols_score, .log_likelihood_score=ols_ll_and_score,
+            .prep = ols_prep, .predict=ols_predict, .draw=ols_rng, .parameter_model = ols_param_models, .print=ols_print};
 
 
 /*\amodel apop_iv Instrumental variable regression
@@ -68,9 +68,25 @@ static void poisson_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_mod
     Get_vmsizes(d) //tsize
     Nullcheck_mpd(d, p, )
     double     lambda = gsl_vector_get(p->parameters->vector, 0);
-    gsl_matrix *data = d->matrix;
-    double     d_a = apop_matrix_sum(data)/lambda - tsize;
-    gsl_vector_set(gradient,0, d_a);
+    double     sum = (d->matrix ? apop_matrix_sum(d->matrix):0) + (d->vector ? apop_sum(d->vector) : 0);
+    gsl_vector_set(gradient,0, sum/lambda - tsize);
+}
+
+/* One pass for the sum of the data, which is all the score needs, and the log
+ likelihood, with the same checks for negative or non-integer counts as apply_me. */
+static double poisson_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *p){
+    Nullcheck_mpd(d, p, GSL_NAN)
+    Get_vmsizes(d) //tsize
+    double lambda = gsl_vector_get(p->parameters->vector, 0);
+    double ln_l = log(lambda);
+    long double sum = 0, ll = 0;
+    Apop_data_elements(d, x,
+        sum += x;
+        if (x < 0 || (x - (int)x) > 1e-4) ll = -INFINITY;
+        else if (x) ll += ln_l*x - gsl_sf_lngamma(x+1);
+    )
+    gsl_vector_set(gradient, 0, sum/lambda - tsize);
+    return ll - tsize*lambda;
 }
 
 /* \adoc RNG Just a wrapper for \c gsl_ran_poisson.  */
@@ -80,5 +96,6 @@ static void poisson_rng(double *out, gsl_rng* r, apop_model *p){
 
 apop_model apop_poisson = {"Poisson distribution", 1, 0, 0, .dsize=1,
      .estimate = poisson_estimate, .log_likelihood = poisson_log_likelihood, 
-     .score = poisson_dlog_likelihood, .constraint = positive_beta_constraint, 
+     .score = poisson_dlog_likelihood, .log_likelihood_score = poisson_ll_and_score,
+     .constraint = positive_beta_constraint, 
      .draw = poisson_rng};
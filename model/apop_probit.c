@@ -23,16 +23,27 @@ Also, if there is no vector, then I will move the first column of the matrix, an
 replace that matrix column with a constant column of ones, just like with OLS.
 
 \adoc    settings   None, but see above about seeking a factor page in the input data.
+\adoc    Estimate_results  Fisher scoring, which converges in a handful of passes through the data and
+gives the covariance of the parameters (on the <tt>\<Covariance\></tt> page) as a
+by-product. If you attach an \ref apop_mle_settings group with a <tt>method</tt>, then I
+use the maximum likelihood search you asked for instead. If the group has no <tt>method</tt>, I
+stop after its <tt>max_iterations</tt> (else 100) steps, or once the norm of the score is below
+its <tt>tolerance</tt>, as with the gradient-based searches.
 \adoc    RNG  See \ref apop_ols; this one is similar but produces a category number instead of OLS's continuous draw.
 */
 
 #include "apop_internal.h"
 
+static apop_model *probit_estimate(apop_data *d, apop_model *m);
+static apop_model *logit_estimate(apop_data *d, apop_model *m);
+
 static apop_data *get_category_table(apop_data *d){
     int first_col = d->vector ? -1 : 0;
     apop_data *out = apop_data_get_factor_names(d, .col=first_col);
-    if (!out) {
+    if (!out) { //The new factor page belongs to d, so it can't come from an open arena scope.
+        char was_held = apop_arena_hold(1);
         apop_data_to_factors(d, .intype='d', .incol=first_col, .outcol=first_col);
+        apop_arena_hold(was_held);
         out = apop_data_get_factor_names(d, .col=first_col);
     }
     return out;
@@ -61,44 +72,34 @@ double biprobit_ll_row(apop_data *r){
     return r->vector->data[0] ?  log(1-n): log(n);
 }
 
-//The case where outcome is a single zero/one option.
-static double biprobit_log_likelihood(apop_data *d, apop_model *p){
-    apop_data *betadotx = apop_dot(d, p->parameters); 
-    betadotx->vector = d->vector;
-    double total_prob = apop_map_sum(betadotx, .fn_r=biprobit_ll_row);
-    betadotx->vector = NULL;
-    apop_data_free(betadotx);
-	return total_prob;
-}
-
-static double val;
-static double unordered(double in){ return in == val; }
-
-// This is just a for loop that runs a probit on each column.
-static double multiprobit_log_likelihood(apop_data *d, apop_model *p){
-    Nullcheck_mpd(d, p, GSL_NAN)
+/* A probit on each column of X beta. If the outcome is a single zero/one option,
+ that's one column against the outcome vector itself; else, column i is
+ category i against everything else. */
+static double probit_ll_xbeta(apop_data *d, gsl_matrix *xbeta, apop_model *p){
     gsl_vector *val_vector = get_category_table(d)->vector;
-    if (val_vector->size==2) return biprobit_log_likelihood(d, p);
-    //else, multinomial loop
-    static apop_model *spare_probit = NULL;
-    if (!spare_probit){
-        spare_probit = apop_model_copy(apop_probit);
-        spare_probit->parameters = apop_data_alloc();
-    }
-    Staticdef(apop_data *, working_data, apop_data_alloc());
-    working_data->matrix = d->matrix;
-    gsl_vector *original_outcome = d->vector;
     double ll = 0;
-    double *vals = val_vector->data;
-    for(size_t i=0; i < p->parameters->matrix->size2; i++){
-        Apop_col(p->parameters, i, param);
-        val = vals[i];
-        working_data->vector = apop_vector_map(original_outcome, unordered);
-        spare_probit->parameters->matrix = apop_vector_to_matrix(param);
-        ll  += apop_log_likelihood(working_data, spare_probit);
-        gsl_vector_free(working_data->vector); //yup. It's inefficient.
-        gsl_matrix_free(spare_probit->parameters->matrix);
+    apop_arena_push(); //onecol and the recoded outcomes are scratch, released at the pop.
+    apop_data *onecol = apop_data_alloc();
+    gsl_vector *is_i = val_vector->size==2 ? d->vector : apop_arena_vector(onecol, d->vector->size, 0);
+    for(size_t i=0; i < xbeta->size2; i++){
+        gsl_matrix_view xbeta_i = gsl_matrix_submatrix(xbeta, 0, i, xbeta->size1, 1);
+        onecol->matrix = &xbeta_i.matrix;
+        if (val_vector->size!=2)
+            for (size_t j=0; j< d->vector->size; j++)
+                gsl_vector_set(is_i, j, gsl_vector_get(d->vector, j) == val_vector->data[i]);
+        onecol->vector = is_i;
+        ll += apop_map_sum(onecol, .fn_r=biprobit_ll_row);
     }
+    apop_arena_pop();
+	return ll;
+}
+
+static double probit_log_likelihood(apop_data *d, apop_model *p){
+    Nullcheck_mpd(d, p, GSL_NAN)
+    apop_arena_push(); //betadotx and its names are scratch, released at the pop.
+    apop_data *betadotx = apop_dot(d, p->parameters); 
+    double ll = probit_ll_xbeta(d, betadotx->matrix, p);
+    apop_arena_pop();
 	return ll;
 }
 
@@ -128,8 +129,8 @@ static void probit_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_mode
 	apop_data_free(betadotx);
 }
 
-apop_model apop_probit = {"Probit", .log_likelihood = multiprobit_log_likelihood, .dsize=-1,
-    .score = probit_dlog_likelihood, .prep = probit_prep};
+apop_model apop_probit = {"Probit", .log_likelihood = probit_log_likelihood, .dsize=-1, .estimate = probit_estimate,
+    .log_likelihood_xbeta = probit_ll_xbeta, .score = probit_dlog_likelihood, .prep = probit_prep};
 
 
 /* \amodel apop_multinomial_probit The Multinomial Probit model.
@@ -138,8 +139,8 @@ apop_model apop_probit = {"Probit", .log_likelihood = multiprobit_log_likelihood
 
 /////////  Multinomial Logit (plain logit is a special case)
 
-static void logit_prep(apop_data *d, apop_model *m){
-    probit_prep(d, m);
+//For the general MLE, which can't start from zero the way Newton's method can.
+static void logit_starting_point(apop_model *m){
     apop_mle_settings *sets = apop_settings_get_group(m, apop_mle);
     if (sets && sets->starting_pt) return;
     /*Because of the exponentiation, it's easy to get overflows. If the user
@@ -217,24 +218,35 @@ double one_logit_row(apop_data *thisobservation, void *factor_list){
      mentioned in the documentation.  Don't forget the implicit beta_0, fixed at 
      zero (so we need to add exp(0-max)). */
 
+    //The row is left as is, because it may be a cached X beta; see log_likelihood_xbeta.
     double max = gsl_vector_max(thisrow);
-    gsl_vector_add_constant(thisrow, -max);
-    apop_vector_exp(thisrow);
-    //return num - (max + log(apop_vector_sum(thisrow) +exp(-max)));
+    long double sum = 0;
+    for (size_t i=0; i< thisrow->size; i++)
+        sum += exp(gsl_vector_get(thisrow, i) - max);
+    //return num - (max + log(sum +exp(-max)));
     long double expmax = expl(-max);
-    return num - (max + (isfinite(expmax)? logl(apop_vector_sum(thisrow) +  expmax) : -max) );
+    return num - (max + (isfinite(expmax)? logl(sum +  expmax) : -max) );
+}
+
+static double logit_ll_xbeta(apop_data *d, gsl_matrix *xbeta, apop_model *p){
+    double* factor_list = get_category_table(p->data)->vector->data;
+    apop_arena_push();
+    apop_data *xb = apop_data_alloc();
+    xb->matrix = xbeta;
+    xb->vector = d->vector; //we'll need this in one_logit_row
+    long double ll = apop_map_sum(xb, .fn_rp = one_logit_row, .param=factor_list);
+    apop_arena_pop();
+	return ll;
 }
 
 static double multilogit_log_likelihood(apop_data *d, apop_model *p){
     Nullcheck_mpd(d, p, GSL_NAN)
     Nullcheck(d->matrix, GSL_NAN)
     //Find X\beta_i for each row of X and each column of \beta.
+    apop_arena_push();
     apop_data  *xbeta = apop_dot(d, p->parameters);
-    double* factor_list = get_category_table(p->data)->vector->data;
-    xbeta->vector = d->vector; //we'll need this in one_logit_row
-    long double ll = apop_map_sum(xbeta, .fn_rp = one_logit_row, .param=factor_list);
-    xbeta->vector = NULL;
-    apop_data_free(xbeta);
+    double ll = logit_ll_xbeta(d, xbeta->matrix, p);
+    apop_arena_pop();
 	return ll;
 }
 
@@ -288,6 +300,243 @@ static void logit_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model
 }
 */
 
+/////////  Newton-Raphson (logit) and Fisher scoring (probit)
+
+/* Both models' log likelihoods depend on the parameters via X beta, so the score is
+ X' R for a matrix of residuals R, and the information matrix is made of blocks X' W X,
+ one for each pair of option columns. The engine below gathers those in blocks of rows
+ (so the products are matrix-matrix, via BLAS), with the row range split across threads.
+
+ Within the engine, the information matrix is ordered option-major (index j*K+k, for
+ option j and variable k) so each X' W X block is a contiguous submatrix; the score and
+ the covariance use the parameters' own order (k*J+j). */
+
+#define Irls_block 256
+
+typedef struct {
+    gsl_matrix *x, *beta;
+    gsl_vector *y;
+    double *factors;
+    size_t factor_ct, start, end;
+    char is_logit;
+    gsl_matrix *score, *info;
+    long double ll;
+} irls_chunk;
+
+//Fill r (residuals) and w (probit: weights; logit: probabilities) for one row.
+static long double irls_row(irls_chunk *c, double y, double const *eta, double *r, double *w){
+    size_t J = c->beta->size2;
+    long double ll = 0;
+    if (c->is_logit){
+        size_t choice = find_index(y, c->factors, J);
+        double max = 0;
+        for (size_t j=0; j< J; j++) max = GSL_MAX(max, eta[j]);
+        long double sum = exp(-max);
+        for (size_t j=0; j< J; j++) sum += exp(eta[j] - max);
+        double lse = max + logl(sum);
+        for (size_t j=0; j< J; j++){
+            w[j] = exp(eta[j] - lse);
+            r[j] = (choice == j+1) - w[j];
+        }
+        return (choice ? eta[choice-1] : 0) - lse;
+    }
+    for (size_t j=0; j< J; j++){
+        int is_j = c->factor_ct == 2 ? y != 0 : y == c->factors[j];
+        double n = gsl_cdf_gaussian_P(-eta[j], 1);
+        n = n ? n : 1e-10; //as in biprobit_ll_row.
+        n = n<1 ? n : 1-1e-10; 
+        double pdf = gsl_ran_gaussian_pdf(eta[j], 1);
+        ll += is_j ? log(1-n) : log(n);
+        r[j] = is_j ? pdf/(1-n) : -pdf/n;
+        w[j] = pdf*pdf/(n*(1-n));
+    }
+    return ll;
+}
+
+static void *irls_accumulate(void *in){
+    irls_chunk *c = in;
+    size_t K = c->x->size2, J = c->beta->size2;
+    gsl_matrix *eta = gsl_matrix_alloc(Irls_block, J),
+               *resid = gsl_matrix_alloc(Irls_block, J),
+               *w = gsl_matrix_alloc(Irls_block, J),
+               *scaled = gsl_matrix_alloc(Irls_block, K);
+    gsl_matrix_set_zero(c->score);
+    gsl_matrix_set_zero(c->info);
+    c->ll = 0;
+    for (size_t s=c->start; s< c->end; s+= Irls_block){
+        size_t b = GSL_MIN(Irls_block, c->end - s);
+        gsl_matrix_view xb = gsl_matrix_submatrix(c->x, s, 0, b, K);
+        gsl_matrix_view eta_b = gsl_matrix_submatrix(eta, 0, 0, b, J);
+        gsl_matrix_view r_b = gsl_matrix_submatrix(resid, 0, 0, b, J);
+        gsl_matrix_view scaled_b = gsl_matrix_submatrix(scaled, 0, 0, b, K);
+        gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, &xb.matrix, c->beta, 0, &eta_b.matrix);
+        for (size_t i=0; i< b; i++)
+            c->ll += irls_row(c, gsl_vector_get(c->y, s+i), eta->data + i*eta->tda,
+                                            resid->data + i*resid->tda, w->data + i*w->tda);
+        gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, &xb.matrix, &r_b.matrix, 1, c->score);
+        for (size_t j=0; j< J; j++)
+            for (size_t jj=j; jj< (c->is_logit ? J : j+1); jj++){
+                for (size_t i=0; i< b; i++){
+                    double const *wi = w->data + i*w->tda;
+                    double wt = c->is_logit ? wi[j]*((j==jj) - wi[jj]) : wi[j];
+                    for (size_t k=0; k< K; k++)
+                        scaled->data[i*scaled->tda + k] = wt * xb.matrix.data[i*xb.matrix.tda + k];
+                }
+                gsl_matrix_view block = gsl_matrix_submatrix(c->info, j*K, jj*K, K, K);
+                gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, &scaled_b.matrix, &xb.matrix, 1, &block.matrix);
+            }
+    }
+    gsl_matrix_free(eta); gsl_matrix_free(resid);
+    gsl_matrix_free(w); gsl_matrix_free(scaled);
+    return NULL;
+}
+
+/* One pass over the data at c[0].beta: the log likelihood, the score, and the full
+ (symmetric) information matrix, all summed into c[0]. */
+static long double irls_pass(irls_chunk *c, int threadct){
+    pthread_t thread_id[threadct];
+    for (int t=1; t< threadct; t++) pthread_create(&thread_id[t], NULL, irls_accumulate, c+t);
+    irls_accumulate(c);
+    for (int t=1; t< threadct; t++){
+        pthread_join(thread_id[t], NULL);
+        gsl_matrix_add(c[0].score, c[t].score);
+        gsl_matrix_add(c[0].info, c[t].info);
+        c[0].ll += c[t].ll;
+    }
+    for (size_t i=0; i< c->info->size1; i++)
+        for (size_t j=i+1; j< c->info->size2; j++)
+            gsl_matrix_set(c->info, j, i, gsl_matrix_get(c->info, i, j));
+    return c[0].ll;
+}
+
+//Covariance = inverse of the information matrix at the optimum, in packed-parameter order.
+static void irls_covariance(apop_model *m, gsl_matrix *chol){
+    size_t K = m->parameters->matrix->size1, J = m->parameters->matrix->size2;
+    gsl_linalg_cholesky_invert(chol);
+    apop_data *cov = apop_data_alloc(K*J, K*J);
+    for (size_t k=0; k< K; k++)
+        for (size_t j=0; j< J; j++){
+            for (size_t kk=0; kk< K; kk++)
+                for (size_t jj=0; jj< J; jj++)
+                    gsl_matrix_set(cov->matrix, k*J+j, kk*J+jj, gsl_matrix_get(chol, j*K+k, jj*K+kk));
+            char *name;
+            asprintf(&name, "%s: %s", XN(m->parameters->names->colct > j ? m->parameters->names->column[j] : NULL),
+                                      XN(m->parameters->names->rowct > k ? m->parameters->names->row[k] : NULL));
+            apop_name_add(cov->names, name, 'r');
+            apop_name_add(cov->names, name, 'c');
+            free(name);
+        }
+    apop_data_add_page(m->parameters, cov, "<Covariance>");
+}
+
+/* Newton steps, halved as needed so the log likelihood never falls, until the
+ predicted improvement (half the score times the step) is below 1e-10 (scaled by the
+ log likelihood), or the norm of the score is below grad_tol, as in the gradient-based
+ MLE searches. Returns 0 on convergence, 1 if the iteration limit ran out, 2 if even a
+ step halved to a millionth lowered the log likelihood (the parameters and ll_out are then
+ those from before the failed step), and -1 if the information matrix wasn't positive
+ definite. Either way, info_out is the Cholesky decomposition of the information matrix
+ at the final parameters. */
+static int irls_search(apop_data *d, apop_model *m, char is_logit, double grad_tol, int max_iterations,
+                                                    gsl_matrix *info_out, long double *ll_out){
+    gsl_matrix *beta = m->parameters->matrix;
+    size_t n = d->matrix->size1, K = beta->size1, J = beta->size2;
+    apop_data *factor_list = get_category_table(d);
+    int threadct = GSL_MAX(1, GSL_MIN(apop_opts.thread_count, n/1000));
+    irls_chunk c[threadct];
+    for (int t=0; t< threadct; t++)
+        c[t] = (irls_chunk){.x = d->matrix, .y = d->vector, .beta = beta, .is_logit = is_logit,
+                            .factors = factor_list->vector->data, .factor_ct = factor_list->vector->size,
+                            .start = n*t/threadct, .end = n*(t+1)/threadct,
+                            .score = gsl_matrix_alloc(K, J), .info = gsl_matrix_alloc(J*K, J*K)};
+    gsl_vector *g = gsl_vector_alloc(J*K), *step = gsl_vector_alloc(J*K);
+    gsl_matrix *prior_beta = gsl_matrix_alloc(K, J);
+    gsl_error_handler_t *prior_handler = gsl_set_error_handler_off();
+    long double ll = irls_pass(c, threadct);
+    int status;
+    for (int iter=0; ; iter++){
+        for (size_t j=0; j< J; j++)
+            for (size_t k=0; k< K; k++)
+                gsl_vector_set(g, j*K+k, gsl_matrix_get(c->score, k, j));
+        gsl_matrix_memcpy(info_out, c->info);
+        if (gsl_linalg_cholesky_decomp(info_out)) {status = -1; break;}
+        gsl_linalg_cholesky_solve(info_out, g, step);
+        double improvement;
+        gsl_blas_ddot(g, step, &improvement);
+        if (improvement/2 < 1e-10*(1+fabsl(ll)) || gsl_blas_dnrm2(g) < grad_tol) {status = 0; break;}
+        if (iter >= max_iterations) {status = 1; break;} //after the decomposition, so it matches beta.
+        gsl_matrix_memcpy(prior_beta, beta);
+        long double new_ll;
+        double scale;
+        for (scale=1; scale >= 1e-6; scale/=2){
+            for (size_t j=0; j< J; j++)
+                for (size_t k=0; k< K; k++)
+                    gsl_matrix_set(beta, k, j, gsl_matrix_get(prior_beta, k, j) + scale*gsl_vector_get(step, j*K+k));
+            new_ll = irls_pass(c, threadct);
+            if (new_ll >= ll - 1e-12*fabsl(ll)) break; //false for NaN, so that halves too.
+        }
+        if (scale < 1e-6){ //no step along this direction helps; go back to where info_out was taken.
+            gsl_matrix_memcpy(beta, prior_beta);
+            status = 2;
+            break;
+        }
+        ll = new_ll;
+    }
+    gsl_set_error_handler(prior_handler);
+    for (int t=0; t< threadct; t++){
+        gsl_matrix_free(c[t].score);
+        gsl_matrix_free(c[t].info);
+    }
+    gsl_vector_free(g); gsl_vector_free(step);
+    gsl_matrix_free(prior_beta);
+    *ll_out = ll;
+    return status;
+}
+
+static apop_model *index_model_estimate(apop_data *d, apop_model *m, char is_logit){
+    Nullcheck_mpd(d, m, NULL);
+    apop_mle_settings *mp = apop_settings_get_group(m, apop_mle);
+    if (!mp || mp->method == APOP_UNKNOWN_ML){
+        size_t KJ = m->parameters->matrix->size1 * m->parameters->matrix->size2;
+        gsl_matrix_set_zero(m->parameters->matrix);
+        if (mp && mp->starting_pt)
+            for (size_t i=0; i< KJ; i++) m->parameters->matrix->data[i] = mp->starting_pt[i];
+        gsl_matrix *chol = gsl_matrix_alloc(KJ, KJ);
+        long double ll;
+        int status = irls_search(d, m, is_logit, mp ? mp->tolerance : 0,
+                                                 mp ? mp->max_iterations : 100, chol, &ll);
+        Apop_stopif(status == 1, /*continue*/, 1, "Max iterations reached, implying that I did not find an optimum.");
+        if (status == 0 || status == 1){
+            apop_parts_wanted_settings *want = apop_settings_get_group(m, apop_parts_wanted);
+            if (!want || want->covariance=='y') irls_covariance(m, chol);
+            gsl_matrix_free(chol);
+            Get_vmsizes(d); //msize1, tsize
+            apop_data_add_named_elmt(m->info, "status", status);
+            apop_data_add_named_elmt(m->info, "log likelihood", ll);
+            apop_data_add_named_elmt(m->info, "AIC", 2*KJ - 2*ll);
+            apop_data_add_named_elmt(m->info, "BIC by row", KJ * log(msize1) - 2*ll);
+            apop_data_add_named_elmt(m->info, "BIC by item", KJ * log(tsize) - 2*ll);
+            return m;
+        }
+        gsl_matrix_free(chol);
+        if (status == 2){
+            Apop_notify(1, "No Newton step, however short, raised the log likelihood (%Lg), "
+                           "so I'm using the general maximum likelihood search.", ll);
+        } else {
+            Apop_notify(1, "The information matrix isn't positive definite (are some columns of "
+                           "the data collinear?), so I'm using the general maximum likelihood search.");
+        }
+        gsl_matrix_set_all(m->parameters->matrix, 1);
+    }
+    if (is_logit) logit_starting_point(m);
+    return apop_maximum_likelihood(d, m);
+}
+
+/* \adoc estimated_info Reports <tt>status</tt> (zero on convergence, one if the iterations ran out), <tt>log likelihood</tt>, <tt>AIC</tt>, <tt>BIC by row</tt>, and <tt>BIC by item</tt>. */
+static apop_model *logit_estimate(apop_data *d, apop_model *m){ return index_model_estimate(d, m, 1); }
+
+static apop_model *probit_estimate(apop_data *d, apop_model *m){ return index_model_estimate(d, m, 0); }
+
 //Should this be available everywhere?
 static size_t get_draw_size(apop_model *in){
     Get_vmsizes(in->data); //msize2, firstcol
@@ -357,6 +606,12 @@ Also, if there is no vector, then I will move the first column of the matrix, an
 replace that matrix column with a constant column of ones, just like with OLS.
 
 \adoc    settings   None, but see above about seeking a factor page in the input data.
+\adoc    Estimate_results  Newton's method, which converges in a handful of passes through the data and
+gives the covariance of the parameters (on the <tt>\<Covariance\></tt> page) as a
+by-product. If you attach an \ref apop_mle_settings group with a <tt>method</tt>, then I
+use the maximum likelihood search you asked for instead. If the group has no <tt>method</tt>, I
+stop after its <tt>max_iterations</tt> (else 100) steps, or once the norm of the score is below
+its <tt>tolerance</tt>, as with the gradient-based searches.
 
 \adoc RNG Much like the \ref apop_ols RNG, qv. Returns the category drawn.
 
@@ -373,6 +628,7 @@ Here is an artifical example:
 
 \include fake_logit.c
 */
-apop_model apop_logit = {.name="Logit", .log_likelihood = multilogit_log_likelihood, .dsize=-1,
-/*.score = logit_dlog_likelihood,*/ .predict=multilogit_expected, .prep = logit_prep, .draw=logit_rng
+apop_model apop_logit = {.name="Logit", .log_likelihood = multilogit_log_likelihood, .dsize=-1, .estimate = logit_estimate,
+    .log_likelihood_xbeta = logit_ll_xbeta,
+/*.score = logit_dlog_likelihood,*/ .predict=multilogit_expected, .prep = probit_prep, .draw=logit_rng
 };
@@ -59,6 +59,55 @@ double apop_tdist_llike(apop_data *d, apop_model *m){
     return apop_map_sum(d, .fn_dp=one_t, .param=params);
 }
 
+/* The same log likelihood, in dual numbers. With z = (x-mu)*sqrt(df)/sigma,
+ ln t(z; df) = lnGamma((df+1)/2) - lnGamma(df/2) - ln(df pi)/2 - (df+1)/2 ln(1 + z^2/df),
+ and z^2/df = ((x-mu)/sigma)^2. */
+static apop_dual apop_tdist_llike_dual(apop_data *d, apop_dual const *params, apop_model *m){
+    Get_vmsizes(d) //vsize, msize1, msize2, tsize
+    apop_dual mu = params[0], sigma = params[1], df = params[2];
+    apop_dual sum_log_sq = apop_dual_alloc(0);  //sum of ln(1 + ((x-mu)/sigma)^2)
+    for (size_t i=0; i< tsize; i++){
+        double x = i < vsize ? gsl_vector_get(d->vector, i)
+                             : gsl_matrix_get(d->matrix, (i-vsize)/msize2, (i-vsize)%msize2);
+        apop_arena_push();
+        apop_dual u = apop_dual_div(apop_dual_affine(mu, -1, x), sigma);
+        apop_dual_accumulate(&sum_log_sq, apop_dual_log(apop_dual_affine(apop_dual_mul(u, u), 1, 1)));
+        apop_arena_pop();
+    }
+    apop_dual per_obs = apop_dual_sub(apop_dual_lgamma(apop_dual_affine(df, .5, .5)),
+                                      apop_dual_lgamma(apop_dual_affine(df, .5, 0)));
+    per_obs = apop_dual_sub(per_obs, apop_dual_affine(apop_dual_log(apop_dual_affine(df, M_PI, 0)), .5, 0));
+    return apop_dual_sub(apop_dual_affine(per_obs, tsize, 0),
+                         apop_dual_mul(apop_dual_affine(df, .5, .5), sum_log_sq));
+}
+
+/* With u = (x-mu)/sigma, each element contributes -(df+1)/2 ln(1+u^2) to the log likelihood,
+ which is all that depends on mu and sigma; the rest is a per-element constant in df. */
+static double apop_tdist_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *m){
+    Nullcheck_mpd(d, m, GSL_NAN);
+    Get_vmsizes(d) //tsize
+    double mu = m->parameters->vector->data[0];
+    double sigma = m->parameters->vector->data[1];
+    double df = m->parameters->vector->data[2];
+    long double sum_log_sq = 0, d_mu = 0, d_sigma = 0;
+    Apop_data_elements(d, x,
+        double u = (x-mu)/sigma;
+        double one_u2 = 1 + u*u;
+        sum_log_sq += log(one_u2);
+        d_mu += u/one_u2;
+        d_sigma += u*u/one_u2;
+    )
+    double per_obs = gsl_sf_lngamma((df+1)/2) - gsl_sf_lngamma(df/2) - log(df*M_PI)/2;
+    gsl_vector_set(gradient, 0, (df+1)*d_mu/sigma);
+    gsl_vector_set(gradient, 1, (df+1)*d_sigma/sigma);
+    gsl_vector_set(gradient, 2, (gsl_sf_psi((df+1)/2) - gsl_sf_psi(df/2) - 1/df)*tsize/2 - sum_log_sq/2);
+    return per_obs*tsize - (df+1)/2*sum_log_sq;
+}
+
+static void apop_tdist_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
+    apop_tdist_ll_and_score(d, gradient, m);
+}
+
 double apop_chisq_llike(apop_data *d, apop_model *m){ 
     Nullcheck_mpd(d, m, GSL_NAN);
     return apop_map_sum(d, .fn_dp=one_chisq, .param =m->parameters->vector->data);
@@ -69,6 +118,52 @@ double apop_fdist_llike(apop_data *d, apop_model *m){
     return apop_map_sum(d, .fn_dp=one_f, .param =m->parameters->vector->data);
 }
 
+/* ln chi^2(x; df) = (df/2-1) ln x - x/2 - (df/2) ln 2 - lnGamma(df/2). */
+static double apop_chisq_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *m){
+    Nullcheck_mpd(d, m, GSL_NAN);
+    Get_vmsizes(d) //tsize
+    double df = m->parameters->vector->data[0];
+    long double lnsum = 0, xsum = 0;
+    Apop_data_elements(d, x,
+        lnsum += log(x);
+        xsum += x;
+    )
+    gsl_vector_set(gradient, 0, (lnsum - (M_LN2 + gsl_sf_psi(df/2))*tsize)/2);
+    return (df/2-1)*lnsum - xsum/2 - (df/2*M_LN2 + gsl_sf_lngamma(df/2))*tsize;
+}
+
+static void apop_chisq_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
+    apop_chisq_ll_and_score(d, gradient, m);
+}
+
+/* ln F(x; df, df2) = (df ln df + df2 ln df2)/2 + (df/2-1) ln x - (df+df2)/2 ln(df2 + df x)
+                      - ln B(df/2, df2/2). */
+static double apop_fdist_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *m){
+    Nullcheck_mpd(d, m, GSL_NAN);
+    Get_vmsizes(d) //tsize
+    double df = m->parameters->vector->data[0];
+    double df2 = m->parameters->vector->data[1];
+    long double lnsum = 0, ln_denom_sum = 0, d_df = 0, d_df2 = 0;
+    Apop_data_elements(d, x,
+        double denom = df2 + df*x;
+        lnsum += log(x);
+        ln_denom_sum += log(denom);
+        d_df += x/denom;
+        d_df2 += 1/denom;
+    )
+    double psi_both = gsl_sf_psi((df+df2)/2);
+    gsl_vector_set(gradient, 0, (lnsum - ln_denom_sum - (df+df2)*d_df
+                          + (log(df) + 1 - gsl_sf_psi(df/2) + psi_both)*tsize)/2);
+    gsl_vector_set(gradient, 1, (-ln_denom_sum - (df+df2)*d_df2
+                          + (log(df2) + 1 - gsl_sf_psi(df2/2) + psi_both)*tsize)/2);
+    return (df/2-1)*lnsum - (df+df2)/2*ln_denom_sum
+            + ((df*log(df) + df2*log(df2))/2 - gsl_sf_lnbeta(df/2, df2/2))*tsize;
+}
+
+static void apop_fdist_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
+    apop_fdist_ll_and_score(d, gradient, m);
+}
+
 void apop_t_dist_draw(double *out, gsl_rng *r, apop_model *m){ 
     Nullcheck_mp(m, );
     double mu = m->parameters->vector->data[0];
@@ -300,12 +395,14 @@ If you want to test a hypothesis, you probably don't need this, and should inste
 \adoc    Parameter_format  vector->data[0] = mu<br>
                             vector->data[1] = sigma<br>
                             vector->data[2] = df 
-\adoc    Estimate_results  I'll just count elements and set \f$df = n-1\f$. If you set the \c estimate method to \c NULL, via MLE.
+\adoc    Estimate_results  I'll just count elements and set \f$df = n-1\f$. If you set the \c estimate method to \c NULL, via MLE, with exact derivatives from the \ref apop_dual form of the log likelihood.
 \adoc    settings   \ref apop_mle_settings, \ref apop_parts_wanted_settings   
 */
 
 apop_model apop_t_distribution  = {"t distribution", 3, .dsize=1, .estimate = apop_t_estimate, 
-         .log_likelihood = apop_tdist_llike, .draw=apop_t_dist_draw, .cdf=apop_t_dist_cdf,
+         .log_likelihood = apop_tdist_llike, .log_likelihood_dual = apop_tdist_llike_dual,
+         .score = apop_tdist_dlog_likelihood, .log_likelihood_score = apop_tdist_ll_and_score,
+         .draw=apop_t_dist_draw, .cdf=apop_t_dist_cdf,
          .constraint=apop_t_dist_constraint };
 
 /*\amodel apop_f_distribution The F distribution, for descriptive purposes.
@@ -321,7 +418,8 @@ This model is under development, and is of beta-quality.
 \adoc    settings   \ref apop_mle_settings    
 */
 apop_model apop_f_distribution  = {"F distribution", 2, .dsize=1, .estimate = apop_fdist_estimate, 
-        .log_likelihood = apop_fdist_llike, .draw=apop_f_dist_draw };
+        .log_likelihood = apop_fdist_llike, .score = apop_fdist_dlog_likelihood,
+        .log_likelihood_score = apop_fdist_ll_and_score, .draw=apop_f_dist_draw };
 
 /*\amodel apop_chi_squared The \f$\chi^2\f$ distribution, for descriptive purposes.
 
@@ -335,4 +433,5 @@ apop_model apop_f_distribution  = {"F distribution", 2, .dsize=1, .estimate = ap
 */
 
 apop_model apop_chi_squared  = {"Chi squared distribution", 1, .dsize=1, .estimate = apop_chi_estimate,  
-        .log_likelihood = apop_chisq_llike, .draw=apop_chisq_dist_draw };
+        .log_likelihood = apop_chisq_llike, .score = apop_chisq_dlog_likelihood,
+        .log_likelihood_score = apop_chisq_ll_and_score, .draw=apop_chisq_dist_draw };
@@ -55,34 +55,30 @@ static double waring_log_likelihood(apop_data *d, apop_model *m){
 	return likelihood;
 }
 
-static double dapply_a(double val, void *in){
-    ab_type *ab = in;
-    long double psi_a_k	   = gsl_sf_psi(val + ab->a);
-    long double psi_bb_a_k = gsl_sf_psi(val + ab->a + ab->bb);
-    return psi_a_k - psi_bb_a_k;
-}
-
-static double dapply_b(double val, void *in){
-    ab_type *ab = in;
-    long double psi_bb_a_k = gsl_sf_psi(val + ab->a + ab->bb);
-    return -psi_bb_a_k;
+/* Each element's psi(x+a+b) appears in both elements of the score, so the fused
+ version does the psi and lngamma calls for an element once, on one pass. */
+static double waring_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *m){
+	//Psi is the derivative of the log gamma function.
+    Nullcheck_mpd(d, m, GSL_NAN);
+    Get_vmsizes(d) //tsize
+    double bb = gsl_vector_get(m->parameters->vector, 0),
+           a  = gsl_vector_get(m->parameters->vector, 1);
+    long double ll = 0, d_bb = 0, d_a = 0;
+    Apop_data_elements(d, x,
+        ll += gsl_sf_lngamma(x + a) - gsl_sf_lngamma(x + a + bb);
+        double psi_bb_a_k = gsl_sf_psi(x + a + bb);
+        d_bb -= psi_bb_a_k;
+        d_a  += gsl_sf_psi(x + a) - psi_bb_a_k;
+    )
+    double	psi_a_bb	  = gsl_sf_psi(bb + a),
+      	    psi_a_mas_one = gsl_sf_psi(a+1);
+	gsl_vector_set(gradient, 0, d_bb + (1./(bb-1) + psi_a_bb) *tsize);
+	gsl_vector_set(gradient, 1, d_a + (psi_a_bb- psi_a_mas_one) * tsize);
+	return ll + (log(bb - 1) + gsl_sf_lngamma(bb + a) - gsl_sf_lngamma(a + 1))* tsize;
 }
 
 /*static*/ void waring_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
-	//Psi is the derivative of the log gamma function.
-    Nullcheck_mpd(d, m, );
-    Get_vmsizes(d) //tsize
-    ab_type ab = {.bb = gsl_vector_get(m->parameters->vector, 0),
-                  .a  = gsl_vector_get(m->parameters->vector, 1)};
-    double d_bb = apop_map_sum(d, .fn_dp=dapply_b, .param=&ab);
-    double d_a  = apop_map_sum(d, .fn_dp=dapply_a, .param=&ab);
-    double	bb_minus_one_inv = 1./(ab.bb-1),
-      	    psi_a_bb	  = gsl_sf_psi(ab.bb + ab.a),
-      	    psi_a_mas_one = gsl_sf_psi(ab.a+1);
-	d_bb += (bb_minus_one_inv + psi_a_bb) *tsize;
-	d_a	 += (psi_a_bb- psi_a_mas_one) * tsize;
-	gsl_vector_set(gradient, 0, d_bb);
-	gsl_vector_set(gradient, 1, d_a);
+    waring_ll_and_score(d, gradient, m);
 }
 
 /* \adoc RNG Give me parameters, and I'll draw a ranking from the appropriate
@@ -115,4 +111,5 @@ static void waring_rng(double *out, gsl_rng *r, apop_model *eps){
 
 apop_model apop_waring = {"Waring distribution", 2,0,0, .dsize=1,
 	 .log_likelihood =  waring_log_likelihood, .score = waring_dlog_likelihood,
+     .log_likelihood_score = waring_ll_and_score,
      .constraint =  beta_zero_and_one_greater_than_x_constraint,  .draw = waring_rng};
@@ -38,8 +38,6 @@ static double  apply_me(double pt, void *bb){
     return ln_k - ln_bb_k;
 }
 
-static double  dapply_me(double pt, void *bb){ return -gsl_sf_psi(pt+*(double*)bb); }
-
 static double yule_log_likelihood(apop_data *d, apop_model *m){
   Nullcheck_mpd(d, m, GSL_NAN);
   Get_vmsizes(d) //tsize
@@ -50,16 +48,23 @@ static double yule_log_likelihood(apop_data *d, apop_model *m){
 	return likelihood + (ln_bb_less_1 + ln_bb) * tsize;
 }
 
-static void yule_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
-  Nullcheck_mpd(d, m, );
+//The log likelihood and score on one pass through the data.
+static double yule_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *m){
+  Nullcheck_mpd(d, m, GSL_NAN);
   Get_vmsizes(d) //tsize
 	//Psi is the derivative of the log gamma function.
     double bb  = gsl_vector_get(m->parameters->vector, 0);
-    long double bb_minus_one_inv= 1/(bb-1),
-		        psi_bb	        = gsl_sf_psi(bb);
-    double d_bb  = apop_map_sum(d, .fn_dp=dapply_me, .param=&bb);
-    d_bb += (bb_minus_one_inv + psi_bb) * tsize;
-	gsl_vector_set(gradient, 0, d_bb);
+    long double ll = 0, d_bb = 0;
+    Apop_data_elements(d, pt,
+        ll += (pt>=1 ? gsl_sf_lngamma(pt) : 0) - gsl_sf_lngamma(pt+bb);
+        d_bb -= gsl_sf_psi(pt+bb);
+    )
+	gsl_vector_set(gradient, 0, d_bb + (1/(bb-1) + gsl_sf_psi(bb)) * tsize);
+	return ll + (log(bb-1) + gsl_sf_lngamma(bb)) * tsize;
+}
+
+static void yule_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
+    yule_ll_and_score(d, gradient, m);
 }
 
 /* \adoc RNG Cribbed from <a href="http://cgm.cs.mcgill.ca/~luc/mbookindex.html>Devroye (1986)</a>, p 553.  */
@@ -71,4 +76,5 @@ static void yule_rng( double *out, gsl_rng * r, apop_model *a){
 }
 
 apop_model apop_yule = {"Yule distribution", 1,0,0, .dsize=1, .log_likelihood = yule_log_likelihood, 
-    .score = yule_dlog_likelihood, .constraint = yule_constraint, .draw = yule_rng};
+    .score = yule_dlog_likelihood, .log_likelihood_score = yule_ll_and_score,
+    .constraint = yule_constraint, .draw = yule_rng};
@@ -37,6 +37,37 @@ static double zipf_log_likelihood(apop_data *d, apop_model *m){
     double like = -apop_map_sum(d, log) * bb;
     like -= log(gsl_sf_zeta(bb)) * tsize;
     return like;
+}
+
+/* The GSL has no derivative of the zeta function, so sum d zeta(s)/ds = -sum_{n>=2} ln(n)/n^s
+ directly up to N, and use the Euler-Maclaurin formula (through the third derivative) for the tail. */
+static double zeta_deriv(double s){
+    int N = 20;
+    double sum = 0;
+    for (int n=2; n< N; n++) sum += log(n)*pow(n, -s);
+    double L = log(N), s1 = s-1;
+    sum += pow(N, -s1)*(L/s1 + 1/(s1*s1))                        //integral from N on
+         + L*pow(N, -s)/2                                        //f(N)/2
+         - pow(N, -s-1)*(1 - s*L)/12                             //-f'(N)/12
+         + pow(N, -s-3)*(3*s*s + 6*s + 2 - s*(s+1)*(s+2)*L)/720; //f'''(N)/720
+    return -sum;
+}
+
+static double zipf_ll_and_score(apop_data *d, gsl_vector *gradient, apop_model *m){
+    Nullcheck_mpd(d, m, GSL_NAN);
+    Get_vmsizes(d) //tsize
+    double bb = apop_data_get(m->parameters, 0, -1);
+    Apop_stopif(isnan(bb) || bb < 1, return GSL_NAN, 0, "Zipf needs a parameter >=1; "
+                                              "got %g. Returning NaN.", bb); 
+    long double lnsum = 0;
+    Apop_data_elements(d, x, lnsum += log(x);)
+    double zeta = gsl_sf_zeta(bb);
+    gsl_vector_set(gradient, 0, -lnsum - zeta_deriv(bb)/zeta * tsize);
+    return -lnsum * bb - log(zeta) * tsize;
+}
+
+static void zipf_dlog_likelihood(apop_data *d, gsl_vector *gradient, apop_model *m){
+    zipf_ll_and_score(d, gradient, m);
 }    
 
 /*  \adoc RNG Returns a ranking: If the population were Zipf distributed, you're most
@@ -63,4 +94,5 @@ static void zipf_rng(double *out, gsl_rng* r, apop_model *param){
 }
 
 apop_model apop_zipf = {"Zipf distribution", 1,0,0, .dsize=1,
-     .log_likelihood = zipf_log_likelihood, .constraint = zipf_constraint, .draw = zipf_rng};
+     .log_likelihood = zipf_log_likelihood, .score = zipf_dlog_likelihood,
+     .log_likelihood_score = zipf_ll_and_score, .constraint = zipf_constraint, .draw = zipf_rng};
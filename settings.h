@@ -13,11 +13,24 @@ extern "C" {
     //Part I: macros and fns for getting/setting settings groups and elements
 
 void * apop_settings_get_grp(apop_model *m, char *type, char fail);
+void * apop_settings_get_grp_key(apop_model *m, char *type, unsigned long key, char fail);
 void apop_settings_remove_group(apop_model *m, char *delme);
 void apop_settings_copy_group(apop_model *outm, apop_model *inm, char *copyme);
 void *apop_settings_group_alloc(apop_model *model, char *type, void *free_fn, void *copy_fn, void *the_group);
 apop_model *apop_settings_group_alloc_wm(apop_model *model, char *type, void *free_fn, void *copy_fn, void *the_group);
 
+/** \cond doxy_ignore */
+/* The settings macros know the group's name when they are compiled, so they hash it
+   then too. This is the same Dan J Bernstein hash as apop_string_hash in internal.h,
+   unrolled for names up to 48 characters; with optimization on, the compiler reduces it
+   to a constant. Longer names give zero, meaning hash at run time. */
+#define Apop_k1(s, i, h) ((h)*(((i) < sizeof(s)-1) ? 33UL : 1UL)  \
+                           + (((i) < sizeof(s)-1) ? (unsigned long)(s)[(i) < sizeof(s)-1 ? (i) : 0] : 0UL))
+#define Apop_k4(s, i, h) Apop_k1(s, (i)+3, Apop_k1(s, (i)+2, Apop_k1(s, (i)+1, Apop_k1(s, i, h))))
+#define Apop_k16(s, i, h) Apop_k4(s, (i)+12, Apop_k4(s, (i)+8, Apop_k4(s, (i)+4, Apop_k4(s, i, h))))
+#define Apop_settings_key(s) (sizeof(s) > 49 ? 0UL : Apop_k16(s, 32, Apop_k16(s, 16, Apop_k16(s, 0, 5381UL))))
+/** \endcond */
+
 /** Retrieves a settings group from a model.  See \ref Apop_settings_get
  to just pull a single item from within the settings group.
 
@@ -27,7 +40,7 @@ apop_model *apop_settings_group_alloc_wm(apop_model *model, char *type, void *fr
   \endcode
 \hideinitializer \ingroup settings
  */
-#define Apop_settings_get_group(m, type) apop_settings_get_grp(m, #type, 'c')
+#define Apop_settings_get_group(m, type) apop_settings_get_grp_key(m, #type, Apop_settings_key(#type), 'c')
 
 /** Removes a settings group from a model's list. 
  
@@ -57,13 +70,13 @@ apop_model *apop_settings_group_alloc_wm(apop_model *model, char *type, void *fr
 \hideinitializer \ingroup settings
  */
 #define Apop_settings_get(model, type, setting)  \
-    (((type ## _settings *) apop_settings_get_grp(model, #type, 'f'))->setting)
+    (((type ## _settings *) apop_settings_get_grp_key(model, #type, Apop_settings_key(#type), 'f'))->setting)
 
 /** Modifies a single element of a settings group to the given value. 
 \hideinitializer \ingroup settings
  */
 #define Apop_settings_set(model, type, setting, data)  \
-    do { type ## _settings *apop_tmp_settings = apop_settings_get_grp(model, #type, 'c');  \
+    do { type ## _settings *apop_tmp_settings = apop_settings_get_grp_key(model, #type, Apop_settings_key(#type), 'c');  \
     Apop_assert(apop_tmp_settings, "You're trying to modify a setting in " \
                         #model "'s setting group of type " #type " but that model doesn't have such a group."); \
     apop_tmp_settings->setting = (data);    \
@@ -175,6 +188,9 @@ typedef enum {
     APOP_CG_BFGS   =2,      /**<  Conjugate gradient (BFGS: Broyden-Fletcher-Goldfarb-Shanno) */
     APOP_CG_PR     =3,      /**<  Conjugate gradient (Polak-Ribiere) */
     APOP_SIMAN      =5,         /**<  \ref simanneal "simulated annealing" */
+    APOP_TEMPERING  =6,         /**<  \ref tempering "parallel tempering" */
+    APOP_SGD        =7,         /**<  \ref minibatch "Stochastic gradient descent" with Adam-style step control */
+    APOP_SGD_LBFGS  =8,         /**<  \ref minibatch "L-BFGS" with subsampled gradients */
     APOP_RF_NEWTON  =10,        /**<  Find a root of the derivative via Newton's method */
 //    APOP_RF_BROYDEN =11,        //  Find a root of the derivative via the Broyden Algorithm
     APOP_RF_HYBRID  =12,        /**<  Find a root of the derivative via the Hybrid method */
@@ -207,10 +223,31 @@ delta;
 //simulated annealing (also uses step_size);
     int         n_tries, iters_fixed_T;
     double      k, t_initial, mu_t, t_min ;
+    int         replicas; /**< For \ref tempering "parallel tempering", the number of chains, at
+                             temperatures spaced geometrically from 1 to \c t_initial. Default: 4. */
     gsl_rng     *rng;
     char        *trace_path; ///< See \ref trace_path
     apop_model  *parent;   ///< Deprecated; does nothing.
     int         use_score; ///< Deprecated; now does nothing. If you don't want to use the score, set it to \c NULL.
+    char        parallel_derivs; /**< If \c 'y', numerical gradients and Hessians split their
+                             finite differences across \ref apop_opts_type "apop_opts.thread_count" threads,
+                             each working on a private copy of the model. Your log likelihood must then
+                             be safe to call on two copies of the model at once. Default: \c 'n'. */
+    char        reuse_evals; /**< If \c 'y', \ref apop_model_hessian uses each evaluation of the
+                             score for a full column of the Hessian, at a fixed step of \c delta, rather
+                             than differentiating each element separately. This is about \f$k\f$ times
+                             fewer evaluations for \f$k\f$ parameters. Default: \c 'n'. */
+    int         starts;      /**< If more than one, run this many searches from different starting
+                             points, across up to \ref apop_opts_type "apop_opts.thread_count" threads, and
+                             return the best. See \ref apop_maximum_likelihood for details. Default: one, or
+                             the number of rows in \c start_pts if you provide them. */
+    apop_data   *start_pts;  /**< The starting points for a multi-start search, one per row of the
+                             matrix, each in \ref apop_data_pack order. If \c NULL, I draw a Latin
+                             hypercube sample in the box of half-width \c start_range around \c starting_pt.
+                             Default: \c NULL. */
+    double      start_range; /**< Half-width of the box from which I draw starting points. Default: 1. */
+    int         batch_size;  /**< For the \ref minibatch "mini-batch methods", the number of rows
+                             drawn for each step. Default: 1,000. */
 } apop_mle_settings;
 
 /** Settings for least-squares type models 
@@ -342,6 +379,7 @@ struct loess_struct {
 	struct {
 		long	*parameter, *a;
 		double	*xi, *vert, *vval;
+		struct loess_kd_eval *eval; //The above, ready for prediction. Built by loess().
 	} kd_tree;
 	struct {
 		double	*fitted_values;
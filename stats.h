@@ -31,7 +31,8 @@ APOP_VAR_DECLARE void apop_matrix_increment(gsl_matrix * m, int i, int j, double
 gsl_matrix * apop_matrix_inverse(const gsl_matrix *in) ;
 double      apop_matrix_determinant(const gsl_matrix *in) ;
 //apop_data*  apop_sv_decomposition(gsl_matrix *data, int dimensions_we_want);
-APOP_VAR_DECLARE apop_data *  apop_matrix_pca(gsl_matrix *data, int const dimensions_we_want);
+APOP_VAR_DECLARE apop_data *  apop_matrix_pca(gsl_matrix *data, int const dimensions_we_want, char method);
+APOP_VAR_DECLARE apop_data * apop_pca_query(char const *query, int dimensions_we_want, char method, int block_size);
 APOP_VAR_DECLARE gsl_vector * apop_vector_stack(gsl_vector *v1, gsl_vector * v2, char inplace);
 APOP_VAR_DECLARE gsl_matrix * apop_matrix_stack(gsl_matrix *m1, gsl_matrix * m2, char posn, char inplace);
 gsl_matrix * apop_matrix_rm_columns(gsl_matrix *in, int *drop);
@@ -88,6 +89,7 @@ gsl_vector * v = &( apop_vv_##v );
                 .matrix = apop_dd_##outd##_m.size1 ? &apop_dd_##outd##_m : NULL, \
                 .textsize[0]=(d)->textsize[0] ? (len) : 0, .textsize[1]=(d)->textsize[1],   \
                 .text = (d)->text ? &((d)->text[rownum]) : NULL,                 \
+                .textpool = (d)->textpool,                                       \
                 .names= (d)->names ? &apop_dd_##outd##_n : NULL };               \
     apop_data *outd =  &apop_dd_##outd;
 
@@ -168,12 +170,17 @@ gsl_vector * apop_vector_unique_elements(const gsl_vector *v);
 APOP_VAR_DECLARE apop_data * apop_data_to_factors(apop_data *data, char intype, int incol, int outcol);
 APOP_VAR_DECLARE apop_data * apop_data_get_factor_names(apop_data *data, int col, char type);
 
-APOP_VAR_DECLARE apop_data * apop_data_to_dummies(apop_data *d, int col, char type, int keep_first, char append, char remove);
+APOP_VAR_DECLARE apop_data * apop_data_to_dummies(apop_data *d, int col, char type, int keep_first, char append, char remove, char sparse);
 
 APOP_VAR_DECLARE double apop_kl_divergence(apop_model *from, apop_model *to, int draw_ct, gsl_rng *rng, apop_model *top, apop_model *bottom);
 
 apop_data *apop_estimate_coefficient_of_determination (apop_model *);
 void apop_estimate_parameter_tests (apop_model *est);
+apop_data *apop_ols_accumulate(apop_data const *block, apop_data *moments);
+apop_model *apop_ols_from_moments(apop_data const *moments);
+apop_data *apop_ols_add_rows(apop_data *moments, apop_data const *rows);
+apop_data *apop_ols_rm_rows(apop_data *moments, apop_data const *rows);
+APOP_VAR_DECLARE apop_model * apop_ols_query(char const *query, int block_size);
 
 
 //Bootstrapping & RNG
@@ -194,6 +201,21 @@ APOP_VAR_DECLARE apop_data * apop_model_numerical_covariance(apop_data * data, a
 
 apop_model * apop_maximum_likelihood(apop_data * data, apop_model *dist);
 
+//apop_dual.c: forward-mode differentiation
+apop_dual apop_dual_const(double val);
+apop_dual apop_dual_alloc(double val);
+apop_dual apop_dual_chain(apop_dual a, double f, double df, double d2f);
+apop_dual apop_dual_add(apop_dual a, apop_dual b);
+apop_dual apop_dual_sub(apop_dual a, apop_dual b);
+apop_dual apop_dual_mul(apop_dual a, apop_dual b);
+apop_dual apop_dual_div(apop_dual a, apop_dual b);
+apop_dual apop_dual_affine(apop_dual a, double scale, double shift);
+apop_dual apop_dual_log(apop_dual a);
+apop_dual apop_dual_exp(apop_dual a);
+apop_dual apop_dual_pow(apop_dual a, double power);
+apop_dual apop_dual_lgamma(apop_dual a);
+void apop_dual_accumulate(apop_dual *sum, apop_dual a);
+
 APOP_VAR_DECLARE apop_model * apop_estimate_restart (apop_model *e, apop_model *copy, char * starting_pt, double boundary);
 
 //in apop_linear_constraint.c
@@ -31,7 +31,7 @@ void wampler1(){
                                 pow(x,3) as p3, pow(x,4) as p4, pow(x,5) as p5 from w1");
     apop_model *est = apop_estimate(d, apop_ols);
     for (int i=0; i<6; i++)
-        assert(fabs(apop_data_get(est->parameters, i, -1) - 1) < TOL4*10);
+        assert(fabs(apop_data_get(est->parameters, i, -1) - 1) < TOL3*100);
     apop_data *cov = apop_data_get_page(est->parameters, "cov");
     for (int i=0; i<6; i++)
         assert(fabs(apop_data_get(cov, i, i)) < TOL2);
@@ -63,6 +63,7 @@ void apop_data_scale (apop_data *d, double scale){
 }
 
 #include <sys/wait.h> 
+#include <signal.h>
 static void test_printing(){
     //This compares printed output to the printed output in the attached file. 
     char outfile[] = "print_test.out";
@@ -594,6 +595,472 @@ void test_OLS(gsl_rng *r){
     apop_model_free(out);
 }
 
+//Streamed OLS---in blocks, or from a query---matches the in-memory estimate.
+void test_ols_stream(gsl_rng *r){
+    int n = 20000;
+    apop_data *d = apop_data_alloc(n, 3);
+    apop_name_add(d->names, "y", 'c');
+    apop_name_add(d->names, "x1", 'c');
+    apop_name_add(d->names, "x2", 'c');
+    for (int i=0; i< n; i++){
+        double x1 = gsl_ran_gaussian(r, 1), x2 = gsl_rng_uniform(r);
+        apop_data_set(d, i, 0, 1 + 2*x1 - 3*x2 + gsl_ran_gaussian(r, .5));
+        apop_data_set(d, i, 1, x1);
+        apop_data_set(d, i, 2, x2);
+    }
+    apop_table_exists("ols_stream", 'd');
+    apop_data_print(d, "ols_stream", .output_type='d');
+
+    apop_data *moments = NULL;
+    for (int i=0; i< n; i+= 777){
+        Apop_data_rows(d, i, GSL_MIN(777, n-i), block);
+        moments = apop_ols_accumulate(block, moments);
+    }
+    apop_model *streamed = apop_ols_from_moments(moments);
+    apop_model *queried = apop_ols_query("select * from ols_stream", .block_size=999);
+    apop_model *est = apop_estimate(d, apop_ols);
+    assert(!strcmp(streamed->parameters->names->row[2], "x2"));
+    for (int i=0; i< 3; i++){
+        Diff(apop_data_get(streamed->parameters, i, -1), apop_data_get(est->parameters, i, -1), 1e-8);
+        Diff(apop_data_get(queried->parameters, i, -1), apop_data_get(est->parameters, i, -1), 1e-8);
+        Diff(apop_data_get(streamed->parameters, i, i, .page="<Covariance>"),
+             apop_data_get(est->parameters, i, i, .page="<Covariance>"), 1e-10);
+        Diff(apop_data_get(streamed->info, i, .colname="p value", .page="<test info>"),
+             apop_data_get(est->info, i, .colname="p value", .page="<test info>"), 1e-6);
+    }
+    char *stats[] = {"SSE", "SST", "R_squared", "R_squared_adj", "log likelihood"};
+    for (int i=0; i< 5; i++)
+        Diff(apop_data_get(streamed->info, .rowname=stats[i]), apop_data_get(est->info, .rowname=stats[i]),
+                        1e-6*fabs(apop_data_get(est->info, .rowname=stats[i])));
+
+    //weights go through the streamed version, too.
+    apop_data *w = apop_data_copy(d);
+    w->weights = gsl_vector_alloc(n);
+    for (int i=0; i< n; i++) gsl_vector_set(w->weights, i, gsl_rng_uniform(r));
+    apop_data *wmoments = apop_ols_accumulate(w, NULL);
+    apop_model *wstreamed = apop_ols_from_moments(wmoments);
+    apop_model *west = apop_estimate(w, apop_ols);
+    for (int i=0; i< 3; i++){
+        Diff(apop_data_get(wstreamed->parameters, i, -1), apop_data_get(west->parameters, i, -1), 1e-8);
+        Diff(apop_data_get(wstreamed->parameters, i, i, .page="<Covariance>"),
+             apop_data_get(west->parameters, i, i, .page="<Covariance>"), 1e-10);
+    }
+    for (int i=0; i< 4; i++)
+        Diff(apop_data_get(wstreamed->info, .rowname=stats[i]), apop_data_get(west->info, .rowname=stats[i]),
+                        1e-6*fabs(apop_data_get(west->info, .rowname=stats[i])));
+
+    apop_model_free(streamed); apop_model_free(queried); apop_model_free(est);
+    apop_model_free(wstreamed); apop_model_free(west);
+    apop_data_free(moments); apop_data_free(wmoments); apop_data_free(w); apop_data_free(d);
+}
+
+//Integer weights give the same fit as repeating each row that many times, and the data isn't rescaled.
+void test_wls(gsl_rng *r){
+    int n = 500;
+    apop_data *d = apop_data_alloc(n, 3);
+    d->weights = gsl_vector_alloc(n);
+    int total = 0;
+    for (int i=0; i< n; i++){
+        double x1 = gsl_ran_gaussian(r, 1), x2 = gsl_rng_uniform(r);
+        apop_data_set(d, i, 0, 1 + 2*x1 - 3*x2 + gsl_ran_gaussian(r, .5));
+        apop_data_set(d, i, 1, x1);
+        apop_data_set(d, i, 2, x2);
+        gsl_vector_set(d->weights, i, 1 + i%3);
+        total += 1 + i%3;
+    }
+    apop_data *repeated = apop_data_alloc(total, 3);
+    for (int i=0, row=0; i< n; i++)
+        for (int j=0; j< 1 + i%3; j++, row++){
+            Apop_matrix_row(d->matrix, i, from);
+            Apop_matrix_row(repeated->matrix, row, to);
+            gsl_vector_memcpy(to, from);
+        }
+    apop_data *orig = apop_data_copy(d);
+    apop_model *w = apop_estimate(d, apop_ols);
+    for (int i=0; i< n; i++){ //the prep routine moved y to the vector; nothing was rescaled.
+        Diff(gsl_vector_get(d->weights, i), gsl_vector_get(orig->weights, i), 1e-15);
+        Diff(apop_data_get(d, i, -1), apop_data_get(orig, i, 0), 1e-15);
+        for (int j=1; j< 3; j++)
+            Diff(apop_data_get(d, i, j), apop_data_get(orig, i, j), 1e-15);
+    }
+    apop_model *rep = apop_estimate(repeated, apop_ols);
+    for (int i=0; i< 3; i++)
+        Diff(apop_data_get(w->parameters, i, -1), apop_data_get(rep->parameters, i, -1), 1e-8);
+    char *stats[] = {"SSE", "SST", "R_squared"};
+    for (int i=0; i< 3; i++)
+        Diff(apop_data_get(w->info, .rowname=stats[i]), apop_data_get(rep->info, .rowname=stats[i]),
+                        1e-8*fabs(apop_data_get(rep->info, .rowname=stats[i])));
+
+    //the predicted page is in the data's units, not scaled by the weights.
+    apop_data *predicted = apop_data_get_page(w->info, "<Predicted>");
+    for (int i=0; i< n; i+= 17){
+        double fit = apop_data_get(w->parameters, 0, -1) + apop_data_get(w->parameters, 1, -1)*apop_data_get(orig, i, 1)
+                                                         + apop_data_get(w->parameters, 2, -1)*apop_data_get(orig, i, 2);
+        Diff(apop_data_get(predicted, i, 0), apop_data_get(orig, i, 0), 1e-12);
+        Diff(apop_data_get(predicted, i, 1), fit, 1e-10);
+        Diff(fabs(apop_data_get(predicted, i, 2)), fabs(apop_data_get(orig, i, 0) - fit), 1e-10);
+    }
+    apop_model_free(w); apop_model_free(rep);
+    apop_data_free(d); apop_data_free(orig); apop_data_free(repeated);
+}
+
+static void ols_window_check(apop_data *moments, apop_data *d, int start, int len){
+    Apop_data_rows(d, start, len, window);
+    apop_data *wcopy = apop_data_copy(window);
+    apop_model *online = apop_ols_from_moments(moments);
+    apop_model *est = apop_estimate(wcopy, apop_ols);
+    for (int i=0; i< 3; i++){
+        Diff(apop_data_get(online->parameters, i, -1), apop_data_get(est->parameters, i, -1), 1e-8);
+        Diff(apop_data_get(online->parameters, i, i, .page="<Covariance>"),
+             apop_data_get(est->parameters, i, i, .page="<Covariance>"), 1e-8);
+    }
+    Diff(apop_data_get(online->info, .rowname="R_squared"), apop_data_get(est->info, .rowname="R_squared"), 1e-8);
+    apop_model_free(online);
+    apop_model_free(est);
+    apop_data_free(wcopy);
+}
+
+void test_ols_online(gsl_rng *r){
+    int n = 3000, width = 500, step = 37;
+    apop_data *d = apop_data_alloc(n, 3);
+    for (int i=0; i< n; i++){
+        double x1 = gsl_ran_gaussian(r, 1), x2 = gsl_rng_uniform(r);
+        apop_data_set(d, i, 0, 1 + 2*x1 - 3*x2 + gsl_ran_gaussian(r, .5));
+        apop_data_set(d, i, 1, x1);
+        apop_data_set(d, i, 2, x2);
+    }
+    Apop_data_rows(d, 0, width, first);
+    apop_data *moments = apop_ols_add_rows(NULL, first);
+    assert(apop_data_get_page(moments, "<Cholesky>"));
+    int start = 0;
+    for ( ; start+width+step <= n; start += step){
+        Apop_data_rows(d, start+width, step, incoming);
+        Apop_data_rows(d, start, step, expiring);
+        apop_ols_add_rows(moments, incoming);
+        apop_ols_rm_rows(moments, expiring);
+        if (!(start % (step*20))) ols_window_check(moments, d, start+step, width);
+    }
+    ols_window_check(moments, d, start, width);
+
+    //shrink the window below the rank of X, so the factor goes away, then grow it again.
+    Apop_data_rows(d, start, width-2, most);
+    apop_ols_rm_rows(moments, most);
+    assert(!apop_data_get_page(moments, "<Cholesky>"));
+    Apop_data_rows(d, start-100, 100, more);
+    apop_ols_add_rows(moments, more);
+    assert(apop_data_get_page(moments, "<Cholesky>"));
+    Apop_data_rows(d, start+width-2, 2, last_two);
+    apop_ols_rm_rows(moments, last_two);
+    ols_window_check(moments, d, start-100, 100);
+    apop_data_free(moments);
+    apop_data_free(d);
+}
+
+//With a perfectly collinear column, OLS falls back to pivoted QR and zeros out one coefficient.
+void test_ols_collinear(gsl_rng *r){
+    int n = 200;
+    apop_data *d = apop_data_alloc(n, 4), *reduced = apop_data_alloc(n, 3);
+    for (int i=0; i< n; i++){
+        double x1 = gsl_ran_gaussian(r, 1), x3 = gsl_ran_gaussian(r, 1);
+        double y = 1 + x1 + x3 + gsl_ran_gaussian(r, .1);
+        apop_data_set(d, i, 0, y); apop_data_set(d, i, 1, x1); apop_data_set(d, i, 2, 2*x1); apop_data_set(d, i, 3, x3);
+        apop_data_set(reduced, i, 0, y); apop_data_set(reduced, i, 1, x1); apop_data_set(reduced, i, 2, x3);
+    }
+    int v = apop_opts.verbose; apop_opts.verbose = -1;
+    apop_model *est = apop_estimate(d, apop_ols);
+    apop_opts.verbose = v;
+    apop_model *est_r = apop_estimate(reduced, apop_ols);
+    double b1 = apop_data_get(est->parameters, 1, -1), b2 = apop_data_get(est->parameters, 2, -1);
+    assert(b1 == 0 || b2 == 0);
+    Diff(b1 + 2*b2, apop_data_get(est_r->parameters, 1, -1), 1e-8);
+    Diff(apop_data_get(est->parameters, 0, -1), apop_data_get(est_r->parameters, 0, -1), 1e-8);
+    Diff(apop_data_get(est->parameters, 3, -1), apop_data_get(est_r->parameters, 2, -1), 1e-8);
+    int dropped = b1 == 0 ? 1 : 2;
+    assert(gsl_isnan(apop_data_get(est->parameters, dropped, dropped, .page="<Covariance>")));
+    Diff(apop_data_get(est->parameters, 3, 3, .page="<Covariance>"),
+         apop_data_get(est_r->parameters, 2, 2, .page="<Covariance>"), 1e-10);
+    apop_model_free(est); apop_model_free(est_r);
+    apop_data_free(d); apop_data_free(reduced);
+}
+
+//The OLS log likelihood matches its row-by-row definition, and the score is its gradient.
+void test_ols_ll_score(gsl_rng *r){
+    int n = 300;
+    apop_data *d = apop_data_alloc(n, 3);
+    for (int i=0; i< n; i++){
+        double x1 = gsl_rng_uniform(r), x2 = gsl_ran_gaussian(r, 1);
+        apop_data_set(d, i, 0, 1 + x1 - .5*x2 + gsl_ran_gaussian(r, .3));
+        apop_data_set(d, i, 1, x1);
+        apop_data_set(d, i, 2, x2);
+    }
+    apop_model *est = apop_estimate(d, apop_ols);
+    gsl_vector *score = gsl_vector_alloc(3);
+    apop_score(d, score, est);
+    for (int i=0; i< 3; i++) assert(fabs(gsl_vector_get(score, i)) < 1e-6);
+
+    d->weights = gsl_vector_alloc(n);
+    for (int i=0; i< n; i++) gsl_vector_set(d->weights, i, .5 + gsl_rng_uniform(r));
+    gsl_vector_set(est->parameters->vector, 1, 1.4);
+    apop_data *xb = apop_dot(d, est->parameters, .form2='v');
+    gsl_vector_sub(xb->vector, d->vector);
+    double sigma = sqrt(apop_vector_var(xb->vector)), ll = 0;
+    for (int i=0; i< n; i++)
+        ll += log(gsl_ran_gaussian_pdf(gsl_vector_get(xb->vector, i), sigma) * gsl_vector_get(d->weights, i));
+    Diff(apop_log_likelihood(d, est), ll, 1e-8*fabs(ll));
+
+    apop_score(d, score, est);
+    est->score = NULL;
+    est->log_likelihood_score = NULL;
+    gsl_vector *numeric = apop_numerical_gradient(d, est);
+    for (int i=0; i< 3; i++)
+        Diff(gsl_vector_get(score, i), gsl_vector_get(numeric, i), 1e-4*fabs(gsl_vector_get(numeric, i)));
+    gsl_vector_free(score); gsl_vector_free(numeric);
+    apop_data_free(xb); apop_model_free(est); apop_data_free(d);
+}
+
+void test_pca(gsl_rng *r){
+    int n = 2000, p = 150, rank = 4;
+    gsl_matrix *x = gsl_matrix_alloc(n, p);
+    gsl_matrix *loadings = gsl_matrix_alloc(rank, p);
+    for (int j=0; j< p; j++)
+        for (int f=0; f< rank; f++)
+            gsl_matrix_set(loadings, f, j, gsl_ran_gaussian(r, 1));
+    for (int i=0; i< n; i++){
+        double factors[rank];
+        for (int f=0; f< rank; f++) factors[f] = gsl_ran_gaussian(r, 10./(f+1));
+        for (int j=0; j< p; j++){
+            double xij = 3 + gsl_ran_gaussian(r, 1);
+            for (int f=0; f< rank; f++) xij += factors[f]*gsl_matrix_get(loadings, f, j);
+            gsl_matrix_set(x, i, j, xij);
+        }
+    }
+    gsl_matrix *xcopy = apop_matrix_copy(x);
+    apop_data *full = apop_matrix_pca(x, 3, .method='f');
+    apop_data *quick = apop_matrix_pca(x, 3, .method='r');
+    for (int i=0; i< n; i++)  //the input isn't modified.
+        for (int j=0; j< p; j++)
+            assert(gsl_matrix_get(x, i, j) == gsl_matrix_get(xcopy, i, j));
+    for (int i=0; i< 3; i++){
+        Diff(gsl_vector_get(quick->vector, i), gsl_vector_get(full->vector, i), 1e-8);
+        Apop_matrix_col(full->matrix, i, fv);
+        Apop_matrix_col(quick->matrix, i, qv);
+        double d;
+        gsl_blas_ddot(fv, qv, &d);
+        Diff(fabs(d), 1, 1e-6);
+    }
+    assert(apop_sum(full->vector) > 0.8 && apop_sum(full->vector) < 1);
+
+    //a query, read in blocks, gives the same as the matrix.
+    apop_data *small = apop_data_alloc(300, 5);
+    for (int i=0; i< 300; i++)
+        for (int j=0; j< 5; j++)
+            apop_data_set(small, i, j, gsl_matrix_get(x, i, j));
+    apop_table_exists("pca_test", 'd');
+    apop_data_print(small, "pca_test", .output_type='d');
+    apop_data *from_m = apop_matrix_pca(small->matrix);
+    apop_data *from_q = apop_pca_query("select * from pca_test", .block_size=70);
+    for (int i=0; i< 5; i++)
+        Diff(gsl_vector_get(from_q->vector, i), gsl_vector_get(from_m->vector, i), 1e-10);
+    Diff(apop_sum(from_m->vector), 1, 1e-10);
+    apop_data_free(full); apop_data_free(quick);
+    apop_data_free(from_m); apop_data_free(from_q); apop_data_free(small);
+    gsl_matrix_free(x); gsl_matrix_free(xcopy); gsl_matrix_free(loadings);
+}
+
+static void naive_product_check(gsl_matrix const *a, gsl_matrix const *b, char ta, char tb, apop_data *out){
+    size_t m = out->matrix->size1, n = out->matrix->size2, k = ta=='t' ? a->size1 : a->size2;
+    for (size_t i=0; i< m; i+= 7)
+        for (size_t j=0; j< n; j+= 5){
+            long double s = 0;
+            for (size_t l=0; l< k; l++)
+                s += (ta=='t' ? gsl_matrix_get(a, l, i) : gsl_matrix_get(a, i, l))
+                   * (tb=='t' ? gsl_matrix_get(b, j, l) : gsl_matrix_get(b, l, j));
+            Diff(gsl_matrix_get(out->matrix, i, j), s, 1e-9);
+        }
+}
+
+void test_blocked_products(gsl_rng *r){
+    int threads = apop_opts.thread_count;
+    apop_data *a = apop_data_alloc(3000, 300), *b = apop_data_alloc(300, 270),
+              *tall = apop_data_alloc(20000, 40);
+    apop_data *all[] = {a, b, tall};
+    for (int d=0; d< 3; d++)
+        for (size_t i=0; i< all[d]->matrix->size1; i++)
+            for (size_t j=0; j< all[d]->matrix->size2; j++)
+                apop_data_set(all[d], i, j, gsl_rng_uniform(r) + j%3);
+    for (apop_opts.thread_count=1; apop_opts.thread_count<= 4; apop_opts.thread_count+= 3){
+        apop_data *ab = apop_dot(a, b);               //split by rows of the output
+        naive_product_check(a->matrix, b->matrix, 'n', 'n', ab);
+        apop_data *bta = apop_dot(b, a, 't', 't');    //(AB)'
+        naive_product_check(b->matrix, a->matrix, 't', 't', bta);
+        apop_data *tt = apop_dot(tall, tall, 't');    //the inner dimension is split; and the crossprod path
+        naive_product_check(tall->matrix, tall->matrix, 't', 'n', tt);
+        apop_data *tcopy = apop_data_copy(tall);
+        apop_data *t_other = apop_dot(tall, tcopy, 't');
+        naive_product_check(tall->matrix, tall->matrix, 't', 'n', t_other);
+        apop_data_free(ab); apop_data_free(bta); apop_data_free(tt); apop_data_free(t_other); apop_data_free(tcopy);
+    }
+
+    //covariance by one centered product matches the pairwise version, with and without weights.
+    for (int weighted=0; weighted< 3; weighted++){
+        if (weighted){
+            tall->weights = gsl_vector_alloc(tall->matrix->size1);
+            for (size_t i=0; i< tall->weights->size; i++) gsl_vector_set(tall->weights, i, gsl_rng_uniform(r));
+            if (weighted==2) apop_vector_normalize(tall->weights); //weights summing to one are probabilities
+        }
+        apop_data *cov = apop_data_covariance(tall);
+        apop_data *cor = apop_data_correlation(tall);
+        for (int i=0; i< 40; i+= 3)
+            for (int j=0; j< 40; j+= 4){
+                Apop_col(tall, i, ci);
+                Apop_col(tall, j, cj);
+                double pairwise = apop_vector_weighted_cov(ci, cj, tall->weights);
+                Diff(apop_data_get(cov, i, j), pairwise, 1e-8*fabs(pairwise) + 1e-12);
+                Diff(apop_data_get(cor, i, j), pairwise/sqrt(apop_vector_weighted_var(ci, tall->weights)
+                                               *apop_vector_weighted_var(cj, tall->weights)), 1e-8);
+            }
+        apop_data_free(cov); apop_data_free(cor);
+        gsl_vector_free(tall->weights); tall->weights = NULL;
+    }
+
+    //rows are scaled by the square root of the weight, so a negative weight is an error.
+    tall->weights = gsl_vector_alloc(tall->matrix->size1);
+    gsl_vector_set_all(tall->weights, 1);
+    gsl_vector_set(tall->weights, 7, -1);
+    int verbosity = apop_opts.verbose;
+    apop_opts.verbose = -1;
+    apop_data *bad = apop_data_covariance(tall);
+    assert(bad->error == 'w');
+    apop_opts.verbose = verbosity;
+    apop_data_free(bad);
+    apop_opts.thread_count = threads;
+    apop_data_free(a); apop_data_free(b); apop_data_free(tall);
+}
+
+//Local fits split across threads give the same surface, trace, and diagonal as one thread.
+void test_loess_threads(gsl_rng *r){
+    int threads = apop_opts.thread_count, n = 1500;
+    apop_data *d = apop_data_alloc(n, 3);
+    for (int i=0; i< n; i++){
+        double x0 = gsl_rng_uniform(r)*10, x1 = gsl_rng_uniform(r)*5;
+        apop_data_set(d, i, 1, x0);
+        apop_data_set(d, i, 2, x1);
+        apop_data_set(d, i, 0, sin(x0) + cos(x1) + gsl_ran_gaussian(r, .2));
+    }
+    for (int direct=0; direct< 2; direct++){
+        apop_model *fits[2];
+        for (int t=0; t< 2; t++){
+            apop_opts.thread_count = t ? 3 : 1;
+            apop_model *m = apop_model_copy(apop_loess);
+            Apop_model_add_group(m, apop_loess, .data=d, .lo_s.control.trace_hat="exact", .lo_s.control.cell=0.05,
+                                        .lo_s.control.surface= direct ? "direct" : "interpolate");
+            fits[t] = apop_estimate(d, *m);
+            apop_model_free(m);
+        }
+        struct loess_struct *one = &Apop_settings_get(fits[0], apop_loess, lo_s),
+                            *many = &Apop_settings_get(fits[1], apop_loess, lo_s);
+        Diff(one->out.trace_hat, many->out.trace_hat, 1e-8);
+        Diff(one->out.s, many->out.s, 1e-8);
+        for (int i=0; i< n; i++){
+            Diff(one->out.fitted_values[i], many->out.fitted_values[i], 1e-8);
+            Diff(one->out.diagonal[i], many->out.diagonal[i], 1e-8);
+        }
+        apop_model_free(fits[0]); apop_model_free(fits[1]);
+    }
+    apop_opts.thread_count = threads;
+    apop_data_free(d);
+}
+
+typedef struct {
+    apop_data *d, *to_predict;
+    apop_model *est;
+} loess_job;
+
+static void *loess_fit_and_predict(void *in){
+    loess_job *j = in;
+    apop_model *m = apop_model_copy(apop_loess);
+    Apop_model_add_group(m, apop_loess, .data=j->d);
+    j->est = apop_estimate(j->d, *m);
+    apop_predict(j->to_predict, j->est);
+    apop_model_free(m);
+    return NULL;
+}
+
+//The loess engine keeps no global state, so fits on different data can run at once.
+void test_loess_concurrent(gsl_rng *r){
+    int threads = apop_opts.thread_count, ct = 4, n = 300;
+    apop_opts.thread_count = 1;
+    loess_job serial[ct], concurrent[ct];
+    pthread_t thread_id[ct];
+    for (int t=0; t< ct; t++){
+        apop_data *d = apop_data_alloc(n, 2), *p = apop_data_alloc(5, 2);
+        for (int i=0; i< n; i++){
+            double x = gsl_rng_uniform(r)*10;
+            apop_data_set(d, i, 1, x);
+            apop_data_set(d, i, 0, sin(x*(t+1)/2.) + gsl_ran_gaussian(r, .2));
+        }
+        for (int i=0; i< 5; i++) apop_data_set(p, i, 1, 1.5*(i+1));
+        serial[t] = (loess_job){.d=d, .to_predict=p};
+        concurrent[t] = (loess_job){.d=d, .to_predict=apop_data_copy(p)};
+        loess_fit_and_predict(serial+t);
+    }
+    for (int t=0; t< ct; t++) pthread_create(thread_id+t, NULL, loess_fit_and_predict, concurrent+t);
+    for (int t=0; t< ct; t++) pthread_join(thread_id[t], NULL);
+    for (int t=0; t< ct; t++){
+        struct loess_struct *a = &Apop_settings_get(serial[t].est, apop_loess, lo_s),
+                            *b = &Apop_settings_get(concurrent[t].est, apop_loess, lo_s);
+        assert(a->out.trace_hat == b->out.trace_hat && a->out.s == b->out.s);
+        for (int i=0; i< n; i++) assert(a->out.fitted_values[i] == b->out.fitted_values[i]);
+        for (int i=0; i< 5; i++)
+            assert(apop_data_get(serial[t].to_predict, i, 0) == apop_data_get(concurrent[t].to_predict, i, 0));
+        apop_model_free(serial[t].est); apop_model_free(concurrent[t].est);
+        apop_data_free(serial[t].to_predict); apop_data_free(concurrent[t].to_predict);
+        apop_data_free(serial[t].d);
+    }
+    apop_opts.thread_count = threads;
+}
+
+/*Prediction walks the k-d tree cached at estimation. At the data points, that has to
+reproduce the fitted values; the threaded and unthreaded evaluations must agree, and the
+cache has to survive a model copy.*/
+void test_loess_predict(gsl_rng *r){
+    int threads = apop_opts.thread_count, n = 400, m = 12000;
+    for (int d=1; d<= 2; d++){
+        apop_data *data = apop_data_alloc(n, d+1);
+        for (int i=0; i< n; i++){
+            double y = 0;
+            for (int j=1; j<= d; j++){
+                double x = gsl_rng_uniform(r)*10;
+                apop_data_set(data, i, j, x);
+                y += sin(x*j);
+            }
+            apop_data_set(data, i, 0, y + gsl_ran_gaussian(r, .2));
+        }
+        apop_model *m1 = apop_model_copy(apop_loess);
+        Apop_model_add_group(m1, apop_loess, .data=data);
+        apop_model *est = apop_estimate(data, *m1);
+        apop_model *cp = apop_model_copy(*est);
+
+        apop_data *at_data = apop_data_copy(data);
+        apop_predict(at_data, est);
+        double *fitted = Apop_settings_get(est, apop_loess, lo_s.out.fitted_values);
+        for (int i=0; i< n; i++) Diff(apop_data_get(at_data, i, 0), fitted[i], 1e-10);
+
+        apop_data *one = apop_data_alloc(m, d+1), *many;
+        for (int i=0; i< m; i++) for (int j=1; j<= d; j++)
+            apop_data_set(one, i, j, gsl_ran_flat(r, 1, 9));
+        many = apop_data_copy(one);
+        apop_opts.thread_count = 1;
+        apop_predict(one, est);
+        apop_opts.thread_count = 3;
+        apop_predict(many, cp);
+        for (int i=0; i< m; i++) assert(apop_data_get(one, i, 0) == apop_data_get(many, i, 0));
+        apop_opts.thread_count = threads;
+        apop_data_free(data); apop_data_free(at_data); apop_data_free(one); apop_data_free(many);
+        apop_model_free(m1); apop_model_free(est); apop_model_free(cp);
+    }
+}
+
 #define INVERTSIZE 100
 void test_inversion(gsl_rng *r){
     gsl_matrix *invme = gsl_matrix_alloc(INVERTSIZE, INVERTSIZE);
@@ -657,6 +1124,37 @@ apop_data *d9   = apop_dot(dv, d1, .form2='t');
     apop_data_free(d7); apop_data_free(d8);
     apop_data_free(d9); apop_data_free(d10); apop_data_free(d11);
 }
+
+void test_arena(){
+    apop_data *d1 = apop_text_to_data("test_data2"); // 55 x 2
+    for (int i=0; i< d1->matrix->size1; i++)
+        apop_name_add(d1->names, (i%2 ? "odd" : "even"), 'r');
+    apop_data *heap = apop_dot(d1, d1, .form2='t');
+    for (int i=0; i< 3; i++){
+        apop_arena_push();
+        apop_data *d3 = apop_dot(d1, d1, .form2='t');
+        assert(d3->matrix->size1 == heap->matrix->size1);
+        assert(!strcmp(d3->names->row[0], heap->names->row[0]));
+        apop_arena_push(); //nested scope, released first.
+        apop_data *c = apop_data_copy(d3);
+        apop_name_add(c->names, "extra", 'c');
+        assert(apop_data_get(c, 3, 4) == apop_data_get(heap, 3, 4));
+        apop_data_free(c); //safe; does nothing here.
+        apop_arena_pop();
+        assert(apop_data_get(d3, 54, 54) == apop_data_get(heap, 54, 54));
+        apop_arena_pop();
+    }
+    apop_arena_push(); //in-place dummies replace column names that came from the arena.
+    apop_data *t = apop_text_alloc(apop_data_alloc(6, 2), 6, 1);
+    apop_name_add(t->names, "x0", 'c');
+    apop_name_add(t->names, "x1", 'c');
+    for (int i=0; i< 6; i++) apop_text_add(t, i, 0, i%3 ? "a" : "b");
+    apop_data_to_dummies(t, 0, .type='t', .append='i');
+    assert(t->names->colct == 3 && !strcmp(t->names->column[2], "x1"));
+    apop_arena_pop();
+    apop_data *after = apop_data_alloc(2, 2); //back on the heap.
+    apop_data_free(after); apop_data_free(heap); apop_data_free(d1);
+}
  
 static void fill_p(apop_data *d, gsl_rng *r){
     int j, k;
@@ -1166,6 +1664,8 @@ void test_unique_elements(){
     assert(gsl_vector_get(distinct, 2) == -.1);
     assert(gsl_vector_get(distinct, 3) == 0);
     assert(gsl_vector_get(distinct, 4) == .1);
+    gsl_vector empty = {.size=0};
+    assert(!apop_vector_unique_elements(&empty));
 
     apop_data *t = apop_text_alloc(NULL, 9, 7);
     apop_text_add(t, 0, 0, "Hi,");
@@ -1182,6 +1682,512 @@ void test_unique_elements(){
     assert(!strcmp(".", dt->text[0][0]));
     assert(!strcmp("Hi,", dt->text[1][0]));
     assert(!strcmp("text", dt->text[5][0]));
+
+    apop_text_add(t, 3, 0, "100%%s"); //category text is data, not a format.
+    apop_data *dt2 = apop_text_unique_elements(t, 0);
+    assert(!strcmp("100%s", dt2->text[1][0]));
+    apop_data_to_factors(t);
+    assert(!strcmp("100%s", apop_data_get_page(t, "<categories")->text[1][0]));
+}
+
+void test_text_pool(){
+    char *words[] = {"red", "green", "red", "blue", "red", "green"};
+    apop_data *t = apop_text_alloc(apop_data_alloc(6), 6, 2);
+    for (int i=0; i< 6; i++){
+        apop_data_set(t, i, -1, i);
+        apop_text_add(t, i, 0, words[i]);
+        apop_text_add(t, i, 1, "row %i", i);
+    }
+    apop_text_pool(t);
+    assert(t->text[0][0] == t->text[2][0]); //interned.
+    assert(!strcmp(t->text[3][0], "blue"));
+    apop_text_add(t, 5, 1, "%s", "changed");
+    assert(!strcmp(t->text[5][1], "changed"));
+
+    apop_data *c = apop_data_copy(t);
+    assert(c->text[4][1] == t->text[4][1]); //shared pool, so copies are pointer copies.
+    apop_data *s = apop_data_stack(t, c);
+    assert(s->textsize[0] == 12);
+    assert(!strcmp(s->text[9][0], "blue"));
+    apop_data **split = apop_data_split(s, 4, 'r');
+    assert(!strcmp(split[1]->text[0][1], "row 4"));
+    apop_data *tt = apop_data_transpose(t);
+    assert(!strcmp(tt->text[0][1], "green"));
+
+    apop_data_sort(c, -1, 'd');
+    assert(!strcmp(c->text[0][1], "changed"));
+    assert(!strcmp(t->text[0][1], "row 0")); //the original is unaffected.
+    apop_data_free(t); //c still has its strings after this.
+    assert(!strcmp(c->text[2][0], "blue"));
+    apop_data_free(c); apop_data_free(s); apop_data_free(tt);
+    apop_data_free(split[0]); apop_data_free(split[1]); free(split);
+}
+
+void test_many_factors(){
+    //500 categories, each appearing four times, in scrambled order.
+    int rows = 2000, cats = 500;
+    apop_data *d = apop_text_alloc(apop_data_alloc(rows), rows, 1);
+    for (int i=0; i< rows; i++)
+        apop_text_add(d, i, 0, "cat %03i", (i*7) % cats);
+    apop_data *p = apop_data_copy(d);
+    apop_text_pool(p);
+    apop_data *f = apop_data_to_factors(d, .outcol=-1);
+    apop_data *fp = apop_data_to_factors(p, .outcol=-1);
+    assert(f->textsize[0] == cats && fp->textsize[0] == cats);
+    for (int j=1; j< cats; j++)
+        assert(strcmp(f->text[j-1][0], f->text[j][0]) < 0);
+    for (int i=0; i< rows; i++){
+        int code = apop_data_get(d, i, -1);
+        assert(!strcmp(f->text[code][0], d->text[i][0]));
+        assert(code == apop_data_get(p, i, -1));
+    }
+    apop_data *dum = apop_data_to_dummies(d, .keep_first=1);
+    assert(dum->matrix->size2 == cats);
+    for (int i=0; i< rows; i++){
+        Apop_row(dum, i, onerow);
+        assert(apop_sum(onerow) == 1);
+        assert(apop_data_get(dum, i, apop_data_get(d, i, -1)) == 1);
+    }
+    apop_data_free(dum); apop_data_free(d); apop_data_free(p);
+}
+
+void test_sparse_dummies(gsl_rng *r){
+    //y = 1 + 2x + category effect + noise; fit with dense and with sparse dummies.
+    int rows = 400, cats = 20;
+    apop_data *d = apop_text_alloc(apop_data_alloc(0, rows, 2), rows, 1);
+    for (int i=0; i< rows; i++){
+        int c = gsl_rng_uniform(r)*cats;
+        double x = gsl_rng_uniform(r);
+        apop_text_add(d, i, 0, "c%02i", c);
+        apop_data_set(d, i, 1, x);
+        apop_data_set(d, i, 0, 1 + 2*x + c/2. + gsl_ran_gaussian(r, 0.1));
+    }
+    d->weights = gsl_vector_alloc(rows);
+    for (int i=0; i< rows; i++) gsl_vector_set(d->weights, i, gsl_rng_uniform(r)+0.5);
+    apop_data *dense = apop_data_copy(d);
+    apop_data *sparse = apop_data_copy(d);
+    apop_data_to_dummies(dense, .append='y');
+    apop_data_to_dummies(sparse, .append='y', .sparse='y');
+    assert(sparse->matrix->size2 == 2 && sparse->sparse->size2 == cats-1);
+    assert(sparse->names->colct == dense->names->colct);
+    for (int i=0; i< rows; i++)
+        for (int j=0; j< cats-1; j++)
+            assert(apop_sparse_get(sparse->sparse, i, j) == apop_data_get(dense, i, j+2));
+
+    apop_data *xpx = apop_dot(dense, dense, 't');
+    apop_data *xpx_s = apop_dot(sparse, sparse, 't');
+    for (int i=0; i< cats+1; i++)
+        for (int j=0; j< cats+1; j++)
+            Diff(apop_data_get(xpx, i, j), apop_data_get(xpx_s, i, j), 1e-8);
+
+    for (int weighted=1; weighted >= 0; weighted--){
+        if (!weighted){
+            gsl_vector_free(dense->weights);  dense->weights = NULL;
+            gsl_vector_free(sparse->weights); sparse->weights = NULL;
+        }
+        apop_model *est = apop_estimate(dense, apop_ols);
+        apop_model *est_s = apop_estimate(sparse, apop_ols);
+        assert(est_s->parameters->vector->size == cats+1);
+        for (int i=0; i< cats+1; i++){
+            Diff(apop_data_get(est->parameters, i, -1), apop_data_get(est_s->parameters, i, -1), 1e-6);
+            for (int j=0; j< cats+1; j++)
+                Diff(apop_data_get(est->parameters, i, j, .page="<Covariance>"),
+                     apop_data_get(est_s->parameters, i, j, .page="<Covariance>"), 1e-8);
+        }
+        Diff(apop_data_get(est->parameters, 1, -1), 2, 0.05);
+        Diff(apop_data_get(est->info, .rowname="log likelihood"),
+             apop_data_get(est_s->info, .rowname="log likelihood"), 1e-6);
+        apop_model_free(est); apop_model_free(est_s);
+    }
+    apop_model *est = apop_estimate(dense, apop_ols);
+    apop_model *nocov = apop_model_copy(apop_ols);
+    Apop_model_add_group(nocov, apop_lm, .want_cov='n');
+    apop_model *est_s = apop_estimate(sparse, *nocov);
+    assert(!apop_data_get_page(est_s->parameters, "<Covariance>"));
+    for (int i=0; i< cats+1; i++)
+        Diff(apop_data_get(est->parameters, i, -1), apop_data_get(est_s->parameters, i, -1), 1e-6);
+    apop_model_free(est); apop_model_free(est_s); apop_model_free(nocov);
+    apop_data_free(xpx); apop_data_free(xpx_s);
+    apop_data_free(d); apop_data_free(dense); apop_data_free(sparse);
+}
+
+void test_settings_cache(){
+    apop_model *m = apop_model_copy(apop_ols);
+    Apop_model_add_group(m, apop_parts_wanted);
+    Apop_model_add_group(m, apop_lm, .want_cov='n');
+    assert(m->settings[1].name_hash == Apop_settings_key("apop_lm"));
+    assert(Apop_settings_get(m, apop_lm, want_cov) == 'n');
+    assert(apop_settings_get_grp(m, "apop_lm", 'c') == Apop_settings_get_group(m, apop_lm));
+
+    //a copy's lookups mustn't land in the original's groups.
+    apop_model *m2 = apop_model_copy(*m);
+    Apop_settings_set(m2, apop_lm, want_cov, 'y');
+    assert(Apop_settings_get(m, apop_lm, want_cov) == 'n');
+    assert(Apop_settings_get(m2, apop_lm, want_cov) == 'y');
+
+    //removing and re-adding groups moves things around.
+    Apop_settings_rm_group(m, apop_parts_wanted);
+    assert(Apop_settings_get(m, apop_lm, want_cov) == 'n');
+    Apop_settings_rm_group(m, apop_lm);
+    assert(!Apop_settings_get_group(m, apop_lm));
+    Apop_model_add_group(m, apop_lm, .want_cov='y');
+    assert(Apop_settings_get(m, apop_lm, want_cov) == 'y');
+    apop_model_free(m);
+    apop_model_free(m2);
+}
+
+void test_parallel_derivs(gsl_rng *r){
+    apop_data *d = apop_data_alloc(1000);
+    for (int i=0; i< 1000; i++) apop_data_set(d, i, -1, gsl_ran_gaussian(r, 2)+1);
+    apop_model *m = apop_estimate(d, apop_normal);
+    m->score = NULL;  //force the nested numerical gradient.
+    apop_data *serial = apop_model_hessian(d, m);
+    gsl_vector *serial_grad = apop_numerical_gradient(d, m);
+    double sigma = apop_data_get(m->parameters, 1, -1);
+    assert(fabs(apop_data_get(serial, 0, 0) + 1000/gsl_pow_2(sigma)) < 1e-2);
+
+    Apop_model_add_group(m, apop_mle, .parallel_derivs='y');
+    apop_data *parallel = apop_model_hessian(d, m);
+    gsl_vector *parallel_grad = apop_numerical_gradient(d, m);
+    assert(apop_vector_distance(serial_grad, parallel_grad) < 1e-10);
+    assert(apop_data_get(m->parameters, 1, -1) == sigma);
+
+    Apop_settings_set(m, apop_mle, reuse_evals, 'y');
+    apop_data *reused = apop_model_hessian(d, m);
+    for (int i=0; i< 2; i++)
+        for (int j=0; j< 2; j++){
+            assert(fabs(apop_data_get(parallel, i, j) - apop_data_get(serial, i, j)) < 1e-8);
+            assert(fabs(apop_data_get(reused, i, j) - apop_data_get(serial, i, j))
+                        < 1e-3 * (1+fabs(apop_data_get(serial, i, j))));
+        }
+    apop_data_free(serial); apop_data_free(parallel); apop_data_free(reused);
+    gsl_vector_free(serial_grad); gsl_vector_free(parallel_grad);
+    apop_model_free(m);
+    apop_data_free(d);
+}
+
+void test_dual_derivs(gsl_rng *r){
+    apop_model *t = apop_model_set_parameters(apop_t_distribution, 1, 2, 5);
+    apop_data *d = apop_data_alloc(500);
+    for (int i=0; i< 500; i++) apop_draw(apop_data_ptr(d, i, -1), r, t);
+    gsl_vector *exact = apop_numerical_gradient(d, t);
+    apop_data *exact_h = apop_model_hessian(d, t);
+
+    t->log_likelihood_dual = NULL;
+    gsl_vector *numeric = apop_numerical_gradient(d, t);
+    apop_data *numeric_h = apop_model_hessian(d, t);
+    for (int i=0; i< 3; i++){
+        assert(fabs(gsl_vector_get(exact, i) - gsl_vector_get(numeric, i))
+                    < 1e-3 * (1+fabs(gsl_vector_get(exact, i))));
+        for (int j=0; j< 3; j++)
+            assert(fabs(apop_data_get(exact_h, i, j) - apop_data_get(numeric_h, i, j))
+                        < 1e-3 * (1+fabs(apop_data_get(exact_h, i, j))));
+    }
+    gsl_vector_free(exact); gsl_vector_free(numeric);
+    apop_data_free(exact_h); apop_data_free(numeric_h);
+    apop_model_free(t);
+    apop_data_free(d);
+}
+
+void test_xbeta_gradient(gsl_rng *r){
+    apop_model *models[] = {&apop_logit, &apop_probit};
+    for (int k=0; k< 2; k++){
+        apop_data *d = apop_data_alloc(200, 4);
+        for (int i=0; i< 200; i++){
+            apop_data_set(d, i, 0, (int)(gsl_rng_uniform(r)*3));
+            for (int j=1; j< 4; j++) apop_data_set(d, i, j, gsl_ran_gaussian(r, 1));
+        }
+        apop_model *m = apop_model_copy(*models[k]);
+        apop_prep(d, m);
+        assert(m->parameters->matrix->size2 == 2);
+        for (int i=0; i< m->parameters->matrix->size1; i++)
+            for (int j=0; j< 2; j++)
+                gsl_matrix_set(m->parameters->matrix, i, j, gsl_ran_gaussian(r, .5));
+        gsl_vector *cached = apop_numerical_gradient(d, m);
+        Apop_model_add_group(m, apop_mle, .parallel_derivs='y');
+        gsl_vector *threaded = apop_numerical_gradient(d, m);
+        m->log_likelihood_xbeta = NULL;
+        gsl_vector *full = apop_numerical_gradient(d, m);
+        for (int i=0; i< full->size; i++){
+            assert(fabs(gsl_vector_get(cached, i) - gsl_vector_get(full, i))
+                        < 1e-4 * (1+fabs(gsl_vector_get(full, i))));
+            assert(gsl_vector_get(cached, i) == gsl_vector_get(threaded, i));
+        }
+        gsl_vector_free(cached); gsl_vector_free(threaded); gsl_vector_free(full);
+        apop_model_free(m);
+        apop_data_free(d);
+    }
+}
+
+//Two peaks: a lower one near -1 and a higher one near +1.
+static double two_peaks(apop_data *d, apop_model *m){
+    double b = apop_data_get(m->parameters, 0, -1);
+    return -gsl_pow_2(b*b - 1) + b/2;
+}
+
+static int peak_calls;
+static double interrupted_peaks(apop_data *d, apop_model *m){
+    if (__sync_add_and_fetch(&peak_calls, 1) == 5) raise(SIGINT);
+    return two_peaks(d, m);
+}
+
+void test_multistart(gsl_rng *r){
+    apop_model peaks = {"two peaks", .log_likelihood=two_peaks, .vbase=1};
+    double start = -1;
+    Apop_model_add_group(&peaks, apop_mle, .starting_pt=&start, .method=APOP_SIMPLEX_NM,
+                            .tolerance=1e-8, .want_cov='n');
+    apop_model *one = apop_estimate(NULL, peaks);
+    assert(apop_data_get(one->parameters, 0, -1) < 0);
+    assert(!apop_data_get_page(one->info, "<Local optima>"));
+
+    Apop_settings_set(&peaks, apop_mle, starts, 8);
+    Apop_settings_set(&peaks, apop_mle, start_range, 2.5);
+    apop_model *best = apop_estimate(NULL, peaks);
+    assert(apop_data_get(best->parameters, 0, -1) > 0.9);
+    apop_data *optima = apop_data_get_page(best->info, "<Local optima>");
+    assert(optima->matrix->size1 == 8);
+    double top = GSL_NEGINF;
+    for (int i=0; i< 8; i++) top = GSL_MAX(top, apop_data_get(optima, i, 0));
+    assert(top == apop_data_get(best->info, .rowname="log likelihood"));
+
+    apop_data *pts = apop_data_alloc(0, 2, 1);
+    apop_data_set(pts, 0, 0, -1);
+    apop_data_set(pts, 1, 0, 1);
+    Apop_settings_set(&peaks, apop_mle, start_pts, pts);
+    apop_model *given = apop_estimate(NULL, peaks);
+    optima = apop_data_get_page(given->info, "<Local optima>");
+    assert(optima->matrix->size1 == 2);
+    assert(apop_data_get(optima, 0, 2) < 0 && apop_data_get(optima, 1, 2) > 0);
+    assert(fabs(apop_data_get(given->parameters, 0, -1) - apop_data_get(optima, 1, 2)) < 1e-10);
+    apop_model_free(one); apop_model_free(best); apop_model_free(given);
+    apop_data_free(pts);
+    Apop_settings_rm_group(&peaks, apop_mle);
+
+    //Ctrl-C stops the running searches and skips the rest; the process survives it.
+    int threads = apop_opts.thread_count;
+    for (apop_opts.thread_count=1; apop_opts.thread_count<= 3; apop_opts.thread_count+= 2){
+        apop_model stopped = {"two peaks", .log_likelihood=interrupted_peaks, .vbase=1};
+        Apop_model_add_group(&stopped, apop_mle, .starting_pt=&start, .method=APOP_SIMPLEX_NM,
+                            .tolerance=1e-8, .want_cov='n', .starts=12, .start_range=2.5);
+        peak_calls = 0;
+        apop_model *cut = apop_estimate(NULL, stopped);
+        optima = apop_data_get_page(cut->info, "<Local optima>");
+        int skipped = 0;
+        for (int i=0; i< 12; i++) skipped += gsl_isnan(apop_data_get(optima, i, 0));
+        assert(skipped >= 12 - apop_opts.thread_count);
+        assert(signal(SIGINT, SIG_DFL) == SIG_DFL);
+        apop_model_free(cut);
+        Apop_settings_rm_group(&stopped, apop_mle);
+    }
+    apop_opts.thread_count = threads;
+}
+
+void test_tempering(gsl_rng *r){
+    apop_model peaks = {"two peaks", .log_likelihood=two_peaks, .vbase=1};
+    double start = -1;
+    Apop_model_add_group(&peaks, apop_mle, .starting_pt=&start, .method=APOP_TEMPERING,
+                            .step_size=0.5, .t_initial=20, .max_iterations=2000, .rng=r, .want_cov='n');
+    apop_model *est = apop_estimate(NULL, peaks);
+    double b = apop_data_get(est->parameters, 0, -1);
+    assert(fabs(b - 1.0575) < 0.05);
+    assert(fabs(apop_data_get(est->info, .rowname="log likelihood") - two_peaks(NULL, est)) < 1e-10);
+    apop_model_free(est);
+    Apop_settings_rm_group(&peaks, apop_mle);
+}
+
+static int batch_calls;
+static double interrupted_logit(apop_data *d, apop_model *m){
+    if (++batch_calls == 50) raise(SIGINT);
+    return apop_logit.log_likelihood(d, m);
+}
+
+void test_minibatch(gsl_rng *r){
+    double tp[] = {0.5, -1, 0.8};
+    gsl_vector *true_params = apop_array_to_vector(tp, 3);
+    apop_data *data = generate_probit_logit_sample(true_params, r, &apop_logit);
+    apop_model *full = apop_estimate(data, apop_logit);
+    double full_ll = apop_log_likelihood(data, full);
+    apop_model *ones = apop_model_copy(*full); //the default starting point
+    for (int j=0; j< 3; j++) apop_data_set(ones->parameters, j, 0, 1);
+    double gap = full_ll - apop_log_likelihood(data, ones);
+    apop_optimization_enum methods[] = {APOP_SGD, APOP_SGD_LBFGS};
+    char oldtype = apop_opts.output_type;
+    apop_opts.output_type = 'd';
+    for (int i=0; i< 2; i++){
+        apop_model *m = apop_model_copy(apop_logit);
+        Apop_model_add_group(m, apop_mle, .method=methods[i], .batch_size=500,
+                                .max_iterations=200, .rng=r, .trace_path="minibatch_trace");
+        apop_table_exists("minibatch_trace", 'd');
+        apop_model *est = apop_estimate(data, *m);
+        assert(apop_data_get(est->info, .rowname="status") == 0);
+        for (int j=0; j< 3; j++)
+            assert(fabs(apop_data_get(est->parameters, j, 0) - apop_data_get(full->parameters, j, 0)) < 1e-3);
+
+        //The mini-batch steps aren't traced, so the first row is where the full-data search
+        //started. The mini-batch steps alone should have closed most of the gap.
+        apop_data *start = apop_query_to_data("select * from minibatch_trace limit 1");
+        assert(full_ll - apop_data_get(start, 0, 3) < gap/10);
+        apop_data_free(start);
+        apop_model_free(est);
+        apop_model_free(m);
+    }
+
+    //Ctrl-C during the mini-batch steps returns the point they reached, with no full-data search.
+    apop_model *stopped = apop_model_copy(apop_logit);
+    stopped->log_likelihood = interrupted_logit;
+    stopped->score = NULL;
+    stopped->log_likelihood_xbeta = NULL;
+    stopped->log_likelihood_dual = NULL;
+    Apop_model_add_group(stopped, apop_mle, .method=APOP_SGD, .batch_size=500,
+                            .max_iterations=200, .rng=r, .trace_path="minibatch_trace");
+    apop_table_exists("minibatch_trace", 'd');
+    batch_calls = 0;
+    apop_model *est = apop_estimate(data, *stopped);
+    assert(apop_data_get(est->info, .rowname="status") == -1);
+    assert(!apop_table_exists("minibatch_trace"));
+    assert(batch_calls < 100);
+    assert(signal(SIGINT, SIG_DFL) == SIG_DFL);
+    apop_model_free(est);
+    apop_model_free(stopped);
+
+    //Threaded starts each get their own RNG, seeded in order from ours, so the same seed
+    //gives the same optima even though every mini-batch step draws from it.
+    apop_data *nd = apop_data_alloc(3000);
+    for (int i=0; i< 3000; i++) apop_data_set(nd, i, -1, gsl_ran_gaussian(r, 2)+1);
+    int threads = apop_opts.thread_count;
+    apop_opts.thread_count = 3;
+    apop_model *nm = apop_model_copy(apop_normal);
+    nm->estimate = NULL; //use the MLE.
+    gsl_rng *seeded = apop_rng_alloc(12);
+    Apop_model_add_group(nm, apop_mle, .method=APOP_SGD, .batch_size=50, .max_iterations=300,
+                                .starts=6, .rng=seeded, .want_cov='n');
+    apop_model *first = apop_estimate(nd, *nm);
+    gsl_rng_set(seeded, 12);
+    apop_model *second = apop_estimate(nd, *nm);
+    gsl_matrix *o1 = apop_data_get_page(first->info, "<Local optima>")->matrix,
+               *o2 = apop_data_get_page(second->info, "<Local optima>")->matrix;
+    for (size_t i=0; i< 6; i++)
+        for (size_t j=0; j< o1->size2; j++)
+            assert(gsl_matrix_get(o1, i, j) == gsl_matrix_get(o2, i, j));
+    assert(Apop_settings_get(first, apop_mle, rng) == seeded); //not the freed per-start RNG.
+    apop_model_free(first); apop_model_free(second); apop_model_free(nm);
+    gsl_rng_free(seeded);
+    apop_data_free(nd);
+    apop_opts.thread_count = threads;
+
+    apop_opts.output_type = oldtype;
+    apop_model_free(full);
+    apop_model_free(ones);
+    apop_data_free(data);
+    gsl_vector_free(true_params);
+}
+
+//The model caches the layout of its parameters; replacing them has to invalidate that.
+void test_pack_plan(gsl_rng *r){
+    apop_data *d = apop_data_alloc(200);
+    for (int i=0; i< 200; i++) apop_data_set(d, i, -1, gsl_ran_gaussian(r, 2)+1);
+    apop_model *m = apop_model_set_parameters(apop_normal, 0, 1);
+    m->score = NULL;
+    gsl_vector *first = apop_numerical_gradient(d, m);
+
+    apop_data_free(m->parameters);
+    m->parameters = apop_data_alloc(2);
+    apop_data_set(m->parameters, 0, -1, 1);
+    apop_data_set(m->parameters, 1, -1, 2);
+    gsl_vector *moved = apop_numerical_gradient(d, m);
+    apop_model *fresh = apop_model_set_parameters(apop_normal, 1, 2);
+    fresh->score = NULL;
+    gsl_vector *expected = apop_numerical_gradient(d, fresh);
+    assert(apop_vector_distance(moved, expected) < 1e-12);
+    assert(apop_vector_distance(first, expected) > 1e-3);
+    assert(apop_data_get(m->parameters, 1, -1) == 2);
+    gsl_vector_free(first); gsl_vector_free(moved); gsl_vector_free(expected);
+    apop_model_free(m); apop_model_free(fresh);
+    apop_data_free(d);
+}
+
+void test_trace_path(gsl_rng *r){
+    apop_model *t = apop_model_set_parameters(apop_t_distribution, 1, 2, 5);
+    apop_data *d = apop_data_alloc(300);
+    for (int i=0; i< 300; i++) apop_draw(apop_data_ptr(d, i, -1), r, t);
+    apop_model *m = apop_model_copy(apop_t_distribution);
+    m->estimate = NULL; //use the MLE.
+    Apop_model_add_group(m, apop_mle, .trace_path="mle_trace", .method=APOP_SIMPLEX_NM, .want_cov='n');
+    char oldtype = apop_opts.output_type;
+    apop_opts.output_type = 'd';
+    apop_table_exists("mle_trace", 'd');
+    apop_model *est = apop_estimate(d, *m);
+    apop_opts.output_type = oldtype;
+    apop_data *trace = apop_query_to_data("select * from mle_trace");
+    assert(trace->matrix->size2 == 4); //all three parameters, and the log likelihood
+    assert(trace->matrix->size1 > 10);
+    double best = apop_query_to_float("select max(ll) from mle_trace");
+    assert(fabs(best - apop_log_likelihood(d, est)) < 1e-6);
+    apop_data_free(trace);
+    apop_model_free(est); apop_model_free(m); apop_model_free(t);
+    apop_data_free(d);
+}
+
+/* Each model's fused log likelihood and score should match its log_likelihood and
+ its finite-difference gradient. For the multivariate Normal, only the mean and the
+ diagonal of the covariance have a well-defined finite difference. */
+void test_ll_and_score(gsl_rng *r){
+    struct {apop_model *m; int matrix;} models[] = {
+        {apop_model_set_parameters(apop_normal, 1, 2)},
+        {apop_model_set_parameters(apop_lognormal, .5, .4)},
+        {apop_model_set_parameters(apop_gamma, 2.5, 1.5)},
+        {apop_model_set_parameters(apop_beta, 2, 3.5)},
+        {apop_model_set_parameters(apop_exponential, 2)},
+        {apop_model_set_parameters(apop_poisson, 3.2)},
+        {apop_model_set_parameters(apop_waring, 2.5, 1.5)},
+        {apop_model_set_parameters(apop_yule, 2.4)},
+        {apop_model_set_parameters(apop_zipf, 1.8)},
+        {apop_model_set_parameters(apop_t_distribution, 1, 2, 5)},
+        {apop_model_set_parameters(apop_f_distribution, 6, 9)},
+        {apop_model_set_parameters(apop_chi_squared, 4)},
+        {apop_model_copy(apop_dirichlet), 3},
+        {apop_model_copy(apop_multivariate_normal), 2}
+    };
+    models[12].m->parameters = apop_data_fill(apop_data_alloc(3), 2, 3, 1.5);
+    models[13].m->parameters = apop_data_fill(apop_data_alloc(2, 2, 2), 1,  2, .5,
+                                                                       -1, .5,  1);
+    models[13].m->dsize = 2;
+    for (int i=0; i< sizeof(models)/sizeof(models[0]); i++){
+        apop_model *m = models[i].m;
+        apop_data *d = models[i].matrix ? apop_data_alloc(300, models[i].matrix) : apop_data_alloc(300);
+        for (int j=0; j< 300; j++)
+            apop_draw(models[i].matrix ? apop_data_ptr(d, j, 0) : apop_data_ptr(d, j, -1), r, m);
+        size_t k = m->parameters->vector->size + (m->parameters->matrix ? 4 : 0);
+        gsl_vector *fused = gsl_vector_alloc(k), *score = gsl_vector_alloc(k);
+        double ll = m->log_likelihood_score(d, fused, m);
+        assert(fabs(ll - apop_log_likelihood(d, m)) < 1e-8 * (1+fabs(ll)));
+        apop_score(d, score, m);
+        assert(apop_vector_distance(fused, score) < 1e-8);
+
+        m->log_likelihood_dual = NULL;
+        gsl_vector *numeric = apop_numerical_gradient(d, m, 1e-5);
+        for (int j=0; j< k; j++){
+            if (m->parameters->matrix && (j==3 || j==4)) continue; //off-diagonal
+            assert(fabs(gsl_vector_get(fused, j) - gsl_vector_get(numeric, j))
+                        < 1e-3 * (1+fabs(gsl_vector_get(numeric, j))));
+        }
+        gsl_vector_free(fused); gsl_vector_free(score); gsl_vector_free(numeric);
+        apop_data_free(d);
+        apop_model_free(m);
+    }
+
+    //The MLE, using the fused kernel via the GSL's fdf path, recovers a Beta's parameters.
+    apop_model *b = apop_model_set_parameters(apop_beta, 2, 5);
+    apop_data *d = apop_data_alloc(2000);
+    for (int j=0; j< 2000; j++) apop_draw(apop_data_ptr(d, j, -1), r, b);
+    apop_model *m = apop_model_copy(apop_beta);
+    m->estimate = NULL;
+    Apop_model_add_group(m, apop_mle, .starting_pt=(double[]){1, 1}, .want_cov='n');
+    apop_model *est = apop_estimate(d, *m);
+    assert(fabs(apop_data_get(est->parameters, 0, -1) - 2) < .3);
+    assert(fabs(apop_data_get(est->parameters, 1, -1) - 5) < .75);
+    apop_model_free(est); apop_model_free(m); apop_model_free(b);
+    apop_data_free(d);
 }
 
 void test_probit_and_logit(gsl_rng *r){
@@ -1211,6 +2217,102 @@ void test_probit_and_logit(gsl_rng *r){
     apop_data_free(data2);
 }
 
+//Newton's method (logit) and Fisher scoring (probit) should find the same optimum as the general MLE.
+void test_irls(gsl_rng *r){
+    double beta[3][2] = {{.5, -.3}, {-1, .8}, {.7, .4}}; //variables by options 1 and 2
+    int n = 4000;
+    apop_data *logit_d = apop_data_alloc(n, 3), *probit_d = apop_data_alloc(n, 3);
+    for (int i=0; i< n; i++){
+        double x[3] = {1, gsl_ran_gaussian(r, 1), gsl_ran_gaussian(r, 1)}, xb[2] = {0, 0};
+        for (int j=0; j< 2; j++)
+            for (int k=0; k< 3; k++) xb[j] += x[k]*beta[k][j];
+        double u = gsl_rng_uniform(r)*(1 + exp(xb[0]) + exp(xb[1]));
+        apop_data_set(logit_d, i, 0, u < 1 ? 0 : u < 1 + exp(xb[0]) ? 1 : 2);
+        apop_data_set(probit_d, i, 0, gsl_ran_gaussian(r, 1) < xb[0]);
+        for (int k=1; k< 3; k++){
+            apop_data_set(logit_d, i, k, x[k]);
+            apop_data_set(probit_d, i, k, x[k]);
+        }
+    }
+    apop_model *models[] = {&apop_logit, &apop_probit};
+    apop_data *data[] = {logit_d, probit_d};
+    for (int i=0; i< 2; i++){
+        apop_model *newton = apop_estimate(data[i], *models[i]);
+        assert(apop_data_get(newton->info, .rowname="status") == 0);
+        double ll = apop_data_get(newton->info, .rowname="log likelihood");
+        assert(fabs(ll - apop_log_likelihood(data[i], newton)) < 1e-8*fabs(ll));
+
+        apop_model *m = apop_model_copy(*models[i]);
+        Apop_model_add_group(m, apop_mle, .method=APOP_SIMPLEX_NM, .tolerance=1e-8);
+        apop_model *mle = apop_estimate(data[i], *m);
+        assert(ll >= apop_data_get(mle->info, .rowname="log likelihood") - 1e-6*fabs(ll));
+        for (size_t j=0; j< newton->parameters->matrix->size1; j++)
+            for (size_t k=0; k< newton->parameters->matrix->size2; k++)
+                assert(fabs(apop_data_get(newton->parameters, j, k) - apop_data_get(mle->parameters, j, k)) < 1e-2);
+
+        //For the logit, the observed and expected information are the same.
+        apop_data *cov = apop_data_get_page(newton->parameters, "<Covariance>");
+        assert(cov && cov->matrix->size1 == newton->parameters->matrix->size1*newton->parameters->matrix->size2);
+        if (i==0){
+            apop_data *numeric = apop_model_numerical_covariance(data[i], mle);
+            for (size_t j=0; j< cov->matrix->size1; j++)
+                assert(fabs(apop_data_get(cov, j, j) - apop_data_get(numeric, j, j))
+                                  < 0.05 * apop_data_get(numeric, j, j));
+        }
+        apop_model_free(newton); apop_model_free(mle); apop_model_free(m);
+    }
+    apop_data_free(logit_d); apop_data_free(probit_d);
+
+    //A multinomial logit over four text-coded options, with a and b swapped in the
+    //alphabetical order so the numeraire is option 0 after factoring.
+    double mbeta[2][3] = {{.4, -.6, .2}, {.9, .5, -1.1}};
+    char *labels[] = {"a", "c", "b", "d"};
+    apop_data *multi = apop_text_alloc(apop_data_alloc(0, n, 2), n, 1);
+    for (int i=0; i< n; i++){
+        double x = gsl_ran_gaussian(r, 1), p[4] = {1}, total = 1;
+        for (int j=0; j< 3; j++) total += p[j+1] = exp(mbeta[0][j] + x*mbeta[1][j]);
+        double u = gsl_rng_uniform(r)*total;
+        int choice = 0;
+        while (choice < 3 && (u -= p[choice]) > 0) choice++;
+        apop_text_add(multi, i, 0, "%s", labels[choice]);
+        apop_data_set(multi, i, 1, x);
+    }
+    apop_data_to_factors(multi);
+    apop_model *newton = apop_estimate(multi, apop_logit);
+    assert(apop_data_get(newton->info, .rowname="status") == 0);
+    assert(newton->parameters->matrix->size2 == 3);
+    apop_data *cov = apop_data_get_page(newton->parameters, "<Covariance>");
+    for (int j=0; j< 3; j++)
+        for (int k=0; k< 2; k++){ //columns are b, c, d; the true values are in label order a, c, b, d.
+            double se = sqrt(apop_data_get(cov, k*3+j, k*3+j));
+            assert(fabs(apop_data_get(newton->parameters, k, j) - mbeta[k][j==0 ? 1 : j==1 ? 0 : 2]) < 4*se);
+        }
+
+    //If the iterations run out, say so, and give the covariance at the parameters returned.
+    apop_model *capped = apop_model_copy(apop_logit);
+    Apop_model_add_group(capped, apop_mle, .max_iterations=1);
+    apop_model *short_run = apop_estimate(multi, *capped);
+    assert(apop_data_get(short_run->info, .rowname="status") == 1);
+    double ll = apop_data_get(short_run->info, .rowname="log likelihood");
+    assert(fabs(ll - apop_log_likelihood(multi, short_run)) < 1e-8*fabs(ll));
+    cov = apop_data_get_page(short_run->parameters, "<Covariance>");
+    apop_data *numeric = apop_model_numerical_covariance(multi, short_run);
+    for (size_t j=0; j< cov->matrix->size1; j++)
+        assert(fabs(apop_data_get(cov, j, j) - apop_data_get(numeric, j, j)) < 0.01 * apop_data_get(numeric, j, j));
+    apop_data_free(numeric);
+
+    //The group's tolerance bounds the norm of the score, so a huge one accepts the starting point.
+    Apop_settings_set(capped, apop_mle, max_iterations, 100);
+    Apop_settings_set(capped, apop_mle, tolerance, 1e10);
+    apop_model *loose = apop_estimate(multi, *capped);
+    assert(apop_data_get(loose->info, .rowname="status") == 0);
+    assert(!apop_matrix_sum(loose->parameters->matrix));
+    Diff(apop_data_get(loose->info, .rowname="log likelihood"), n*log(1/4.), 1e-6);
+    apop_model_free(loose);
+    apop_model_free(short_run); apop_model_free(capped);
+    apop_model_free(newton); apop_data_free(multi);
+}
+
 void test_resize(){
     //This is the multiplication table from _Modeling with Data_
     //with a +.1 to distinguish columns from rows.
@@ -1454,6 +2556,29 @@ void test_weighted_regression(apop_data *d,apop_model *e){
     assert( apop_vector_distance(e2->parameters->vector, e->parameters->vector) < tol5);
 }
 
+//Rows with zero weight should drop out of a weighted regression entirely.
+void test_ols_zero_weights(gsl_rng *r){
+    int n = 300, kept = 0;
+    apop_data *d = apop_data_alloc(n, 3), *sub = apop_data_alloc(n - n/3, 3);
+    d->weights = gsl_vector_alloc(n);
+    for (int i=0; i< n; i++){
+        double x1 = gsl_rng_uniform(r), x2 = gsl_rng_uniform(r);
+        apop_data_set(d, i, 1, x1);
+        apop_data_set(d, i, 2, x2);
+        apop_data_set(d, i, 0, 1 + 2*x1 - x2 + gsl_ran_gaussian(r, .1) + (i%3 ? 0 : 5));
+        gsl_vector_set(d->weights, i, i%3 ? 1 : 0);
+        if (i%3){
+            Apop_row(d, i, row);
+            Apop_row(sub, kept++, subrow);
+            gsl_vector_memcpy(subrow, row);
+        }
+    }
+    apop_model *w = apop_estimate(d, apop_ols), *s = apop_estimate(sub, apop_ols);
+    assert(apop_vector_distance(w->parameters->vector, s->parameters->vector) < 1e-6);
+    apop_model_free(w); apop_model_free(s);
+    apop_data_free(d); apop_data_free(sub);
+}
+
 void test_ols_offset(gsl_rng *r){
     //A thing we know about OLS: an offset in the variables should make almost no
     //difference. Here we fit OLS with data that is of the form Y = 3*Y+eps
@@ -1518,6 +2643,7 @@ int main(int argc, char **argv){
     do_test("db_to_text", db_to_text());
     do_test("rownames", test_rownames());
     do_test("apop_dot", test_dot());
+    do_test("arena allocation", test_arena());
     do_test("apop_jackknife", test_jackknife(r));
     do_test("test multivariate_normal", test_multivariate_normal(r));
     do_test("log and exponent", log_and_exp(r));
@@ -1528,6 +2654,7 @@ int main(int argc, char **argv){
     do_test("NaN handling", test_nan_data());
     do_test("test data compressing", test_pmf_compress(r));
     do_test("weighted regression", test_weighted_regression(d,e));
+    do_test("weighted OLS with zero weights", test_ols_zero_weights(r));
     do_test("offset OLS", test_ols_offset(r));
     do_test("default RNG", test_default_rng(r));
     do_test("test printing", test_printing());
@@ -1559,6 +2686,30 @@ int main(int argc, char **argv){
     do_test("apop_linear_constraint", test_linear_constraint());
     do_test("transposition", test_transpose());
     do_test("test unique elements", test_unique_elements());
+    do_test("pooled text", test_text_pool());
+    do_test("factors with many categories", test_many_factors());
+    do_test("sparse dummies", test_sparse_dummies(r));
+    do_test("settings lookup cache", test_settings_cache());
+    do_test("parallel numerical derivatives", test_parallel_derivs(r));
+    do_test("dual-number derivatives", test_dual_derivs(r));
+    do_test("gradient via cached X beta", test_xbeta_gradient(r));
+    do_test("multi-start MLE", test_multistart(r));
+    do_test("parallel tempering", test_tempering(r));
+    do_test("mini-batch optimization", test_minibatch(r));
+    do_test("cached parameter layout", test_pack_plan(r));
+    do_test("buffered trace path", test_trace_path(r));
+    do_test("fused log likelihood and score", test_ll_and_score(r));
+    do_test("Newton and Fisher scoring for logit and probit", test_irls(r));
+    do_test("streaming OLS", test_ols_stream(r));
+    do_test("weighted OLS", test_wls(r));
+    do_test("online OLS over a sliding window", test_ols_online(r));
+    do_test("OLS with collinear columns", test_ols_collinear(r));
+    do_test("OLS log likelihood and score", test_ols_ll_score(r));
+    do_test("PCA, full and randomized", test_pca(r));
+    do_test("blocked and threaded products", test_blocked_products(r));
+    do_test("loess with threaded local fits", test_loess_threads(r));
+    do_test("concurrent loess fits", test_loess_concurrent(r));
+    do_test("loess prediction from the cached tree", test_loess_predict(r));
     if (slow_tests){
         if (verbose) printf("\tSlower tests:\n");
         do_test("Test score (dlog likelihood) calculation", test_score());
@@ -25,6 +25,22 @@ typedef struct{
     char title[101];
 } apop_name;
 
+/** A block of sparse columns, in compressed-row form. An \ref apop_data set's \c sparse
+element holds columns that sit to the right of its matrix, typically the output of
+\ref apop_data_to_dummies with <tt>.sparse='y'</tt>.
+
+The entries of row \c i are at positions <tt>rowstart[i]</tt> through
+<tt>rowstart[i+1]-1</tt> of \c col (and \c value), so <tt>rowstart</tt> has
+<tt>size1+1</tt> elements and <tt>rowstart[size1]</tt> is the count of entries.
+\ingroup data_struct
+*/
+typedef struct apop_sparse {
+    size_t size1, size2;
+    size_t *rowstart;
+    size_t *col;
+    double *value; /**< If \c NULL, every stored entry is one. */
+} apop_sparse;
+
 /** The \ref apop_data structure represents a data set. It primarily joins together a gsl_vector, a gsl_matrix, and a table of strings, then gives them all row and column names. It tries to be minimally intrusive, so you can use it everywhere you would use a \c gsl_matrix or a \c gsl_vector.
 
 If you are viewing the HTML documentation, here is a diagram showing a sample data set with all of the elements in place. Together, they represet a data set where each row is an observation, which includes both numeric and text values, and where each row/column is named.
@@ -44,6 +60,8 @@ typedef struct apop_data{
     gsl_vector  *weights;
     struct apop_data   *more;
     char        error;
+    struct apop_text_pool *textpool; /**< If not \c NULL, the strings in \c text live here; see \ref apop_text_pool. */
+    apop_sparse *sparse; /**< If not \c NULL, more matrix columns, stored sparsely to the right of \c matrix; see \ref apop_sparse. */
 } apop_data;
 
 /* Settings groups. For internal use only; see apop_settings.c and 
@@ -59,6 +77,23 @@ typedef struct {
 /** A statistical model. */
 typedef struct apop_model apop_model;
 
+/** A dual number, for forward-mode differentiation of a log likelihood.
+
+\c val is the value, \c d holds the derivative with respect to each parameter, and \c dd
+holds the second derivatives (packed upper triangle, row by row) when a Hessian is wanted.
+A \c NULL \c d or \c dd means all zeros, which is what constants have.
+
+Models opt in by providing a \c log_likelihood_dual method that does its arithmetic with
+\ref apop_dual_add, \ref apop_dual_mul, \ref apop_dual_log, and friends; see \ref apop_dual_chain
+for how to add your own functions. The derivatives are then exact, and \ref
+apop_numerical_gradient, \ref apop_model_hessian, and the MLE use them in place of finite
+differences.
+\ingroup models */
+typedef struct {
+    double val;
+    double *d, *dd;
+} apop_dual;
+
 /** The elements of the \ref apop_model type, representing a statistical model. */
 struct apop_model{
     char        name[101]; 
@@ -82,6 +117,20 @@ struct apop_model{
                 /**< Log likelihood of the given data and parameterized model. Call via \ref apop_log_likelihood */
     void    (*score)(apop_data *d, gsl_vector *gradient, apop_model *params);
                 /**< Derivative of the log likelihood. Call via \ref apop_score */
+    apop_dual (*log_likelihood_dual)(apop_data *d, apop_dual const *params, apop_model *m);
+                /**< The log likelihood, written with \ref apop_dual arithmetic. \c params
+                  is the parameter set in \ref apop_data_pack order, and \c m->parameters
+                  holds the same values as plain doubles. See \ref apop_dual. */
+    double  (*log_likelihood_score)(apop_data *d, gsl_vector *gradient, apop_model *m);
+                /**< The log likelihood and the score in one pass through the data. Write the
+                  score to \c gradient and return the log likelihood, which must match
+                  what \c log_likelihood returns. The MLE's gradient-based methods use this
+                  when they need both at the same point. */
+    double  (*log_likelihood_xbeta)(apop_data *d, gsl_matrix *xbeta, apop_model *m);
+                /**< For models where the parameters matter only via \f$X\beta\f$ (the data
+                  matrix times the parameter matrix, as from \ref apop_dot), the log likelihood
+                  given that product. Numerical derivatives then shift one column of a cached
+                  \f$X\beta\f$ per coordinate, rather than recalculating the product. */
     apop_data*  (*predict)(apop_data *d, apop_model *params);
     apop_model * (*parameter_model)(apop_data *, apop_model *);
     double  (*cdf)(apop_data *d, apop_model *params); /**< Cumulative distribution function: 
@@ -97,6 +146,8 @@ struct apop_model{
     size_t  more_size; /**< If setting \c more, set this to \c sizeof(your_more_type) so
                          \ref apop_model_copy can do the \c memcpy as necessary. */
     char        error;
+    apop_settings_type *settings_cache[4]; /**< Recently found settings groups. For internal use; see apop_settings.c. */
+    struct apop_pack_plan *pack_plan; /**< The layout of the parameters, for packing them. For internal use; see apop_conversions.c. */
 };
 
 /** The global options.
@@ -183,6 +234,8 @@ apop_data * apop_matrix_to_data(gsl_matrix *m);
 apop_data * apop_vector_to_data(gsl_vector *v);
 APOP_VAR_DECLARE apop_data * apop_data_alloc(const size_t size1, const size_t size2, const int size3);
 APOP_VAR_DECLARE apop_data * apop_data_calloc(const size_t size1, const size_t size2, const int size3);
+void apop_arena_push(void);
+void apop_arena_pop(void);
 APOP_VAR_DECLARE apop_data * apop_data_stack(apop_data *m1, apop_data * m2, char posn, char inplace);
 apop_data ** apop_data_split(apop_data *in, int splitpoint, char r_or_c);
 apop_data * apop_data_copy(const apop_data *in);
@@ -195,6 +248,12 @@ void apop_data_add_named_elmt(apop_data *d, char *name, double val);
 int apop_text_add(apop_data *in, const size_t row, const size_t col, const char *fmt, ...);
 apop_data * apop_text_alloc(apop_data *in, const size_t row, const size_t col);
 void apop_text_free(char ***freeme, int rows, int cols);
+apop_data * apop_text_pool(apop_data *in);
+apop_sparse *apop_sparse_alloc(size_t size1, size_t size2, size_t nonzeros);
+void apop_sparse_free(apop_sparse *s);
+apop_sparse *apop_sparse_copy(apop_sparse const *in);
+double apop_sparse_get(apop_sparse const *s, size_t row, size_t col);
+gsl_matrix *apop_sparse_to_matrix(apop_sparse const *s);
 APOP_VAR_DECLARE apop_data * apop_data_transpose(apop_data const *in, char transpose_text);
 gsl_matrix * apop_matrix_realloc(gsl_matrix *m, size_t newheight, size_t newwidth);
 gsl_vector * apop_vector_realloc(gsl_vector *v, size_t newheight);